@@ -0,0 +1,284 @@
+﻿//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.IO;
+using System.Threading;
+
+namespace zuki.storage.structured.bench
+{
+	/// <summary>
+	/// The individual structured storage benchmarks.  Each one runs against a
+	/// brand new storage and returns the measurements it collected
+	/// </summary>
+	internal static class Benchmarks
+	{
+		/// <summary>
+		/// Measures object create, lookup, enumerate and remove rates
+		/// </summary>
+		/// <param name="path">Storage file path, or null for a temporary file</param>
+		/// <param name="count">Number of objects to work with</param>
+		/// <param name="seed">Random number generator seed</param>
+		public static IEnumerable<Measurement> Objects(string path, int count, int seed)
+		{
+			Measurement create = new Measurement(String.Format("object create [{0}]", count), count);
+			Measurement lookup = new Measurement(String.Format("object lookup [{0}]", count), count);
+			Measurement enumerate = new Measurement(String.Format("object enumerate [{0}]", count), count);
+			Measurement remove = new Measurement(String.Format("object remove [{0}]", count), count);
+
+			using (StructuredStorage storage = CreateStorage(path, String.Format("objects-{0}", count)))
+			{
+				string[] names = MakeNames("object", count);
+				foreach (string name in names) create.Time(() => storage.Objects.Add(name));
+
+				foreach (string name in Shuffle(names, seed)) lookup.Time(() => storage.Objects.Contains(name));
+
+				// Enumeration is timed per item by measuring the gap between
+				// each successive MoveNext() on the collection enumerator
+
+				long last = Stopwatch.GetTimestamp();
+				foreach (StorageObject obj in storage.Objects)
+				{
+					long now = Stopwatch.GetTimestamp();
+					enumerate.Record(now - last);
+					last = now;
+				}
+
+				foreach (string name in Shuffle(names, seed + 1)) remove.Time(() => storage.Objects.Remove(name));
+			}
+
+			return new Measurement[] { create, lookup, enumerate, remove };
+		}
+
+		/// <summary>
+		/// Measures property set read and write rates
+		/// </summary>
+		/// <param name="path">Storage file path, or null for a temporary file</param>
+		/// <param name="count">Number of properties to work with</param>
+		/// <param name="seed">Random number generator seed</param>
+		public static IEnumerable<Measurement> Properties(string path, int count, int seed)
+		{
+			Measurement write = new Measurement(String.Format("property write [{0}]", count), count);
+			Measurement read = new Measurement(String.Format("property read [{0}]", count), count);
+
+			using (StructuredStorage storage = CreateStorage(path, String.Format("properties-{0}", count)))
+			{
+				StoragePropertySet propset = storage.PropertySets.Add("benchmark");
+				string[] names = MakeNames("property", count);
+
+				for (int index = 0; index < names.Length; index++)
+				{
+					string name = names[index];
+					int value = index;
+					write.Time(() => propset[name] = value);
+				}
+
+				foreach (string name in Shuffle(names, seed)) read.Time(() => { object value = propset[name]; });
+			}
+
+			return new Measurement[] { write, read };
+		}
+
+		/// <summary>
+		/// Measures sequential object stream write and read throughput
+		/// </summary>
+		/// <param name="path">Storage file path, or null for a temporary file</param>
+		/// <param name="length">Total number of bytes to write and read</param>
+		/// <param name="blocksize">Size of each individual write and read</param>
+		/// <param name="seed">Random number generator seed</param>
+		public static IEnumerable<Measurement> Streams(string path, long length, int blocksize, int seed)
+		{
+			int blocks = (int)Math.Max(length / blocksize, 1);
+
+			Measurement write = new Measurement(String.Format("stream write [{0}]", FormatSize(blocksize)), blocks);
+			Measurement read = new Measurement(String.Format("stream read [{0}]", FormatSize(blocksize)), blocks);
+
+			byte[] buffer = new byte[blocksize];
+			new Random(seed).NextBytes(buffer);
+
+			using (StructuredStorage storage = CreateStorage(path, String.Format("streams-{0}", blocksize)))
+			{
+				StorageObject obj = storage.Objects.Add("stream");
+
+				using (Stream writer = obj.GetWriter())
+				{
+					for (int index = 0; index < blocks; index++) write.Time(() => writer.Write(buffer, 0, blocksize));
+				}
+
+				using (Stream reader = obj.GetReader())
+				{
+					for (int index = 0; index < blocks; index++) read.Time(() => reader.Read(buffer, 0, blocksize));
+				}
+			}
+
+			return new Measurement[] { write, read };
+		}
+
+		/// <summary>
+		/// Measures the scaling of concurrent object name lookups, which are
+		/// resolved by the container's name mapper
+		/// </summary>
+		/// <param name="path">Storage file path, or null for a temporary file</param>
+		/// <param name="count">Number of objects to look up</param>
+		/// <param name="threads">Number of threads doing lookups</param>
+		/// <param name="duration">Length of time to run each thread for</param>
+		/// <param name="seed">Random number generator seed</param>
+		public static IEnumerable<Measurement> Contention(string path, int count, int threads, TimeSpan duration, int seed)
+		{
+			Measurement lookup = new Measurement(String.Format("object lookup [{0}] x{1} threads", count, threads), 0);
+			List<long>[] samples = new List<long>[threads];
+
+			using (StructuredStorage storage = CreateStorage(path, String.Format("contention-{0}x{1}", count, threads)))
+			{
+				string[] names = MakeNames("object", count);
+				foreach (string name in names) storage.Objects.Add(name);
+
+				using (Barrier barrier = new Barrier(threads))
+				{
+					Thread[] workers = new Thread[threads];
+					long started = Stopwatch.GetTimestamp();
+
+					for (int index = 0; index < threads; index++)
+					{
+						int worker = index;
+						samples[worker] = new List<long>();
+
+						workers[worker] = new Thread(() =>
+						{
+							Random random = new Random(seed + worker);
+							barrier.SignalAndWait();
+
+							long stop = Stopwatch.GetTimestamp() + (long)(duration.TotalSeconds * Stopwatch.Frequency);
+							while (Stopwatch.GetTimestamp() < stop)
+							{
+								string name = names[random.Next(names.Length)];
+
+								long start = Stopwatch.GetTimestamp();
+								storage.Objects.Contains(name);
+								samples[worker].Add(Stopwatch.GetTimestamp() - start);
+							}
+						});
+
+						workers[worker].Start();
+					}
+
+					foreach (Thread worker in workers) worker.Join();
+					lookup.Elapsed = Stopwatch.GetTimestamp() - started;
+				}
+			}
+
+			// The latencies from all of the threads are merged together, and the
+			// operation rate is based on the wall clock time of the whole run
+
+			foreach (List<long> list in samples)
+				foreach (long sample in list) lookup.Record(sample);
+
+			return new Measurement[] { lookup };
+		}
+
+		/// <summary>
+		/// Generates a synthetic storage from a workload profile, and then
+		/// measures reading back every object by it's path in random order
+		/// </summary>
+		/// <param name="path">Storage file path, or null for a temporary file</param>
+		/// <param name="profile">Shape of the storage to generate</param>
+		public static IEnumerable<Measurement> Workload(string path, WorkloadProfile profile)
+		{
+			List<Measurement> measurements = new List<Measurement>();
+			List<string> paths = new List<string>();
+
+			using (StructuredStorage storage = CreateStorage(path, "workload"))
+			{
+				measurements.AddRange(WorkloadGenerator.Generate(storage, profile, paths));
+
+				Measurement read = new Measurement(String.Format("object read by path [{0}]", paths.Count), paths.Count);
+				foreach (string objpath in Shuffle(paths.ToArray(), profile.Seed)) 
+					read.Time(() => { byte[] data = storage.GetObject(objpath).Data; });
+
+				measurements.Add(read);
+			}
+
+			return measurements;
+		}
+
+		//-------------------------------------------------------------------
+		// Private Member Functions
+		//-------------------------------------------------------------------
+
+		/// <summary>
+		/// Creates a new storage for a benchmark, next to the specified path
+		/// or as a temporary file
+		/// </summary>
+		/// <param name="path">Storage file path, or null for a temporary file</param>
+		/// <param name="suffix">Benchmark name added to the file name, so that
+		/// every benchmark gets a file of it's own</param>
+		private static StructuredStorage CreateStorage(string path, string suffix)
+		{
+			if (path == null) return StructuredStorage.CreateTemp();
+
+			string name = Path.GetFileNameWithoutExtension(path) + "." + suffix + Path.GetExtension(path);
+			return StructuredStorage.Create(Path.Combine(Path.GetDirectoryName(Path.GetFullPath(path)), name));
+		}
+
+		/// <summary>
+		/// Formats a byte count for display
+		/// </summary>
+		private static string FormatSize(long size)
+		{
+			if (size >= (1 << 20)) return String.Format("{0}MiB", size >> 20);
+			else if (size >= (1 << 10)) return String.Format("{0}KiB", size >> 10);
+			else return String.Format("{0}B", size);
+		}
+
+		/// <summary>
+		/// Generates an array of unique element names
+		/// </summary>
+		private static string[] MakeNames(string prefix, int count)
+		{
+			string[] names = new string[count];
+			for (int index = 0; index < count; index++) names[index] = prefix + index.ToString("D8");
+
+			return names;
+		}
+
+		/// <summary>
+		/// Generates a shuffled copy of an array of names
+		/// </summary>
+		private static string[] Shuffle(string[] names, int seed)
+		{
+			Random random = new Random(seed);
+			string[] shuffled = (string[])names.Clone();
+
+			for (int index = shuffled.Length - 1; index > 0; index--)
+			{
+				int swap = random.Next(index + 1);
+				string temp = shuffled[index];
+				shuffled[index] = shuffled[swap];
+				shuffled[swap] = temp;
+			}
+
+			return shuffled;
+		}
+	}
+}
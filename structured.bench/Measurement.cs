@@ -0,0 +1,163 @@
+﻿//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+
+namespace zuki.storage.structured.bench
+{
+	/// <summary>
+	/// Collects the individual operation latencies for a single benchmark and
+	/// reports the operation rate along with the latency percentiles
+	/// </summary>
+	public class Measurement
+	{
+		/// <summary>
+		/// Instance Constructor
+		/// </summary>
+		/// <param name="name">Name of the measured operation</param>
+		/// <param name="capacity">Expected number of samples</param>
+		public Measurement(string name, int capacity)
+		{
+			if (name == null) throw new ArgumentNullException("name");
+
+			m_name = name;
+			m_samples = new List<long>(Math.Max(capacity, 1));
+		}
+
+		/// <summary>
+		/// Number of samples that have been recorded
+		/// </summary>
+		public int Count
+		{
+			get { return m_samples.Count; }
+		}
+
+		/// <summary>
+		/// Name of the measured operation
+		/// </summary>
+		public string Name
+		{
+			get { return m_name; }
+		}
+
+		/// <summary>
+		/// Wall clock time of a concurrent run, in Stopwatch ticks.  When set,
+		/// the operation rate is based on this rather than the sample total
+		/// </summary>
+		public long Elapsed
+		{
+			get { return m_elapsed; }
+			set { m_elapsed = value; }
+		}
+
+		/// <summary>
+		/// Operations per second, based on the total time spent in the operation
+		/// </summary>
+		public double OpsPerSecond
+		{
+			get
+			{
+				long elapsed = (m_elapsed != 0) ? m_elapsed : m_total;
+				return (elapsed == 0) ? 0.0 : m_samples.Count / ToSeconds(elapsed);
+			}
+		}
+
+		/// <summary>
+		/// Gets the latency at the specified percentile, in microseconds
+		/// </summary>
+		/// <param name="percentile">Percentile (0 - 100) to retrieve</param>
+		public double Percentile(double percentile)
+		{
+			if ((percentile < 0.0) || (percentile > 100.0)) throw new ArgumentOutOfRangeException("percentile");
+			if (m_samples.Count == 0) return 0.0;
+
+			if (!m_sorted) { m_samples.Sort(); m_sorted = true; }
+
+			int index = (int)Math.Ceiling((percentile / 100.0) * m_samples.Count) - 1;
+			return ToSeconds(m_samples[Math.Max(index, 0)]) * 1000000.0;
+		}
+
+		/// <summary>
+		/// Records a single sample from a Stopwatch timestamp delta
+		/// </summary>
+		/// <param name="ticks">Elapsed Stopwatch ticks</param>
+		public void Record(long ticks)
+		{
+			m_samples.Add(ticks);
+			m_total += ticks;
+			m_sorted = false;
+		}
+
+		/// <summary>
+		/// Times a single invocation of an operation and records the sample
+		/// </summary>
+		/// <param name="operation">Operation to be timed</param>
+		public void Time(Action operation)
+		{
+			long start = Stopwatch.GetTimestamp();
+			operation();
+			Record(Stopwatch.GetTimestamp() - start);
+		}
+
+		/// <summary>
+		/// Column headings that line up with ToString()
+		/// </summary>
+		public static string Header
+		{
+			get { return String.Format("{0,-40} {1,10} {2,12} {3,10} {4,10} {5,10} {6,10}", 
+				"operation", "count", "ops/sec", "p50 us", "p90 us", "p99 us", "max us"); }
+		}
+
+		/// <summary>
+		/// Formats the measurement as a single report line
+		/// </summary>
+		public override string ToString()
+		{
+			return String.Format("{0,-40} {1,10} {2,12:F0} {3,10:F1} {4,10:F1} {5,10:F1} {6,10:F1}", 
+				m_name, Count, OpsPerSecond, Percentile(50), Percentile(90), Percentile(99), Percentile(100));
+		}
+
+		//-------------------------------------------------------------------
+		// Private Member Functions
+		//-------------------------------------------------------------------
+
+		/// <summary>
+		/// Converts Stopwatch ticks into seconds
+		/// </summary>
+		private static double ToSeconds(long ticks)
+		{
+			return (double)ticks / (double)Stopwatch.Frequency;
+		}
+
+		//-------------------------------------------------------------------
+		// Member Variables
+		//-------------------------------------------------------------------
+
+		private readonly string		m_name;
+		private readonly List<long>	m_samples;
+		private long				m_total;
+		private long				m_elapsed;
+		private bool				m_sorted;
+	}
+}
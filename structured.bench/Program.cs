@@ -0,0 +1,157 @@
+﻿//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+using System;
+using System.Collections.Generic;
+
+namespace zuki.storage.structured.bench
+{
+	/// <summary>
+	/// Structured storage benchmark harness
+	/// 
+	/// zuki.storage.structured.bench.exe [-counts:1000,10000] [-length:bytes] [-blocks:4096,65536]
+	///		[-threads:1,2,4] [-duration:seconds] [-seed:value] [-path:file] [-profile:spec]
+	///		
+	/// zuki.storage.structured.bench.exe -generate:file [-profile:spec]
+	///		
+	/// Without -path, every benchmark runs against a temporary storage file.
+	/// With it, each benchmark gets it's own file named after the -path file,
+	/// for example bench.objects-1000.stg for -path:bench.stg.
+	/// -profile adds the synthetic workload benchmark; see WorkloadProfile for
+	/// the specification format.  -generate only builds a synthetic storage
+	/// with the profile (or the default one) and leaves it in the file
+	/// </summary>
+	internal static class Program
+	{
+		/// <summary>
+		/// Application entry point
+		/// </summary>
+		/// <param name="args">Command line arguments</param>
+		private static int Main(string[] args)
+		{
+			int[] counts = new int[] { 1000, 10000 };
+			int[] blocks = new int[] { 4096, 65536, 1048576 };
+			int[] threads = DefaultThreadCounts();
+			long length = 64L << 20;
+			TimeSpan duration = TimeSpan.FromSeconds(2);
+			int seed = 0x5EED;
+			string path = null;
+			string generate = null;
+			WorkloadProfile profile = null;
+
+			try
+			{
+				foreach (string arg in args)
+				{
+					string name = arg, value = String.Empty;
+
+					int colon = arg.IndexOf(':');
+					if (colon >= 0) { name = arg.Substring(0, colon); value = arg.Substring(colon + 1); }
+
+					switch (name.ToLowerInvariant())
+					{
+						case "-counts": counts = ParseList(value); break;
+						case "-blocks": blocks = ParseList(value); break;
+						case "-threads": threads = ParseList(value); break;
+						case "-length": length = Int64.Parse(value); break;
+						case "-duration": duration = TimeSpan.FromSeconds(Double.Parse(value)); break;
+						case "-seed": seed = Int32.Parse(value); break;
+						case "-path": path = value; break;
+						case "-generate": generate = value; break;
+						case "-profile": profile = WorkloadProfile.Parse(value); break;
+						default: throw new ArgumentException("Unrecognized argument: " + arg);
+					}
+				}
+			}
+
+			catch (Exception ex)
+			{
+				Console.Error.WriteLine(ex.Message);
+				return 1;
+			}
+
+			Console.WriteLine(Measurement.Header);
+
+			if (generate != null)
+			{
+				if (profile == null) profile = new WorkloadProfile();
+
+				using (StructuredStorage storage = StructuredStorage.Create(generate))
+					Report(WorkloadGenerator.Generate(storage, profile, new List<string>()));
+
+				return 0;
+			}
+
+			foreach (int count in counts)
+			{
+				Report(Benchmarks.Objects(path, count, seed));
+				Report(Benchmarks.Properties(path, count, seed));
+			}
+
+			foreach (int blocksize in blocks) Report(Benchmarks.Streams(path, length, blocksize, seed));
+
+			foreach (int count in counts)
+				foreach (int threadcount in threads) Report(Benchmarks.Contention(path, count, threadcount, duration, seed));
+
+			if (profile != null) Report(Benchmarks.Workload(path, profile));
+
+			return 0;
+		}
+
+		//-------------------------------------------------------------------
+		// Private Member Functions
+		//-------------------------------------------------------------------
+
+		/// <summary>
+		/// Generates the default set of thread counts, doubling up to the
+		/// number of processors in the system
+		/// </summary>
+		private static int[] DefaultThreadCounts()
+		{
+			List<int> threads = new List<int>();
+
+			for (int count = 1; count < Environment.ProcessorCount; count *= 2) threads.Add(count);
+			threads.Add(Environment.ProcessorCount);
+
+			return threads.ToArray();
+		}
+
+		/// <summary>
+		/// Parses a comma-delimited list of integers
+		/// </summary>
+		private static int[] ParseList(string value)
+		{
+			List<int> list = new List<int>();
+			foreach (string item in value.Split(',')) list.Add(Int32.Parse(item.Trim()));
+
+			return list.ToArray();
+		}
+
+		/// <summary>
+		/// Writes a set of measurements to the console
+		/// </summary>
+		private static void Report(IEnumerable<Measurement> measurements)
+		{
+			foreach (Measurement measurement in measurements) Console.WriteLine(measurement);
+		}
+	}
+}
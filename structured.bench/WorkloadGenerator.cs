@@ -0,0 +1,151 @@
+﻿//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+using System;
+using System.Collections.Generic;
+
+namespace zuki.storage.structured.bench
+{
+	/// <summary>
+	/// Builds synthetic storages from a WorkloadProfile using the public
+	/// container, object and property set collections.  Everything is drawn
+	/// from a single seeded random number generator in a fixed order, so a
+	/// profile always generates exactly the same names, sizes and contents.
+	/// This is public so that other projects can reference the benchmark
+	/// assembly to build the same storages
+	/// </summary>
+	public static class WorkloadGenerator
+	{
+		/// <summary>
+		/// Populates a storage according to a profile
+		/// </summary>
+		/// <param name="storage">Storage to be populated</param>
+		/// <param name="profile">Shape of the storage to generate</param>
+		/// <param name="paths">Receives the path of every generated object</param>
+		public static IEnumerable<Measurement> Generate(StructuredStorage storage, WorkloadProfile profile, List<string> paths)
+		{
+			if (storage == null) throw new ArgumentNullException("storage");
+			if (profile == null) throw new ArgumentNullException("profile");
+			if (paths == null) throw new ArgumentNullException("paths");
+
+			profile.Validate();
+
+			Measurement containers = new Measurement("generate container", 0);
+			Measurement objects = new Measurement("generate object", 0);
+			Measurement properties = new Measurement("generate property", 0);
+
+			Populate(storage, String.Empty, 0, profile, new Random(profile.Seed), paths, containers, objects, properties);
+			storage.Flush();
+
+			return new Measurement[] { containers, objects, properties };
+		}
+
+		//-------------------------------------------------------------------
+		// Private Member Functions
+		//-------------------------------------------------------------------
+
+		/// <summary>
+		/// Generates the objects and property sets of one container, and then
+		/// recursively generates each of it's sub containers
+		/// </summary>
+		private static void Populate(StorageContainer container, string path, int level, WorkloadProfile profile, 
+			Random random, List<string> paths, Measurement containers, Measurement objects, Measurement properties)
+		{
+			int count = random.Next(profile.MinObjects, profile.MaxObjects + 1);
+
+			for (int index = 0; index < count; index++)
+			{
+				string name = "object" + index.ToString("D8");
+				byte[] data = new byte[NextObjectSize(random, profile)];
+				random.NextBytes(data);
+
+				objects.Time(() => container.Objects.Add(name).Data = data);
+				paths.Add(Combine(path, name));
+			}
+
+			for (int set = 0; set < profile.PropertySets; set++)
+			{
+				StoragePropertySet propset = container.PropertySets.Add("propset" + set.ToString("D8"));
+
+				count = random.Next(profile.MinProperties, profile.MaxProperties + 1);
+				for (int index = 0; index < count; index++)
+				{
+					string name = "property" + index.ToString("D8");
+					object value = NextPropertyValue(random);
+
+					properties.Time(() => propset[name] = value);
+				}
+			}
+
+			if (level >= profile.Depth) return;
+
+			count = random.Next(profile.MinFanOut, profile.MaxFanOut + 1);
+			for (int index = 0; index < count; index++)
+			{
+				string name = "container" + index.ToString("D8");
+
+				StorageContainer child = null;
+				containers.Time(() => child = container.Containers.Add(name));
+
+				Populate(child, Combine(path, name), level + 1, profile, random, paths, containers, objects, properties);
+			}
+		}
+
+		/// <summary>
+		/// Appends a name to a slash separated path
+		/// </summary>
+		private static string Combine(string path, string name)
+		{
+			return (path.Length == 0) ? name : path + "/" + name;
+		}
+
+		/// <summary>
+		/// Generates a log-normally distributed object size
+		/// </summary>
+		private static int NextObjectSize(Random random, WorkloadProfile profile)
+		{
+			if (profile.MedianObjectSize == 0) return 0;
+
+			// Box-Muller transform for a standard normal value; 1.0 - NextDouble()
+			// keeps the logarithm away from zero
+
+			double normal = Math.Sqrt(-2.0 * Math.Log(1.0 - random.NextDouble())) * Math.Cos(2.0 * Math.PI * random.NextDouble());
+			double size = profile.MedianObjectSize * Math.Exp(profile.ObjectSizeSigma * normal);
+
+			return (int)Math.Min(Math.Round(size), profile.MaxObjectSize);
+		}
+
+		/// <summary>
+		/// Generates a property value of a randomly chosen type
+		/// </summary>
+		private static object NextPropertyValue(Random random)
+		{
+			switch (random.Next(4))
+			{
+				case 0: return random.Next();
+				case 1: return random.NextDouble();
+				case 2: return new DateTime(2000, 1, 1, 0, 0, 0, DateTimeKind.Utc).AddSeconds(random.Next());
+				default: return "value" + random.Next().ToString("X8");
+			}
+		}
+	}
+}
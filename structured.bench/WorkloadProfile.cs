@@ -0,0 +1,165 @@
+﻿//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+using System;
+using System.Globalization;
+
+namespace zuki.storage.structured.bench
+{
+	/// <summary>
+	/// Describes the shape of a synthetic storage for WorkloadGenerator: how
+	/// deep and wide the container tree is, how many objects each container
+	/// holds and how big they are, and how many properties go with them.
+	/// The same profile and seed always produce the same storage
+	/// </summary>
+	public class WorkloadProfile
+	{
+		/// <summary>
+		/// Number of container levels below the root
+		/// </summary>
+		public int Depth = 3;
+
+		/// <summary>
+		/// Minimum and maximum number of sub containers in each container
+		/// </summary>
+		public int MinFanOut = 2;
+		public int MaxFanOut = 8;
+
+		/// <summary>
+		/// Minimum and maximum number of objects in each container
+		/// </summary>
+		public int MinObjects = 10;
+		public int MaxObjects = 100;
+
+		/// <summary>
+		/// Median object size in bytes; sizes follow a log-normal distribution
+		/// with this median and the specified spread (sigma)
+		/// </summary>
+		public int MedianObjectSize = 4096;
+		public double ObjectSizeSigma = 1.5;
+
+		/// <summary>
+		/// Largest object size that will be generated, in bytes
+		/// </summary>
+		public int MaxObjectSize = 16 << 20;
+
+		/// <summary>
+		/// Number of property sets in each container
+		/// </summary>
+		public int PropertySets = 1;
+
+		/// <summary>
+		/// Minimum and maximum number of properties in each property set
+		/// </summary>
+		public int MinProperties = 0;
+		public int MaxProperties = 20;
+
+		/// <summary>
+		/// Random number generator seed
+		/// </summary>
+		public int Seed = 0x5EED;
+
+		/// <summary>
+		/// Parses a profile specification of the form "name=value;name=value",
+		/// where ranges are given as "min-max".  Anything not specified keeps
+		/// the default value
+		/// </summary>
+		/// <param name="spec">Profile specification string</param>
+		public static WorkloadProfile Parse(string spec)
+		{
+			if (spec == null) throw new ArgumentNullException("spec");
+
+			WorkloadProfile profile = new WorkloadProfile();
+
+			foreach (string item in spec.Split(new char[] { ';' }, StringSplitOptions.RemoveEmptyEntries))
+			{
+				int equals = item.IndexOf('=');
+				if (equals < 0) throw new FormatException("Invalid profile setting: " + item);
+
+				string name = item.Substring(0, equals).Trim().ToLowerInvariant();
+				string value = item.Substring(equals + 1).Trim();
+
+				switch (name)
+				{
+					case "depth": profile.Depth = Int32.Parse(value); break;
+					case "fanout": ParseRange(value, out profile.MinFanOut, out profile.MaxFanOut); break;
+					case "objects": ParseRange(value, out profile.MinObjects, out profile.MaxObjects); break;
+					case "size": profile.MedianObjectSize = Int32.Parse(value); break;
+					case "sigma": profile.ObjectSizeSigma = Double.Parse(value, CultureInfo.InvariantCulture); break;
+					case "maxsize": profile.MaxObjectSize = Int32.Parse(value); break;
+					case "propsets": profile.PropertySets = Int32.Parse(value); break;
+					case "properties": ParseRange(value, out profile.MinProperties, out profile.MaxProperties); break;
+					case "seed": profile.Seed = Int32.Parse(value); break;
+					default: throw new FormatException("Unrecognized profile setting: " + name);
+				}
+			}
+
+			profile.Validate();
+			return profile;
+		}
+
+		/// <summary>
+		/// Formats the profile as a specification string accepted by Parse()
+		/// </summary>
+		public override string ToString()
+		{
+			return String.Format(CultureInfo.InvariantCulture, 
+				"depth={0};fanout={1}-{2};objects={3}-{4};size={5};sigma={6};maxsize={7};propsets={8};properties={9}-{10};seed={11}",
+				Depth, MinFanOut, MaxFanOut, MinObjects, MaxObjects, MedianObjectSize, ObjectSizeSigma, MaxObjectSize,
+				PropertySets, MinProperties, MaxProperties, Seed);
+		}
+
+		/// <summary>
+		/// Verifies that all of the profile settings make sense
+		/// </summary>
+		public void Validate()
+		{
+			if (Depth < 0) throw new ArgumentOutOfRangeException("Depth");
+			if ((MinFanOut < 0) || (MaxFanOut < MinFanOut)) throw new ArgumentOutOfRangeException("FanOut");
+			if ((MinObjects < 0) || (MaxObjects < MinObjects)) throw new ArgumentOutOfRangeException("Objects");
+			if (MedianObjectSize < 0) throw new ArgumentOutOfRangeException("MedianObjectSize");
+			if (ObjectSizeSigma < 0.0) throw new ArgumentOutOfRangeException("ObjectSizeSigma");
+			if (MaxObjectSize < 0) throw new ArgumentOutOfRangeException("MaxObjectSize");
+			if (PropertySets < 0) throw new ArgumentOutOfRangeException("PropertySets");
+			if ((MinProperties < 0) || (MaxProperties < MinProperties)) throw new ArgumentOutOfRangeException("Properties");
+		}
+
+		//-------------------------------------------------------------------
+		// Private Member Functions
+		//-------------------------------------------------------------------
+
+		/// <summary>
+		/// Parses either a single value or a "min-max" range
+		/// </summary>
+		private static void ParseRange(string value, out int min, out int max)
+		{
+			int dash = value.IndexOf('-');
+
+			if (dash < 0) min = max = Int32.Parse(value);
+			else
+			{
+				min = Int32.Parse(value.Substring(0, dash));
+				max = Int32.Parse(value.Substring(dash + 1));
+			}
+		}
+	}
+}
@@ -32,12 +32,15 @@ BEGIN_ROOT_NAMESPACE(zuki::storage)
 //
 // Arguments:
 //
-//	NONE
+//	statistics	- Runtime statistics for the root storage
 
 generic<class T>
-ComCache<T>::ComCache()
+ComCache<T>::ComCache(StorageStatistics^ statistics) : m_statistics(statistics)
 {
+	if(m_statistics == nullptr) throw gcnew ArgumentNullException();
 	m_cache = gcnew Dictionary<Guid, WeakReference^>();
+	m_mru = gcnew LinkedList<KeyValuePair<Guid, T>>();
+	m_mruNodes = gcnew Dictionary<Guid, LinkedListNode<KeyValuePair<Guid, T>>^>();
 }
 
 //---------------------------------------------------------------------------
@@ -72,18 +75,22 @@ void ComCache<T>::Add(Guid key, T value)
 	if(value == T()) throw gcnew ArgumentNullException();
 
 	// See if an item with the same GUID already exists in the collection.
-	// If it does, and the object is not dead yet, throw an ArgumentException
+	// If it does, and the object is not dead yet, throw an ArgumentException.
+	// A dead one was collected before anyone came back for it; that counts
+	// as an eviction since the pointer will have to be opened all over again
 
 	if(m_cache->TryGetValue(key, reference)) {
 
 		if(reference->IsAlive) throw gcnew ArgumentException();
-		else reference->Target = nullptr;
+
+		reference->Target = nullptr;
+		m_statistics->CacheEviction();
 	}
 
 	// Insert or replace the item in the collection with a new weak reference
 
 	m_cache[key] = gcnew WeakReference(value, false);
-	GC::KeepAlive(value);
+	Touch(key, value);
 }
 
 //---------------------------------------------------------------------------
@@ -107,6 +114,9 @@ void ComCache<T>::Clear(void)
 
 	for each(KeyValuePair<Guid, WeakReference^> item in m_cache) KillWeakReference(item.Value);
 	m_cache->Clear();
+
+	m_mru->Clear();
+	m_mruNodes->Clear();
 }
 
 //---------------------------------------------------------------------------
@@ -167,14 +177,18 @@ T ComCache<T>::default::get(Guid key)
 {
 	lock					cs(SyncRoot);	// Automatic critical section
 	WeakReference^			reference;		// Located object reference
+	T						value = T();	// Strong object reference
 
 	CHECK_DISPOSED(m_disposed);
 
 	// If the item doesn't exist, or is dead throw a standard exception. Now
 	// that this implements TryGetValue() this is an appropriate behavior
 
-	if((!m_cache->TryGetValue(key, reference)) || (!reference->IsAlive)) throw gcnew KeyNotFoundException();
-	else return safe_cast<T>(reference->Target);
+	if(m_cache->TryGetValue(key, reference)) value = safe_cast<T>(reference->Target);
+	if(value == nullptr) throw gcnew KeyNotFoundException();
+
+	Touch(key, value);
+	return value;
 }
 
 //---------------------------------------------------------------------------
@@ -203,7 +217,7 @@ void ComCache<T>::default::set(Guid key, T value)
 	if(m_cache->TryGetValue(key, reference)) KillWeakReference(reference);
 	m_cache[key] = gcnew WeakReference(value);
 
-	GC::KeepAlive(value);			// Keep it alive as long as possible
+	Touch(key, value);				// Keep it alive as long as possible
 }
 
 //---------------------------------------------------------------------------
@@ -246,15 +260,61 @@ bool ComCache<T>::Remove(Guid key)
 {
 	lock					cs(SyncRoot);	// Automatic critical section
 	WeakReference^			reference;		// Located object reference
+	LinkedListNode<KeyValuePair<Guid, T>>^ node;	// MRU list node
 
 	CHECK_DISPOSED(m_disposed);
 
 	// If the reference exists, kill it off before removing it from the cache
 
 	if(m_cache->TryGetValue(key, reference)) KillWeakReference(reference);
+
+	if(m_mruNodes->TryGetValue(key, node)) {
+
+		m_mru->Remove(node);
+		m_mruNodes->Remove(key);
+	}
+
 	return m_cache->Remove(key);
 }
 
+//---------------------------------------------------------------------------
+// ComCache::Touch (private)
+//
+// Moves an item to the front of the most recently used list, adding it if
+// it's not already there, and drops the strong reference to the least
+// recently used item if the list has grown too large.  The dropped item is
+// still in the cache, it just isn't being kept alive anymore
+//
+// Arguments:
+//
+//	key			- GUID of the item that was used
+//	value		- The item that was used
+
+generic<class T>
+void ComCache<T>::Touch(Guid key, T value)
+{
+	LinkedListNode<KeyValuePair<Guid, T>>^ node;	// MRU list node
+
+	if(m_mruNodes->TryGetValue(key, node)) {
+
+		// The item may have been replaced with a new instance under the
+		// same key, so the node gets a fresh value either way
+
+		m_mru->Remove(node);
+		node->Value = KeyValuePair<Guid, T>(key, value);
+		m_mru->AddFirst(node);
+		return;
+	}
+
+	m_mruNodes->Add(key, m_mru->AddFirst(KeyValuePair<Guid, T>(key, value)));
+
+	if(m_mru->Count > MRU_CAPACITY) {
+
+		m_mruNodes->Remove(m_mru->Last->Value.Key);
+		m_mru->RemoveLast();
+	}
+}
+
 //---------------------------------------------------------------------------
 // ComCache::TryGetValue
 //
@@ -278,10 +338,11 @@ bool ComCache<T>::TryGetValue(Guid key, T% value)
 	// If the item doesn't exist in the collection, or it's been finalized
 	// just return false back to the caller ... 
 
-	if(!m_cache->TryGetValue(key, reference)) return false;
-	if(!reference->IsAlive) return false;
+	if(m_cache->TryGetValue(key, reference)) value = safe_cast<T>(reference->Target);
+
+	if(value != nullptr) { m_statistics->CacheHit(); Touch(key, value); }
+	else m_statistics->CacheMiss();
 
-	value = safe_cast<T>(reference->Target);	// Cast into [out] reference
 	return (value != nullptr);					// Return final object status
 }
 
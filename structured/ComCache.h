@@ -26,6 +26,7 @@
 
 #include "IComPointer.h"					// Include IComPointer declarations
 #include "StorageExceptions.h"				// Include exception declarations
+#include "StorageStatistics.h"				// Include StorageStatistics decls
 #include "StorageUtil.h"					// Include StorageUtil declarations
 
 #pragma warning(push, 4)					// Enable maximum compiler warnings
@@ -47,6 +48,11 @@ BEGIN_ROOT_NAMESPACE(zuki::storage)
 // with their actual lifetime.  Note that the pointer classes don't get
 // disposed of unless the cache is being disposed of, which happens when
 // the root storage is closed/disposed.
+//
+// Every reopen of a collected pointer means another name lookup in the
+// parent's directory, which gets expensive with large containers.  To keep
+// the hot pointers from being collected, the most recently used items are
+// also held with strong references, up to MRU_CAPACITY of them.
 //---------------------------------------------------------------------------
 
 generic<class T>
@@ -58,7 +64,7 @@ public:
 	//-----------------------------------------------------------------------
 	// Constructor
 
-	ComCache();
+	ComCache(StorageStatistics^ statistics);
 
 	//-----------------------------------------------------------------------
 	// Member Functions
@@ -163,6 +169,11 @@ private:
 	virtual bool Remove(KeyValuePair<Guid, T> value) sealed = 
 		Generic::ICollection<KeyValuePair<Guid, T>>::Remove { return Remove(value.Key); }
 
+	// Touch
+	//
+	// Moves an item to the front of the most recently used list
+	void Touch(Guid key, T value);
+
 	//-----------------------------------------------------------------------
 	// Private Properties
 
@@ -180,11 +191,22 @@ private:
 			Generic::IDictionary<Guid, T>::Values::get { throw gcnew NotImplementedException(); }
 	}
 
+	//-----------------------------------------------------------------------
+	// Private Constants
+
+	// MRU_CAPACITY
+	//
+	// Maximum number of recently used items held with strong references
+	literal int MRU_CAPACITY = 128;
+
 	//-----------------------------------------------------------------------
 	// Member Variables
 
 	bool								m_disposed;		// Object disposal flag
 	Dictionary<Guid, WeakReference^>^	m_cache;		// Cache dictionary
+	LinkedList<KeyValuePair<Guid, T>>^	m_mru;			// Most recently used
+	Dictionary<Guid, LinkedListNode<KeyValuePair<Guid, T>>^>^	m_mruNodes;	// m_mru lookup
+	initonly StorageStatistics^			m_statistics;	// Runtime statistics
 };
 
 //---------------------------------------------------------------------------
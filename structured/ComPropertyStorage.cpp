@@ -33,11 +33,13 @@ BEGIN_ROOT_NAMESPACE(zuki::storage)
 // Arguments:
 //
 //	pStorage	- IStorage pointer to be wrapped up
+//	statistics	- Runtime statistics for the root storage
 
-ComPropertyStorage::ComPropertyStorage(IPropertyStorage* pPropStorage) : 
-	m_pPropStorage(pPropStorage)
+ComPropertyStorage::ComPropertyStorage(IPropertyStorage* pPropStorage, StorageStatistics^ statistics) : 
+	m_pPropStorage(pPropStorage), m_statistics(statistics)
 {
 	if(!m_pPropStorage) throw gcnew ArgumentNullException();
+	if(m_statistics == nullptr) throw gcnew ArgumentNullException();
 	m_pPropStorage->AddRef();
 }
 
@@ -57,8 +59,13 @@ ComPropertyStorage::!ComPropertyStorage()
 
 HRESULT ComPropertyStorage::Commit(DWORD grfCommitFlags)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pPropStorage->Commit(grfCommitFlags);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pPropStorage->Commit(grfCommitFlags); }
+	finally { m_statistics->PropertyStorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -68,8 +75,13 @@ HRESULT ComPropertyStorage::Commit(DWORD grfCommitFlags)
 
 HRESULT ComPropertyStorage::DeleteMultiple(ULONG cpspec, const PROPSPEC rgpspec[])
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pPropStorage->DeleteMultiple(cpspec, rgpspec);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pPropStorage->DeleteMultiple(cpspec, rgpspec); }
+	finally { m_statistics->PropertyStorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -79,8 +91,13 @@ HRESULT ComPropertyStorage::DeleteMultiple(ULONG cpspec, const PROPSPEC rgpspec[
 
 HRESULT ComPropertyStorage::DeletePropertyNames(ULONG cpropid, const PROPID rgpropid[])
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pPropStorage->DeletePropertyNames(cpropid, rgpropid);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pPropStorage->DeletePropertyNames(cpropid, rgpropid); }
+	finally { m_statistics->PropertyStorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -90,8 +107,13 @@ HRESULT ComPropertyStorage::DeletePropertyNames(ULONG cpropid, const PROPID rgpr
 
 HRESULT ComPropertyStorage::Enum(IEnumSTATPROPSTG** ppenum)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pPropStorage->Enum(ppenum);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pPropStorage->Enum(ppenum); }
+	finally { m_statistics->PropertyStorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -102,8 +124,13 @@ HRESULT ComPropertyStorage::Enum(IEnumSTATPROPSTG** ppenum)
 HRESULT ComPropertyStorage::ReadMultiple(ULONG cpspec, const PROPSPEC rgpspec[], 
 	PROPVARIANT rgpropvar[])
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pPropStorage->ReadMultiple(cpspec, rgpspec, rgpropvar);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pPropStorage->ReadMultiple(cpspec, rgpspec, rgpropvar); }
+	finally { m_statistics->PropertyStorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -114,8 +141,13 @@ HRESULT ComPropertyStorage::ReadMultiple(ULONG cpspec, const PROPSPEC rgpspec[],
 HRESULT ComPropertyStorage::ReadPropertyNames(ULONG cpropid, const PROPID rgpropid[], 
 	LPWSTR rglpwstrName[])
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pPropStorage->ReadPropertyNames(cpropid, rgpropid, rglpwstrName);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pPropStorage->ReadPropertyNames(cpropid, rgpropid, rglpwstrName); }
+	finally { m_statistics->PropertyStorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -125,8 +157,13 @@ HRESULT ComPropertyStorage::ReadPropertyNames(ULONG cpropid, const PROPID rgprop
 
 HRESULT ComPropertyStorage::Revert(void)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pPropStorage->Revert();
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pPropStorage->Revert(); }
+	finally { m_statistics->PropertyStorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -136,8 +173,13 @@ HRESULT ComPropertyStorage::Revert(void)
 
 HRESULT ComPropertyStorage::SetClass(REFCLSID clsid)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pPropStorage->SetClass(clsid);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pPropStorage->SetClass(clsid); }
+	finally { m_statistics->PropertyStorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -148,8 +190,13 @@ HRESULT ComPropertyStorage::SetClass(REFCLSID clsid)
 HRESULT ComPropertyStorage::SetTimes(const ::FILETIME* pctime, const ::FILETIME* patime, 
 	const ::FILETIME* pmtime)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pPropStorage->SetTimes(pctime, patime, pmtime);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pPropStorage->SetTimes(pctime, patime, pmtime); }
+	finally { m_statistics->PropertyStorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -159,8 +206,13 @@ HRESULT ComPropertyStorage::SetTimes(const ::FILETIME* pctime, const ::FILETIME*
 
 HRESULT ComPropertyStorage::Stat(STATPROPSETSTG* pstatpsstg)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pPropStorage->Stat(pstatpsstg);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pPropStorage->Stat(pstatpsstg); }
+	finally { m_statistics->PropertyStorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -171,8 +223,13 @@ HRESULT ComPropertyStorage::Stat(STATPROPSETSTG* pstatpsstg)
 HRESULT ComPropertyStorage::WriteMultiple(ULONG cpspec, const PROPSPEC rgpspec[], 
 	const PROPVARIANT rgpropvar[], PROPID propidNameFirst)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pPropStorage->WriteMultiple(cpspec, rgpspec, rgpropvar, propidNameFirst);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pPropStorage->WriteMultiple(cpspec, rgpspec, rgpropvar, propidNameFirst); }
+	finally { m_statistics->PropertyStorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -183,8 +240,13 @@ HRESULT ComPropertyStorage::WriteMultiple(ULONG cpspec, const PROPSPEC rgpspec[]
 HRESULT ComPropertyStorage::WritePropertyNames(ULONG cpropid, const PROPID rgpropid[], 
 	LPWSTR const rglpwstrName[])
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pPropStorage->WritePropertyNames(cpropid, rgpropid, rglpwstrName);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pPropStorage->WritePropertyNames(cpropid, rgpropid, rglpwstrName); }
+	finally { m_statistics->PropertyStorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
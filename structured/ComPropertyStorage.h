@@ -26,6 +26,7 @@
 
 #include "IComPropertyStorage.h"		// Include IComPropertyStorage decls
 #include "StorageException.h"			// Include StorageException decls
+#include "StorageStatistics.h"			// Include StorageStatistics decls
 
 #pragma warning(push, 4)				// Enable maximum compiler warnings
 
@@ -48,7 +49,7 @@ public:
 	//-----------------------------------------------------------------------
 	// Constructor
 	
-	ComPropertyStorage(IPropertyStorage* pPropStorage);
+	ComPropertyStorage(IPropertyStorage* pPropStorage, StorageStatistics^ statistics);
 
 	//-----------------------------------------------------------------------
 	// Member Functions
@@ -130,6 +131,7 @@ private:
 
 	bool					m_disposed;			// Object disposal flag
 	IPropertyStorage*		m_pPropStorage;		// Contained IPropertyStorage
+	initonly StorageStatistics^	m_statistics;	// Runtime statistics
 };
 
 //---------------------------------------------------------------------------
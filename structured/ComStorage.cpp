@@ -33,13 +33,30 @@ BEGIN_ROOT_NAMESPACE(zuki::storage)
 // Arguments:
 //
 //	pStorage	- IStorage pointer to be wrapped up
+//	parent		- Parent storage, or NULLPTR for the root storage
+//	statistics	- Runtime statistics for the root storage
 
-ComStorage::ComStorage(IStorage* pStorage) : m_pStorage(pStorage), m_pPropStorage(NULL)
+ComStorage::ComStorage(IStorage* pStorage, ComStorage^ parent, StorageStatistics^ statistics) : 
+	m_pStorage(pStorage), m_pPropStorage(NULL), m_parent(parent), m_statistics(statistics)
 {
 	IPropertySetStorage*	pPropStorage;		// IPropertySetStorage
+	::STATSTG				stats;				// Storage statistics
 	HRESULT					hResult;			// Result from function call
 
 	if(!m_pStorage) throw gcnew ArgumentNullException();
+	if(m_statistics == nullptr) throw gcnew ArgumentNullException();
+
+	// The mode flags and the name of a storage can't change while it's open,
+	// so grab them once here rather than calling Stat() every time they're
+	// needed.  The name of every storage we create is a BASE64 encoded GUID;
+	// the root storage is named after the file and gets Guid::Empty instead
+
+	hResult = m_pStorage->Stat(&stats, STATFLAG_DEFAULT);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	m_mode = stats.grfMode;
+	try { m_contid = (stats.pwcsName) ? StorageUtil::Base64ToSysGuid(stats.pwcsName) : Guid::Empty; }
+	finally { if(stats.pwcsName) CoTaskMemFree(stats.pwcsName); }
 
 	// Since the IStorage and IPropertySetStorage interfaces are bound to the
 	// same underlying COM object instance, we have to maintain them both here
@@ -58,6 +75,7 @@ ComStorage::ComStorage(IStorage* pStorage) : m_pStorage(pStorage), m_pPropStorag
 	m_contMapper = gcnew StorageNameMapper(FMTID_ContainerNameMapper, this);
 	m_objMapper = gcnew StorageNameMapper(FMTID_ObjectNameMapper, this);
 	m_propSetMapper = gcnew StorageNameMapper(FMTID_PropertySetNameMapper, this);
+	m_tracker = gcnew StorageChangeTracker(this);
 }
 
 //---------------------------------------------------------------------------
@@ -68,6 +86,7 @@ ComStorage::~ComStorage()
 	delete m_propSetMapper;				// Dispose of property set mapper
 	delete m_objMapper;					// Dispose of object mapper
 	delete m_contMapper;				// Dispose of container mapper
+	delete m_tracker;					// Dispose of change tracker
 	
 	this->!ComStorage();				// Invoke the finalizer
 	m_disposed = true;					// Object is now disposed of
@@ -85,6 +104,17 @@ ComStorage::!ComStorage()
 	m_pStorage = NULL;
 }
 
+//---------------------------------------------------------------------------
+// ComStorage::ChangeTracker
+//
+// Accesses the contained StorageChangeTracker instance
+
+StorageChangeTracker^ ComStorage::ChangeTracker::get(void)
+{
+	CHECK_DISPOSED(m_disposed);
+	return m_tracker;
+}
+
 //---------------------------------------------------------------------------
 // ComStorage::Commit
 //
@@ -92,8 +122,13 @@ ComStorage::!ComStorage()
 
 HRESULT ComStorage::Commit(DWORD grfCommitFlags)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStorage->Commit(grfCommitFlags);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStorage->Commit(grfCommitFlags); }
+	finally { m_statistics->StorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -115,8 +150,13 @@ StorageNameMapper^ ComStorage::ContainerNameMapper::get(void)
 HRESULT ComStorage::CopyTo(DWORD ciidExclude, IID const* rgiidExclude, 
 	SNB snbExclude, IStorage* pstgDest)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStorage->CopyTo(ciidExclude, rgiidExclude, snbExclude, pstgDest);	
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStorage->CopyTo(ciidExclude, rgiidExclude, snbExclude, pstgDest); }
+	finally { m_statistics->StorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -127,8 +167,13 @@ HRESULT ComStorage::CopyTo(DWORD ciidExclude, IID const* rgiidExclude,
 HRESULT ComStorage::CreatePropertySet(REFFMTID fmtid, const CLSID* pclsid, DWORD grfFlags, 
 	DWORD grfMode, IPropertyStorage** ppPropStg)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pPropStorage->Create(fmtid, pclsid, grfFlags, grfMode, ppPropStg);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pPropStorage->Create(fmtid, pclsid, grfFlags, grfMode, ppPropStg); }
+	finally { m_statistics->StorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -139,8 +184,13 @@ HRESULT ComStorage::CreatePropertySet(REFFMTID fmtid, const CLSID* pclsid, DWORD
 HRESULT ComStorage::CreateStorage(const WCHAR* pwcsName, DWORD grfMode, 
 	DWORD reserved1, DWORD reserved2, IStorage** ppstg)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStorage->CreateStorage(pwcsName, grfMode, reserved1, reserved2, ppstg);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStorage->CreateStorage(pwcsName, grfMode, reserved1, reserved2, ppstg); }
+	finally { m_statistics->StorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -151,8 +201,13 @@ HRESULT ComStorage::CreateStorage(const WCHAR* pwcsName, DWORD grfMode,
 HRESULT ComStorage::CreateStream(const WCHAR* pwcsName, DWORD grfMode, DWORD reserved1,
 	DWORD reserved2, IStream** ppstm)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStorage->CreateStream(pwcsName, grfMode, reserved1, reserved2, ppstm);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStorage->CreateStream(pwcsName, grfMode, reserved1, reserved2, ppstm); }
+	finally { m_statistics->StorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -162,8 +217,13 @@ HRESULT ComStorage::CreateStream(const WCHAR* pwcsName, DWORD grfMode, DWORD res
 
 HRESULT ComStorage::DeletePropertySet(REFFMTID fmtid)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pPropStorage->Delete(fmtid);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pPropStorage->Delete(fmtid); }
+	finally { m_statistics->StorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -173,8 +233,13 @@ HRESULT ComStorage::DeletePropertySet(REFFMTID fmtid)
 
 HRESULT ComStorage::DestroyElement(const WCHAR* pwcsName)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStorage->DestroyElement(pwcsName);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStorage->DestroyElement(pwcsName); }
+	finally { m_statistics->StorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -185,8 +250,13 @@ HRESULT ComStorage::DestroyElement(const WCHAR* pwcsName)
 HRESULT ComStorage::EnumElements(DWORD reserved1, void* reserved2, DWORD reserved3, 
 	IEnumSTATSTG** ppenum)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStorage->EnumElements(reserved1, reserved2, reserved3, ppenum);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStorage->EnumElements(reserved1, reserved2, reserved3, ppenum); }
+	finally { m_statistics->StorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -196,8 +266,13 @@ HRESULT ComStorage::EnumElements(DWORD reserved1, void* reserved2, DWORD reserve
 
 HRESULT ComStorage::EnumPropertySets(IEnumSTATPROPSETSTG** ppenum)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pPropStorage->Enum(ppenum);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pPropStorage->Enum(ppenum); }
+	finally { m_statistics->StorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -208,8 +283,45 @@ HRESULT ComStorage::EnumPropertySets(IEnumSTATPROPSETSTG** ppenum)
 HRESULT ComStorage::MoveElementTo(const WCHAR* pwcsName, IStorage* pstgDest, 
 	LPWSTR pwcsNewName, DWORD grfFlags)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStorage->MoveElementTo(pwcsName, pstgDest, pwcsNewName, grfFlags);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStorage->MoveElementTo(pwcsName, pstgDest, pwcsNewName, grfFlags); }
+	finally { m_statistics->StorageCall(start); }
+}
+
+//---------------------------------------------------------------------------
+// ComStorage::MoveElementTo
+//
+// Copies or moves a substorage or stream into another ComStorage instance
+
+HRESULT ComStorage::MoveElementTo(const WCHAR* pwcsName, ComStorage^ dest, 
+	LPWSTR pwcsNewName, DWORD grfFlags)
+{
+	__int64				start;				// Call start timestamp
+	HRESULT				hResult;			// Result from function call
+
+	CHECK_DISPOSED(m_disposed);
+	if(dest == nullptr) throw gcnew ArgumentNullException();
+	CHECK_DISPOSED(dest->m_disposed);
+
+	// The source element can't be copied while a finalizable wrapper still
+	// has it open, so use the same STG_E_ACCESSDENIED retry as OpenStream()
+
+	start = Stopwatch::GetTimestamp();
+
+	try {
+
+		hResult = m_pStorage->MoveElementTo(pwcsName, dest->m_pStorage, pwcsNewName, grfFlags);
+		if(hResult != STG_E_ACCESSDENIED) return hResult;
+
+		GC::WaitForPendingFinalizers();
+		return m_pStorage->MoveElementTo(pwcsName, dest->m_pStorage, pwcsNewName, grfFlags);
+	}
+
+	finally { m_statistics->StorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -230,6 +342,7 @@ StorageNameMapper^ ComStorage::ObjectNameMapper::get(void)
 
 HRESULT ComStorage::OpenPropertySet(REFFMTID fmtid, DWORD grfMode, IPropertyStorage** ppPropStg)
 {
+	__int64				start;			// Call start timestamp
 	HRESULT				hResult;		// Result from function call
 
 	CHECK_DISPOSED(m_disposed);
@@ -240,11 +353,18 @@ HRESULT ComStorage::OpenPropertySet(REFFMTID fmtid, DWORD grfMode, IPropertyStor
 	// .NET gets around to finalizing everything.  If it still fails afterwards
 	// there is an actual problem, so don't do it more than once
 
-	hResult = m_pPropStorage->Open(fmtid, grfMode, ppPropStg);
-	if(hResult != STG_E_ACCESSDENIED) return hResult;
+	start = Stopwatch::GetTimestamp();
 
-	GC::WaitForPendingFinalizers();
-	return m_pPropStorage->Open(fmtid, grfMode, ppPropStg);
+	try {
+
+		hResult = m_pPropStorage->Open(fmtid, grfMode, ppPropStg);
+		if(hResult != STG_E_ACCESSDENIED) return hResult;
+
+		GC::WaitForPendingFinalizers();
+		return m_pPropStorage->Open(fmtid, grfMode, ppPropStg);
+	}
+
+	finally { m_statistics->StorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -255,6 +375,7 @@ HRESULT ComStorage::OpenPropertySet(REFFMTID fmtid, DWORD grfMode, IPropertyStor
 HRESULT ComStorage::OpenStorage(const WCHAR* pwcsName, IStorage* pstgPriority, 
 	DWORD grfMode, SNB snbExclude, DWORD reserved, IStorage** ppstg)
 {
+	__int64				start;			// Call start timestamp
 	HRESULT				hResult;		// Result from function call
 
 	CHECK_DISPOSED(m_disposed);
@@ -265,11 +386,18 @@ HRESULT ComStorage::OpenStorage(const WCHAR* pwcsName, IStorage* pstgPriority,
 	// .NET gets around to finalizing everything.  If it still fails afterwards
 	// there is an actual problem, so don't do it more than once
 
-	hResult = m_pStorage->OpenStorage(pwcsName, pstgPriority, grfMode, snbExclude, reserved, ppstg);
-	if(hResult != STG_E_ACCESSDENIED) return hResult;
+	start = Stopwatch::GetTimestamp();
+
+	try {
 
-	GC::WaitForPendingFinalizers();
-	return m_pStorage->OpenStorage(pwcsName, pstgPriority, grfMode, snbExclude, reserved, ppstg);
+		hResult = m_pStorage->OpenStorage(pwcsName, pstgPriority, grfMode, snbExclude, reserved, ppstg);
+		if(hResult != STG_E_ACCESSDENIED) return hResult;
+
+		GC::WaitForPendingFinalizers();
+		return m_pStorage->OpenStorage(pwcsName, pstgPriority, grfMode, snbExclude, reserved, ppstg);
+	}
+
+	finally { m_statistics->StorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -280,6 +408,7 @@ HRESULT ComStorage::OpenStorage(const WCHAR* pwcsName, IStorage* pstgPriority,
 HRESULT ComStorage::OpenStream(const WCHAR* pwcsName, void* reserved1, DWORD grfMode, 
 	DWORD reserved2, IStream** ppstm)
 {
+	__int64				start;				// Call start timestamp
 	HRESULT				hResult;			// Result from function call
 
 	CHECK_DISPOSED(m_disposed);
@@ -290,11 +419,18 @@ HRESULT ComStorage::OpenStream(const WCHAR* pwcsName, void* reserved1, DWORD grf
 	// .NET gets around to finalizing everything.  If it still fails afterwards
 	// there is an actual problem, so don't do it more than once
 
-	hResult = m_pStorage->OpenStream(pwcsName, reserved1, grfMode, reserved2, ppstm);
-	if(hResult != STG_E_ACCESSDENIED) return hResult;
+	start = Stopwatch::GetTimestamp();
+
+	try {
+
+		hResult = m_pStorage->OpenStream(pwcsName, reserved1, grfMode, reserved2, ppstm);
+		if(hResult != STG_E_ACCESSDENIED) return hResult;
+
+		GC::WaitForPendingFinalizers();
+		return m_pStorage->OpenStream(pwcsName, reserved1, grfMode, reserved2, ppstm);
+	}
 
-	GC::WaitForPendingFinalizers();
-	return m_pStorage->OpenStream(pwcsName, reserved1, grfMode, reserved2, ppstm);
+	finally { m_statistics->StorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -315,8 +451,13 @@ StorageNameMapper^ ComStorage::PropertySetNameMapper::get(void)
 
 HRESULT ComStorage::RenameElement(const WCHAR* pwcsOldName, const WCHAR* pwcsNewName)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStorage->RenameElement(pwcsOldName, pwcsNewName);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStorage->RenameElement(pwcsOldName, pwcsNewName); }
+	finally { m_statistics->StorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -326,8 +467,13 @@ HRESULT ComStorage::RenameElement(const WCHAR* pwcsOldName, const WCHAR* pwcsNew
 
 HRESULT ComStorage::Revert(void)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStorage->Revert();
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStorage->Revert(); }
+	finally { m_statistics->StorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -337,8 +483,13 @@ HRESULT ComStorage::Revert(void)
 
 HRESULT ComStorage::SetClass(REFCLSID clsid)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStorage->SetClass(clsid);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStorage->SetClass(clsid); }
+	finally { m_statistics->StorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -349,8 +500,13 @@ HRESULT ComStorage::SetClass(REFCLSID clsid)
 HRESULT ComStorage::SetElementTimes(const WCHAR* pwcsName, ::FILETIME const* pctime, 
 	::FILETIME const* patime, ::FILETIME const* pmtime)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStorage->SetElementTimes(pwcsName, pctime, patime, pmtime);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStorage->SetElementTimes(pwcsName, pctime, patime, pmtime); }
+	finally { m_statistics->StorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -360,8 +516,13 @@ HRESULT ComStorage::SetElementTimes(const WCHAR* pwcsName, ::FILETIME const* pct
 
 HRESULT ComStorage::SetStateBits(DWORD grfStateBits, DWORD grfMask)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStorage->SetStateBits(grfStateBits, grfMask);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStorage->SetStateBits(grfStateBits, grfMask); }
+	finally { m_statistics->StorageCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -371,8 +532,13 @@ HRESULT ComStorage::SetStateBits(DWORD grfStateBits, DWORD grfMask)
 
 HRESULT ComStorage::Stat(::STATSTG* pstatstg, DWORD grfStatFlag)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStorage->Stat(pstatstg, grfStatFlag);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStorage->Stat(pstatstg, grfStatFlag); }
+	finally { m_statistics->StorageCall(start); }
 }
 
 
@@ -24,10 +24,12 @@
 #define __COMSTORAGE_H_
 #pragma once
 
+#include "StorageChangeTracker.h"		// Include StorageChangeTracker decls
 #include "StorageNameMapper.h"			// Include StorageNameMapper declarations
 #include "IComPropertySetStorage.h"		// Include IComPropertySetStorage decls
 #include "IComStorage.h"				// Include IComStorage declarations
 #include "StorageException.h"			// Include StorageException decls
+#include "StorageStatistics.h"			// Include StorageStatistics decls
 
 #pragma warning(push, 4)				// Enable maximum compiler warnings
 
@@ -50,7 +52,7 @@ public:
 	//-----------------------------------------------------------------------
 	// Constructor
 	
-	ComStorage(IStorage* pStorage);
+	ComStorage(IStorage* pStorage, ComStorage^ parent, StorageStatistics^ statistics);
 
 	//-----------------------------------------------------------------------
 	// Member Functions
@@ -117,6 +119,12 @@ public:
 	virtual HRESULT MoveElementTo(const WCHAR* pwcsName, IStorage* pstgDest, LPWSTR pwcsNewName,
 		DWORD grfFlags);
 
+	// MoveElementTo
+	//
+	// Copies or moves a substorage or stream into another ComStorage instance
+	HRESULT MoveElementTo(const WCHAR* pwcsName, ComStorage^ dest, LPWSTR pwcsNewName,
+		DWORD grfFlags);
+
 	// OpenPropertySet (IComPropertySetStorage)
 	//
 	// Opens a property set contained in the property set storage object
@@ -169,6 +177,30 @@ public:
 	//-----------------------------------------------------------------------
 	// Properties
 
+	// ChangeTracker
+	//
+	// Accesses the modification time tracker for sub-storages and streams
+	property StorageChangeTracker^ ChangeTracker
+	{
+		StorageChangeTracker^ get(void);
+	}
+
+	// ChildMode
+	//
+	// Gets the mode flags to use when creating or opening child elements
+	property DWORD ChildMode
+	{
+		DWORD get(void) { return ((m_mode & 0xF) | STGM_SHARE_EXCLUSIVE); }
+	}
+
+	// ContainerID
+	//
+	// Gets the GUID encoded in the storage name, or Guid::Empty if none
+	property Guid ContainerID
+	{
+		Guid get(void) { return m_contid; }
+	}
+
 	// ContainerNameMapper
 	//
 	// Accesses the name mapper instance for sub-storages
@@ -177,6 +209,14 @@ public:
 		StorageNameMapper^ get(void);
 	}
 
+	// Mode
+	//
+	// Gets the mode flags that the storage was created or opened with
+	property DWORD Mode
+	{
+		DWORD get(void) { return m_mode; }
+	}
+
 	// ObjectNameMapper
 	//
 	// Accesses the name mapper instance for streams
@@ -185,6 +225,14 @@ public:
 		StorageNameMapper^ get(void);
 	}
 
+	// Parent
+	//
+	// Gets the parent storage, or NULLPTR if this is the root storage
+	property ComStorage^ Parent
+	{
+		ComStorage^ get(void) { return m_parent; }
+	}
+
 	// PropertySetNameMapper
 	//
 	// Accesses the name mapper instance for property sets
@@ -193,6 +241,22 @@ public:
 		StorageNameMapper^ get(void);
 	}
 
+	// ReadOnly
+	//
+	// Determines if the storage was created or opened as read-only
+	property bool ReadOnly
+	{
+		bool get(void) { return ((m_mode & 0xF) == STGM_READ); }
+	}
+
+	// Statistics
+	//
+	// Gets the runtime statistics shared by every wrapper in the storage
+	property StorageStatistics^ Statistics
+	{
+		StorageStatistics^ get(void) { return m_statistics; }
+	}
+
 private:
 
 	// DESTRUCTOR / FINALIZER
@@ -205,7 +269,12 @@ private:
 	bool					m_disposed;			// Object disposal flag
 	IStorage*				m_pStorage;			// Contained IStorage
 	IPropertySetStorage*	m_pPropStorage;		// Contained IPropertySetStorage
+	initonly DWORD			m_mode;				// Cached STATSTG mode flags
+	initonly Guid			m_contid;			// Cached container ID GUID
+	initonly ComStorage^	m_parent;			// Parent storage instance
+	initonly StorageStatistics^	m_statistics;	// Runtime statistics
 
+	StorageChangeTracker^	m_tracker;			// Modification time tracker
 	StorageNameMapper^		m_contMapper;		// Container name mapper
 	StorageNameMapper^		m_objMapper;		// Object name mapper
 	StorageNameMapper^		m_propSetMapper;	// Property Set name mapper
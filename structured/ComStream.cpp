@@ -33,12 +33,33 @@ BEGIN_ROOT_NAMESPACE(zuki::storage)
 // Arguments:
 //
 //	pStorage	- IStorage pointer to be wrapped up
+//	statistics	- Runtime statistics for the root storage
+//	cacheSize	- Size of the page cache in bytes, or zero for no cache
 
-ComStream::ComStream(IStream* pStream) : m_pStream(pStream)
+ComStream::ComStream(IStream* pStream, StorageStatistics^ statistics, int cacheSize) : m_pStream(pStream),
+	m_statistics(statistics), m_position(-1), m_streamPos(-1)
 {
+	::STATSTG				stats;				// Stream statistics
+	HRESULT					hResult;			// Result from function call
+
 	if(!m_pStream) throw gcnew ArgumentNullException();
+	if(m_statistics == nullptr) throw gcnew ArgumentNullException();
+	if(cacheSize < 0) throw gcnew ArgumentOutOfRangeException("cacheSize");
+
+	// The mode flags and the name of a stream can't change while it's open,
+	// so grab them once here rather than calling Stat() every time they're
+	// needed.  The name of every stream is a BASE64 encoded GUID
+
+	hResult = m_pStream->Stat(&stats, STATFLAG_DEFAULT);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	m_mode = stats.grfMode;
+	try { m_objid = (stats.pwcsName) ? StorageUtil::Base64ToSysGuid(stats.pwcsName) : Guid::Empty; }
+	finally { if(stats.pwcsName) CoTaskMemFree(stats.pwcsName); }
 
 	m_clones = gcnew List<WeakReference^>();
+	if(cacheSize > 0) m_cache = gcnew StorageStreamCache(Math::Max(cacheSize / StorageStreamCache::PAGE_SIZE, 1));
+
 	m_pStream->AddRef();
 }
 
@@ -51,7 +72,7 @@ ComStream::ComStream(IStream* pStream) : m_pStream(pStream)
 //	parent		- Reference to the parent ComStream instance
 
 ComStream::ComStream(IStream* pStream, ComStream^ parent) : m_pStream(pStream),
-	m_parent(parent)
+	m_parent(parent), m_position(-1), m_streamPos(-1)
 {
 	// This is the clone constructor.  There is absolutely zero chance that
 	// I'm going to remember the semantics of this next week, so you'll have
@@ -60,6 +81,11 @@ ComStream::ComStream(IStream* pStream, ComStream^ parent) : m_pStream(pStream),
 
 	if(!m_pStream) throw gcnew ArgumentNullException();
 	if(m_parent == nullptr) throw gcnew ArgumentNullException();
+
+	m_mode = m_parent->m_mode;			// Clones share the parent mode
+	m_objid = m_parent->m_objid;		// Clones share the parent GUID
+	m_statistics = m_parent->m_statistics;	// Clones share the statistics
+	m_cache = m_parent->m_cache;		// Clones share the page cache
 	
 	m_pStream->AddRef();				// AddRef() our local pointer
 }
@@ -78,6 +104,8 @@ ComStream::~ComStream()
 
 	if(m_clones != nullptr) {
 
+		lock cs(m_clones);				// Synchronize with CreateClone()
+
 		for each(WeakReference^ ref in m_clones) {
 
 			if(!ref->IsAlive) continue;		// Already dead, keep moving
@@ -112,8 +140,13 @@ ComStream::!ComStream()
 
 HRESULT ComStream::Commit(DWORD grfCommitFlags)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStream->Commit(grfCommitFlags);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStream->Commit(grfCommitFlags); }
+	finally { m_statistics->StreamCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -124,8 +157,37 @@ HRESULT ComStream::Commit(DWORD grfCommitFlags)
 HRESULT ComStream::CopyTo(IStream* pstm, ULARGE_INTEGER cb, ULARGE_INTEGER* pcbRead,
 	ULARGE_INTEGER* pcbWritten)
 {
+	ULARGE_INTEGER		cbRead;				// Number of bytes read
+	ULARGE_INTEGER		cbWritten;			// Number of bytes written
+	__int64				start;				// Call start timestamp
+	HRESULT				hResult;			// Result from function call
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStream->CopyTo(pstm, cb, pcbRead, pcbWritten);
+
+	// The byte counts are always needed for the statistics, so they can't
+	// be requested only when the caller happened to ask for them
+
+	cbRead.QuadPart = cbWritten.QuadPart = 0;
+
+	if(m_cache != nullptr) {
+
+		hResult = SyncPosition();
+		if(FAILED(hResult)) return hResult;
+	}
+
+	start = Stopwatch::GetTimestamp();
+	hResult = m_pStream->CopyTo(pstm, cb, &cbRead, &cbWritten);
+	m_statistics->StreamCall(start);
+
+	if(m_cache != nullptr) m_position = m_streamPos = m_position + static_cast<__int64>(cbRead.QuadPart);
+
+	m_statistics->AddBytesRead(static_cast<__int64>(cbRead.QuadPart));
+	m_statistics->AddBytesWritten(static_cast<__int64>(cbWritten.QuadPart));
+
+	if(pcbRead) *pcbRead = cbRead;
+	if(pcbWritten) *pcbWritten = cbWritten;
+
+	return hResult;
 }
 
 //---------------------------------------------------------------------------
@@ -149,6 +211,14 @@ HRESULT ComStream::CreateClone(ComStream^% clone)
 	if(m_parent != nullptr) throw gcnew InvalidOperationException();
 	if(m_clones == nullptr) throw gcnew InvalidOperationException();
 
+	lock cs(m_clones);						// Clones can come from any thread
+
+	// Drop any clones that have already been collected from the tracking list,
+	// otherwise it grows by one entry for every reader ever created
+
+	for(int index = m_clones->Count - 1; index >= 0; index--)
+		if(!m_clones[index]->IsAlive) m_clones->RemoveAt(index);
+
 	// Attempt to physically clone the stream instance to get a new IStream
 	// that has it's own seek pointer.  Also reset that seek pointer to zero.
 
@@ -172,6 +242,99 @@ HRESULT ComStream::CreateClone(ComStream^% clone)
 	return S_OK;							// Clone generation successful
 }
 
+//---------------------------------------------------------------------------
+// ComStream::GetPosition (private)
+//
+// Retrieves the current seek pointer from the underlying stream if it isn't
+// already being tracked
+//
+// Arguments:
+//
+//	NONE
+
+HRESULT ComStream::GetPosition(void)
+{
+	LARGE_INTEGER		liOffset;			// Offset as a LARGE_INTEGER
+	ULARGE_INTEGER		uliPosition;		// Current seek pointer
+	__int64				start;				// Call start timestamp
+	HRESULT				hResult;			// Result from function call
+
+	if(m_position >= 0) return S_OK;		// Already known
+
+	liOffset.QuadPart = 0;
+
+	start = Stopwatch::GetTimestamp();
+	hResult = m_pStream->Seek(liOffset, STREAM_SEEK_CUR, &uliPosition);
+	m_statistics->StreamCall(start);
+
+	if(FAILED(hResult)) return hResult;
+
+	m_position = m_streamPos = static_cast<__int64>(uliPosition.QuadPart);
+	return S_OK;
+}
+
+//---------------------------------------------------------------------------
+// ComStream::LoadPage (private)
+//
+// Reads a page of the stream into the page cache.  A page that comes back
+// shorter than PAGE_SIZE is the last one in the stream
+//
+// Arguments:
+//
+//	page		- Index of the page to be loaded
+//	data		- On success, receives the page data
+//	length		- On success, receives the number of bytes in the page
+
+HRESULT ComStream::LoadPage(__int64 page, array<Byte>^% data, int% length)
+{
+	LARGE_INTEGER		liOffset;			// Offset as a LARGE_INTEGER
+	PinnedBytePtr		pinData;			// Pinned page data
+	ULONG				cbRead;				// Number of bytes read
+	int					total = 0;			// Total number of bytes read
+	__int64				generation;			// Cache generation before read
+	__int64				start;				// Call start timestamp
+	HRESULT				hResult;			// Result from function call
+
+	data = gcnew array<Byte>(StorageStreamCache::PAGE_SIZE);
+	length = 0;
+
+	// Grab the generation before touching the stream; if a write invalidates
+	// anything while this page is being read, the cache won't accept it
+
+	generation = m_cache->Generation;
+
+	liOffset.QuadPart = page * StorageStreamCache::PAGE_SIZE;
+
+	start = Stopwatch::GetTimestamp();
+	hResult = m_pStream->Seek(liOffset, STREAM_SEEK_SET, NULL);
+	m_statistics->StreamCall(start);
+
+	if(FAILED(hResult)) { m_streamPos = -1; return hResult; }
+	m_streamPos = liOffset.QuadPart;
+
+	pinData = &data[0];
+
+	while(total < data->Length) {
+
+		start = Stopwatch::GetTimestamp();
+		hResult = m_pStream->Read(pinData + total, static_cast<ULONG>(data->Length - total), &cbRead);
+		m_statistics->StreamCall(start);
+
+		if(FAILED(hResult)) { m_streamPos = -1; return hResult; }
+
+		m_statistics->AddBytesRead(cbRead);
+		m_streamPos += cbRead;
+
+		if(cbRead == 0) break;
+		total += static_cast<int>(cbRead);
+	}
+
+	length = total;
+	m_cache->AddPage(page, data, length, generation);
+
+	return S_OK;
+}
+
 //---------------------------------------------------------------------------
 // ComStream::LockRegion
 //
@@ -179,8 +342,13 @@ HRESULT ComStream::CreateClone(ComStream^% clone)
 
 HRESULT ComStream::LockRegion(ULARGE_INTEGER libOffset, ULARGE_INTEGER cb, DWORD dwLockType)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStream->LockRegion(libOffset, cb, dwLockType);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStream->LockRegion(libOffset, cb, dwLockType); }
+	finally { m_statistics->StreamCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -190,8 +358,81 @@ HRESULT ComStream::LockRegion(ULARGE_INTEGER libOffset, ULARGE_INTEGER cb, DWORD
 
 HRESULT ComStream::Read(void* pv, ULONG cb, ULONG* pcbRead)
 {
+	ULONG				cbRead = 0;			// Number of bytes read
+	__int64				start;				// Call start timestamp
+	HRESULT				hResult;			// Result from function call
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStream->Read(pv, cb, pcbRead);
+
+	if(m_cache != nullptr) return ReadCached(pv, cb, pcbRead);
+
+	start = Stopwatch::GetTimestamp();
+	hResult = m_pStream->Read(pv, cb, &cbRead);
+	m_statistics->StreamCall(start);
+
+	m_statistics->AddBytesRead(cbRead);
+	if(pcbRead) *pcbRead = cbRead;
+
+	return hResult;
+}
+
+//---------------------------------------------------------------------------
+// ComStream::ReadCached (private)
+//
+// Reads from the stream at the tracked seek pointer, copying the data out
+// of the page cache and loading any pages that aren't already cached
+//
+// Arguments:
+//
+//	pv			- Buffer to read the data into
+//	cb			- Number of bytes to read
+//	pcbRead		- Optionally receives the number of bytes read
+
+HRESULT ComStream::ReadCached(void* pv, ULONG cb, ULONG* pcbRead)
+{
+	array<Byte>^		data;				// Page data
+	PinnedBytePtr		pinData;			// Pinned page data
+	int					length;				// Length of the page data
+	int					offset;				// Offset into the page
+	int					count;				// Bytes to copy from the page
+	ULONG				total = 0;			// Total number of bytes read
+	__int64				page;				// Current page index
+	HRESULT				hResult;			// Result from function call
+
+	hResult = GetPosition();
+
+	while(SUCCEEDED(hResult) && (total < cb)) {
+
+		page = m_position / StorageStreamCache::PAGE_SIZE;
+		offset = static_cast<int>(m_position % StorageStreamCache::PAGE_SIZE);
+
+		if(m_cache->TryGetPage(page, data, length)) m_statistics->PageCacheHit();
+		else {
+
+			m_statistics->PageCacheMiss();
+
+			hResult = LoadPage(page, data, length);
+			if(FAILED(hResult)) break;
+		}
+
+		if(offset >= length) break;			// At or beyond the end of the stream
+
+		count = static_cast<int>(Math::Min(static_cast<__int64>(length - offset), static_cast<__int64>(cb - total)));
+
+		pinData = &data[offset];
+		memcpy(static_cast<BYTE*>(pv) + total, pinData, count);
+		pinData = nullptr;
+
+		total += count;
+		m_position += count;
+
+		// A partial page is the last page, don't bother looking for another
+
+		if((length < StorageStreamCache::PAGE_SIZE) && ((offset + count) >= length)) break;
+	}
+
+	if(pcbRead) *pcbRead = total;
+	return hResult;
 }
 
 //---------------------------------------------------------------------------
@@ -201,8 +442,15 @@ HRESULT ComStream::Read(void* pv, ULONG cb, ULONG* pcbRead)
 
 HRESULT ComStream::Revert(void)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStream->Revert();
+
+	if(m_cache != nullptr) m_cache->Clear();
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStream->Revert(); }
+	finally { m_statistics->StreamCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -212,8 +460,54 @@ HRESULT ComStream::Revert(void)
 
 HRESULT ComStream::Seek(LARGE_INTEGER dlibMove, DWORD dwOrigin, ULARGE_INTEGER* plibNewPosition)
 {
+	__int64				position;			// New seek pointer
+	ULARGE_INTEGER		uliPosition;		// New seek pointer
+	__int64				start;				// Call start timestamp
+	HRESULT				hResult;			// Result from function call
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStream->Seek(dlibMove, dwOrigin, plibNewPosition);
+
+	// With a page cache the seek pointer is only tracked here.  A seek from
+	// the end still has to go to the stream, since that knows the length
+
+	if(m_cache != nullptr) {
+
+		if(dwOrigin == STREAM_SEEK_END) {
+
+			start = Stopwatch::GetTimestamp();
+			hResult = m_pStream->Seek(dlibMove, dwOrigin, &uliPosition);
+			m_statistics->StreamCall(start);
+
+			if(FAILED(hResult)) return hResult;
+
+			m_position = m_streamPos = static_cast<__int64>(uliPosition.QuadPart);
+			if(plibNewPosition) *plibNewPosition = uliPosition;
+
+			return S_OK;
+		}
+
+		if(dwOrigin == STREAM_SEEK_CUR) {
+
+			hResult = GetPosition();
+			if(FAILED(hResult)) return hResult;
+
+			position = m_position + dlibMove.QuadPart;
+		}
+
+		else if(dwOrigin == STREAM_SEEK_SET) position = dlibMove.QuadPart;
+		else return STG_E_INVALIDFUNCTION;
+
+		if(position < 0) return STG_E_INVALIDFUNCTION;
+
+		m_position = position;
+		if(plibNewPosition) plibNewPosition->QuadPart = static_cast<ULONGLONG>(position);
+
+		return S_OK;
+	}
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStream->Seek(dlibMove, dwOrigin, plibNewPosition); }
+	finally { m_statistics->StreamCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -223,8 +517,18 @@ HRESULT ComStream::Seek(LARGE_INTEGER dlibMove, DWORD dwOrigin, ULARGE_INTEGER*
 
 HRESULT ComStream::SetSize(ULARGE_INTEGER libNewSize)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStream->SetSize(libNewSize);
+
+	// Changing the size moves the end of the stream and can discard data, so
+	// nothing that's in the page cache can be trusted afterwards
+
+	if(m_cache != nullptr) m_cache->Clear();
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStream->SetSize(libNewSize); }
+	finally { m_statistics->StreamCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -234,8 +538,44 @@ HRESULT ComStream::SetSize(ULARGE_INTEGER libNewSize)
 
 HRESULT ComStream::Stat(::STATSTG* pstatstg, DWORD grfStatFlag)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStream->Stat(pstatstg, grfStatFlag);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStream->Stat(pstatstg, grfStatFlag); }
+	finally { m_statistics->StreamCall(start); }
+}
+
+//---------------------------------------------------------------------------
+// ComStream::SyncPosition (private)
+//
+// Moves the seek pointer of the underlying stream to the tracked position,
+// if it isn't already there
+//
+// Arguments:
+//
+//	NONE
+
+HRESULT ComStream::SyncPosition(void)
+{
+	LARGE_INTEGER		liOffset;			// Offset as a LARGE_INTEGER
+	__int64				start;				// Call start timestamp
+	HRESULT				hResult;			// Result from function call
+
+	hResult = GetPosition();
+	if(FAILED(hResult)) return hResult;
+
+	if(m_streamPos == m_position) return S_OK;
+
+	liOffset.QuadPart = m_position;
+
+	start = Stopwatch::GetTimestamp();
+	hResult = m_pStream->Seek(liOffset, STREAM_SEEK_SET, NULL);
+	m_statistics->StreamCall(start);
+
+	m_streamPos = (SUCCEEDED(hResult)) ? m_position : -1;
+	return hResult;
 }
 
 //---------------------------------------------------------------------------
@@ -245,8 +585,13 @@ HRESULT ComStream::Stat(::STATSTG* pstatstg, DWORD grfStatFlag)
 
 HRESULT ComStream::UnlockRegion(ULARGE_INTEGER libOffset, ULARGE_INTEGER cb, DWORD dwLockType)
 {
+	__int64				start;				// Call start timestamp
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStream->UnlockRegion(libOffset, cb, dwLockType);
+
+	start = Stopwatch::GetTimestamp();
+	try { return m_pStream->UnlockRegion(libOffset, cb, dwLockType); }
+	finally { m_statistics->StreamCall(start); }
 }
 
 //---------------------------------------------------------------------------
@@ -256,8 +601,35 @@ HRESULT ComStream::UnlockRegion(ULARGE_INTEGER libOffset, ULARGE_INTEGER cb, DWO
 
 HRESULT ComStream::Write(void const* pv, ULONG cb, ULONG* pcbWritten)
 {
+	ULONG				cbWritten = 0;		// Number of bytes written
+	__int64				start;				// Call start timestamp
+	HRESULT				hResult;			// Result from function call
+
 	CHECK_DISPOSED(m_disposed);
-	return m_pStream->Write(pv, cb, pcbWritten);
+
+	if(m_cache != nullptr) {
+
+		hResult = SyncPosition();
+		if(FAILED(hResult)) return hResult;
+	}
+
+	start = Stopwatch::GetTimestamp();
+	hResult = m_pStream->Write(pv, cb, &cbWritten);
+	m_statistics->StreamCall(start);
+
+	// Every clone shares the page cache, so they all stop seeing the pages
+	// that were just overwritten
+
+	if(m_cache != nullptr) {
+
+		m_cache->Invalidate(m_position, cbWritten);
+		m_position = m_streamPos = m_position + cbWritten;
+	}
+
+	m_statistics->AddBytesWritten(cbWritten);
+	if(pcbWritten) *pcbWritten = cbWritten;
+
+	return hResult;
 }
 
 //---------------------------------------------------------------------------
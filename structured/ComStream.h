@@ -26,11 +26,15 @@
 
 #include "IComStream.h"					// Include IComStream declarations
 #include "StorageException.h"			// Include StorageException decls
+#include "StorageStatistics.h"			// Include StorageStatistics decls
+#include "StorageStreamCache.h"			// Include StorageStreamCache decls
+#include "StorageUtil.h"				// Include StorageUtil declarations
 
 #pragma warning(push, 4)				// Enable maximum compiler warnings
 
 using namespace System;
 using namespace System::Collections::Generic;
+using namespace msclr;
 
 BEGIN_ROOT_NAMESPACE(zuki::storage)
 
@@ -40,6 +44,14 @@ BEGIN_ROOT_NAMESPACE(zuki::storage)
 // ComStream implements a safe pointer class that allows a COM pointer
 // to be safely shared among managed object instances, and implements thread
 // safety for all member functions
+//
+// If a cache size is specified, reads are served from a page cache that is
+// shared with all of the clones.  The seek pointer is then tracked here and
+// only moved in the underlying stream when something actually needs it, so
+// a Seek() and Read() of cached data never make a COM call at all.  Like the
+// IStream seek pointer itself, the tracked position is not synchronized: an
+// instance with a page cache must only be used by one thread at a time, and
+// other threads should use their own clones
 //---------------------------------------------------------------------------
 
 ref class ComStream sealed : public IComStream
@@ -49,7 +61,7 @@ public:
 	//-----------------------------------------------------------------------
 	// Constructors
 	
-	ComStream(IStream* pStream);
+	ComStream(IStream* pStream, StorageStatistics^ statistics, int cacheSize);
 
 	//-----------------------------------------------------------------------
 	// Member Functions
@@ -115,6 +127,33 @@ public:
 	// Writes a specified number of bytes into the stream object
 	virtual HRESULT Write(void const* pv, ULONG cb, ULONG* pcbWritten);
 
+	//-----------------------------------------------------------------------
+	// Properties
+
+	// Mode
+	//
+	// Gets the mode flags that the stream was created or opened with
+	property DWORD Mode
+	{
+		DWORD get(void) { return m_mode; }
+	}
+
+	// ObjectID
+	//
+	// Gets the GUID encoded in the stream name
+	property Guid ObjectID
+	{
+		Guid get(void) { return m_objid; }
+	}
+
+	// ReadOnly
+	//
+	// Determines if the stream was created or opened as read-only
+	property bool ReadOnly
+	{
+		bool get(void) { return ((m_mode & 0xF) == STGM_READ); }
+	}
+
 private:
 
 	// PRIVATE CONSTRUCTOR
@@ -133,6 +172,26 @@ private:
 	virtual HRESULT Clone(IStream**) sealed = IComStream::Clone
 		{ throw gcnew NotSupportedException(); }
 
+	// GetPosition
+	//
+	// Retrieves the current seek pointer if it isn't already known
+	HRESULT GetPosition(void);
+
+	// LoadPage
+	//
+	// Reads a page of the stream into the page cache
+	HRESULT LoadPage(__int64 page, array<Byte>^% data, int% length);
+
+	// ReadCached
+	//
+	// Reads from the stream through the page cache
+	HRESULT ReadCached(void* pv, ULONG cb, ULONG* pcbRead);
+
+	// SyncPosition
+	//
+	// Moves the underlying seek pointer to the tracked position
+	HRESULT SyncPosition(void);
+
 	//-----------------------------------------------------------------------
 	// Member Variables
 
@@ -140,6 +199,12 @@ private:
 	IStream*				m_pStream;			// Contained IStream
 	ComStream^				m_parent;			// Cloned stream parent
 	List<WeakReference^>^	m_clones;			// List of clones
+	initonly DWORD			m_mode;				// Cached STATSTG mode flags
+	initonly Guid			m_objid;			// Cached object ID GUID
+	initonly StorageStatistics^	m_statistics;	// Runtime statistics
+	StorageStreamCache^		m_cache;			// Shared page cache
+	__int64					m_position;			// Tracked seek pointer
+	__int64					m_streamPos;		// Underlying seek pointer
 };
 
 //---------------------------------------------------------------------------
@@ -0,0 +1,101 @@
+//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+
+#ifndef __READWRITELOCK_H_
+#define __READWRITELOCK_H_
+#pragma once
+
+#pragma warning(push, 4)					// Enable maximum compiler warnings
+
+using namespace System;
+using namespace System::Threading;
+
+BEGIN_ROOT_NAMESPACE(zuki::storage)
+
+//---------------------------------------------------------------------------
+// Class ReadLock (internal)
+//
+// ReadLock is the ReaderWriterLockSlim counterpart to msclr::lock.  Declare
+// it on the stack to hold a shared read lock until it goes out of scope.
+//---------------------------------------------------------------------------
+
+ref class ReadLock sealed
+{
+public:
+
+	//-----------------------------------------------------------------------
+	// Constructor / Destructor
+
+	ReadLock(ReaderWriterLockSlim^ rwlock) : m_lock(rwlock)
+	{
+		if(m_lock == nullptr) throw gcnew ArgumentNullException();
+		m_lock->EnterReadLock();
+	}
+
+	~ReadLock() { m_lock->ExitReadLock(); }
+
+private:
+
+	//-----------------------------------------------------------------------
+	// Member Variables
+
+	ReaderWriterLockSlim^		m_lock;				// Referenced lock object
+};
+
+//---------------------------------------------------------------------------
+// Class WriteLock (internal)
+//
+// WriteLock is the ReaderWriterLockSlim counterpart to msclr::lock.  Declare
+// it on the stack to hold an exclusive write lock until it goes out of scope.
+//---------------------------------------------------------------------------
+
+ref class WriteLock sealed
+{
+public:
+
+	//-----------------------------------------------------------------------
+	// Constructor / Destructor
+
+	WriteLock(ReaderWriterLockSlim^ rwlock) : m_lock(rwlock)
+	{
+		if(m_lock == nullptr) throw gcnew ArgumentNullException();
+		m_lock->EnterWriteLock();
+	}
+
+	~WriteLock() { m_lock->ExitWriteLock(); }
+
+private:
+
+	//-----------------------------------------------------------------------
+	// Member Variables
+
+	ReaderWriterLockSlim^		m_lock;				// Referenced lock object
+};
+
+//---------------------------------------------------------------------------
+
+END_ROOT_NAMESPACE(zuki::storage)
+
+#pragma warning(pop)
+
+#endif	// __READWRITELOCK_H_
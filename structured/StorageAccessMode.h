@@ -34,9 +34,23 @@ BEGIN_ROOT_NAMESPACE(zuki::storage)
 // The StorageAccessMode enumeration defines the various options for access
 // and sharing when opening a StructuredStorage file.
 //
-// For now, I'm only supporting DIRECT mode and very limited sharing.  At 
-// some point in the future, this may change to allow transactional and/or
-// DIRECT_SWMR support (after many changes to the code)
+// Transacted opens the root storage in TRANSACTED mode, which is intended
+// for high rates of small updates.  Changes are written sequentially into
+// the scratch area and only merged into the compound file when the storage
+// is flushed or closed, so every flush acts as a checkpoint.  If the process
+// dies between checkpoints the file reopens exactly as it was at the last
+// one.  Child elements are always opened in DIRECT mode within the root.
+//
+// TransactedShared and ReadOnlySnapshot let writers and any number of readers
+// have the same file open at once.  Nothing prevents more than one writer;
+// each commit of a shared writer fails with STG_E_NOTCURRENT if another one
+// has committed since, so in practice only one writer should be used.  Both
+// are NOSNAPSHOT modes, so a flush appends the committed sectors rather than
+// overwriting the ones in use; each reader keeps seeing the file exactly as
+// it was when it opened it, without a copy being made.  Readers reopen to
+// pick up newer commits.
+// The file grows while it's shared since space isn't reclaimed until there
+// is only a single opener left.
 //---------------------------------------------------------------------------
 
 STRUCTURED_STORAGE_PUBLIC enum struct StorageAccessMode
@@ -44,6 +58,9 @@ STRUCTURED_STORAGE_PUBLIC enum struct StorageAccessMode
 	Exclusive			= STGM_DIRECT | STGM_READWRITE | STGM_SHARE_EXCLUSIVE,
 	ReadOnlyExclusive	= STGM_DIRECT | STGM_READ | STGM_SHARE_EXCLUSIVE,
 	ReadOnlyShared		= STGM_DIRECT | STGM_READ | STGM_SHARE_DENY_WRITE,
+	ReadOnlySnapshot	= STGM_TRANSACTED | STGM_NOSNAPSHOT | STGM_READ | STGM_SHARE_DENY_NONE,
+	Transacted			= STGM_TRANSACTED | STGM_READWRITE | STGM_SHARE_EXCLUSIVE,
+	TransactedShared	= STGM_TRANSACTED | STGM_NOSNAPSHOT | STGM_READWRITE | STGM_SHARE_DENY_NONE,
 };
 
 //---------------------------------------------------------------------------
@@ -0,0 +1,350 @@
+//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+#include "stdafx.h"						// Include project pre-compiled headers
+#include "StorageChangeTracker.h"		// Include StorageChangeTracker declarations
+#include "ComStorage.h"					// Include ComStorage declarations
+
+#pragma warning(push, 4)				// Enable maximum compiler warnings
+
+BEGIN_ROOT_NAMESPACE(zuki::storage)
+
+//---------------------------------------------------------------------------
+// Custom property set FMTID codes
+//---------------------------------------------------------------------------
+
+#include "initguid.h"					// Include INITGUID declarations
+
+// FMTID_ChangeTracker {6B1F0E4A-3C2D-4F5B-9E77-1A08C4D2B913}
+// Used as the FMTID for the custom element modification time properties
+DEFINE_GUID(FMTID_ChangeTracker, 
+0x6b1f0e4a, 0x3c2d, 0x4f5b, 0x9e, 0x77, 0x1a, 0x08, 0xc4, 0xd2, 0xb9, 0x13);
+
+// FMTID_UnchangedObjects {E2A7C5D1-8B64-4E0F-A3D9-5C71F02B6E48}
+// Used as the FMTID for the list of objects left out of an exported delta
+DEFINE_GUID(FMTID_UnchangedObjects, 
+0xe2a7c5d1, 0x8b64, 0x4e0f, 0xa3, 0xd9, 0x5c, 0x71, 0xf0, 0x2b, 0x6e, 0x48);
+
+//---------------------------------------------------------------------------
+// StorageChangeTracker Implementation
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+// StorageChangeTracker Constructor
+//
+// Arguments:
+//
+//	storage		- Referenced parent ComStorage interface
+
+StorageChangeTracker::StorageChangeTracker(ComStorage^ storage) : m_storage(storage)
+{
+	if(m_storage == nullptr) throw gcnew ArgumentNullException();
+	m_lock = gcnew Object();
+}
+
+//---------------------------------------------------------------------------
+// StorageChangeTracker Finalizer
+
+StorageChangeTracker::!StorageChangeTracker()
+{
+	if(m_pPropStorage) m_pPropStorage->Release();
+	m_pPropStorage = NULL;
+}
+
+//---------------------------------------------------------------------------
+// StorageChangeTracker::Forget
+//
+// Removes the modification time recorded for an element.  Forgetting an
+// element that still exists is harmless; it just looks modified afterwards
+//
+// Arguments:
+//
+//	id			- GUID of the element to be forgotten
+
+HRESULT StorageChangeTracker::Forget(Guid id)
+{
+	return Forget(gcnew array<Guid> { id });
+}
+
+//---------------------------------------------------------------------------
+// StorageChangeTracker::Forget
+//
+// Removes the modification times recorded for a set of elements, with a
+// single Commit() for all of them
+//
+// Arguments:
+//
+//	ids			- GUIDs of the elements to be forgotten
+
+HRESULT StorageChangeTracker::Forget(IEnumerable<Guid>^ ids)
+{
+	lock					cs(m_lock);			// Automatic lock
+	IPropertyStorage*		pPropStorage;		// IPropertyStorage interface
+	PROPSPEC				propspec;			// Property specification
+	PinnedStringPtr			pinName;			// Pinned string pointer
+	String^					name;				// Property name string
+	HRESULT					hResult;			// Result from function call
+
+	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
+
+	if(ids == nullptr) throw gcnew ArgumentNullException();
+
+	hResult = GetPropertyStorage(&pPropStorage);
+	if(FAILED(hResult)) return hResult;
+
+	propspec.ulKind = PRSPEC_LPWSTR;
+
+	for each(Guid id in ids) {
+
+		name = id.ToString("N");				// Property name is the GUID
+		pinName = PtrToStringChars(name);		// Pin the string
+		propspec.lpwstr = const_cast<LPWSTR>(pinName);
+
+		hResult = pPropStorage->DeleteMultiple(1, &propspec);
+		if(FAILED(hResult)) return hResult;
+	}
+
+	return pPropStorage->Commit(STGC_DEFAULT);
+}
+
+//---------------------------------------------------------------------------
+// StorageChangeTracker::GetPropertyStorage (private)
+//
+// Retrieves a pointer to the contained IPropertyStorage interface, creating
+// the property set if it doesn't already exist.  Must be called with the
+// lock held
+//
+// Arguments:
+//
+//	ppPropStorage	- On success, contains the IPropertyStorage pointer
+
+HRESULT StorageChangeTracker::GetPropertyStorage(IPropertyStorage** ppPropStorage)
+{
+	IComPropertySetStorage^		propSetStorage;		// IComPropertySetStorage
+	bool						readOnly;			// IStorage read-only flag
+	HRESULT						hResult;			// Result from function call
+
+	*ppPropStorage = NULL;							// Initialize [out] to NULL
+
+	if(m_pPropStorage) { *ppPropStorage = m_pPropStorage; return S_OK; }
+
+	propSetStorage = safe_cast<IComPropertySetStorage^>(m_storage);
+	readOnly = m_storage->ReadOnly;
+
+	// First try to open an existing property set, and if that doesn't exist
+	// create a new one (unless the storage is read-only, of course)
+
+	hResult = propSetStorage->Open(FMTID_ChangeTracker, (readOnly ? STGM_READ : STGM_READWRITE) | 
+		STGM_SHARE_EXCLUSIVE, ppPropStorage);
+
+	if((hResult == STG_E_FILENOTFOUND) && (!readOnly)) {
+		
+		hResult = propSetStorage->Create(FMTID_ChangeTracker, NULL, PROPSETFLAG_DEFAULT, 
+			STGM_READWRITE | STGM_SHARE_EXCLUSIVE, ppPropStorage);
+	}
+
+	if(FAILED(hResult)) return hResult;			// Failed to create/access
+	
+	m_pPropStorage = *ppPropStorage;			// Cache off the pointer
+	return S_OK;								// Success
+}
+
+//---------------------------------------------------------------------------
+// StorageChangeTracker::ToDictionary
+//
+// Loads every recorded modification time.  The property set is enumerated
+// and read in batches, the same way that StorageNameMapper loads it's index
+//
+// Arguments:
+//
+//	NONE
+
+Dictionary<Guid, DateTime>^ StorageChangeTracker::ToDictionary(void)
+{
+	lock					cs(m_lock);			// Automatic lock
+	IPropertyStorage*		pPropStorage;		// IPropertyStorage interface
+	IEnumSTATPROPSTG*		pEnumStg;			// Storage enumerator
+	STATPROPSTG				rgstatstg[TRACKER_BATCHSIZE];		// Enumerated information
+	PROPSPEC				rgpropspec[TRACKER_BATCHSIZE];		// Property specifications
+	PROPVARIANT				rgvarProperty[TRACKER_BATCHSIZE];	// Property values
+	ULONG					ulRead;				// Number of items read
+	Guid					id;					// Element GUID
+	HRESULT					hResult;			// Result from function call
+
+	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
+
+	Dictionary<Guid, DateTime>^ times = gcnew Dictionary<Guid, DateTime>();
+
+	// A storage that has never been modified through this library doesn't
+	// have the property set yet; that just means nothing is tracked
+
+	if(FAILED(GetPropertyStorage(&pPropStorage))) return times;
+
+	hResult = pPropStorage->Enum(&pEnumStg);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	try {
+
+		do {
+
+			hResult = pEnumStg->Next(TRACKER_BATCHSIZE, rgstatstg, &ulRead);
+			if(FAILED(hResult)) throw gcnew StorageException(hResult);
+			if(ulRead == 0) break;
+
+			try {
+
+				for(ULONG index = 0; index < ulRead; index++) {
+
+					rgpropspec[index].ulKind = PRSPEC_PROPID;
+					rgpropspec[index].propid = rgstatstg[index].propid;
+				}
+
+				memset(rgvarProperty, 0, sizeof(PROPVARIANT) * ulRead);
+
+				HRESULT hRead = pPropStorage->ReadMultiple(ulRead, rgpropspec, rgvarProperty);
+				if(FAILED(hRead)) throw gcnew StorageException(hRead);
+
+				try {
+
+					for(ULONG index = 0; index < ulRead; index++) {
+
+						if((rgvarProperty[index].vt != VT_FILETIME) || (!rgstatstg[index].lpwstrName)) continue;
+						if(!Guid::TryParseExact(gcnew String(rgstatstg[index].lpwstrName), "N", id)) continue;
+
+						times[id] = DateTime::FromFileTimeUtc((static_cast<__int64>(rgvarProperty[index].filetime.dwHighDateTime) << 32) |
+							rgvarProperty[index].filetime.dwLowDateTime);
+					}
+				}
+
+				finally { FreePropVariantArray(ulRead, rgvarProperty); }
+			}
+
+			finally { 
+				
+				for(ULONG index = 0; index < ulRead; index++)
+					if(rgstatstg[index].lpwstrName) CoTaskMemFree(rgstatstg[index].lpwstrName);
+			}
+
+		} while(hResult == S_OK);
+	}
+
+	finally { pEnumStg->Release(); }			// Make sure this gets released
+
+	return times;
+}
+
+//---------------------------------------------------------------------------
+// StorageChangeTracker::Touch
+//
+// Records the current time as the modification time of an element
+//
+// Arguments:
+//
+//	id			- GUID of the element that has been modified
+
+HRESULT StorageChangeTracker::Touch(Guid id)
+{
+	lock					cs(m_lock);			// Automatic lock
+	IPropertyStorage*		pPropStorage;		// IPropertyStorage interface
+	PROPSPEC				propspec;			// Property specification
+	PinnedStringPtr			pinName;			// Pinned string pointer
+	String^					name;				// Property name string
+	PROPVARIANT				varValue;			// value as a PROPVARIANT
+	__int64					now;				// Current time as a FILETIME
+	HRESULT					hResult;			// Result from function call
+
+	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
+
+	hResult = GetPropertyStorage(&pPropStorage);
+	if(FAILED(hResult)) return hResult;
+
+	name = id.ToString("N");					// Property name is the GUID
+	pinName = PtrToStringChars(name);			// Pin the string
+	now = DateTime::UtcNow.ToFileTimeUtc();		// Get the current time
+	PropVariantInit(&varValue);					// Initialize PROPVARIANT
+
+	varValue.vt = VT_FILETIME;
+	varValue.filetime.dwLowDateTime = static_cast<DWORD>(now & 0xFFFFFFFF);
+	varValue.filetime.dwHighDateTime = static_cast<DWORD>(now >> 32);
+
+	propspec.ulKind = PRSPEC_LPWSTR;
+	propspec.lpwstr = const_cast<LPWSTR>(pinName);
+
+	hResult = pPropStorage->WriteMultiple(1, &propspec, &varValue, TRACKER_BASEID);
+	if(FAILED(hResult)) return hResult;
+
+	return pPropStorage->Commit(STGC_DEFAULT);
+}
+
+//---------------------------------------------------------------------------
+// StorageChangeTracker::TryGetTime
+//
+// Retrieves the recorded modification time of an element
+//
+// Arguments:
+//
+//	id			- GUID of the element to look up
+//	time		- On success, contains the modification time (UTC)
+
+bool StorageChangeTracker::TryGetTime(Guid id, DateTime% time)
+{
+	lock					cs(m_lock);			// Automatic lock
+	IPropertyStorage*		pPropStorage;		// IPropertyStorage interface
+	PROPSPEC				propspec;			// Property specification
+	PinnedStringPtr			pinName;			// Pinned string pointer
+	String^					name;				// Property name string
+	PROPVARIANT				varValue;			// value as a PROPVARIANT
+	HRESULT					hResult;			// Result from function call
+
+	time = DateTime::MinValue;					// Initialize [out] reference
+
+	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
+
+	if(FAILED(GetPropertyStorage(&pPropStorage))) return false;
+
+	name = id.ToString("N");					// Property name is the GUID
+	pinName = PtrToStringChars(name);			// Pin the string
+	PropVariantInit(&varValue);					// Initialize PROPVARIANT
+
+	propspec.ulKind = PRSPEC_LPWSTR;
+	propspec.lpwstr = const_cast<LPWSTR>(pinName);
+
+	hResult = pPropStorage->ReadMultiple(1, &propspec, &varValue);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	try {
+
+		if(varValue.vt != VT_FILETIME) return false;		// Not tracked
+
+		time = DateTime::FromFileTimeUtc((static_cast<__int64>(varValue.filetime.dwHighDateTime) << 32) |
+			varValue.filetime.dwLowDateTime);
+		return true;
+	}
+
+	finally { PropVariantClear(&varValue); }
+}
+
+//---------------------------------------------------------------------------
+
+END_ROOT_NAMESPACE(zuki::storage)
+
+#pragma warning(pop)
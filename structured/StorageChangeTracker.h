@@ -0,0 +1,141 @@
+//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+#ifndef __STORAGECHANGETRACKER_H_
+#define __STORAGECHANGETRACKER_H_
+#pragma once
+
+#include "StorageException.h"			// Include StorageException decls
+#include "StorageUtil.h"				// Include StorageUtil declarations
+
+#pragma warning(push, 4)				// Enable maximum compiler warnings
+
+using namespace System;
+using namespace System::Collections::Generic;
+using namespace msclr;
+
+BEGIN_ROOT_NAMESPACE(zuki::storage)
+
+//---------------------------------------------------------------------------
+// Custom property set FMTID codes
+//---------------------------------------------------------------------------
+
+extern const FMTID FMTID_ChangeTracker;			// StorageChangeTracker.cpp
+extern const FMTID FMTID_UnchangedObjects;		// StorageChangeTracker.cpp
+
+//---------------------------------------------------------------------------
+// Forward class declarations
+//---------------------------------------------------------------------------
+
+ref class ComStorage;							// ComStorage.h
+
+//---------------------------------------------------------------------------
+// Class StorageChangeTracker (internal)
+//
+// StorageChangeTracker implements a specialized property set used to record
+// the last time each object and sub container of a storage was modified.
+// The compound file implementation doesn't keep any times for streams, so
+// STATSTG can't be used for this.  Each entry is named after the element
+// GUID (as hex digits, property names are case-insensitive) and holds a
+// VT_FILETIME in UTC.
+//
+// An element without an entry has to be treated as modified, which keeps
+// files written before tracking existed and elements that were created by
+// the storage engine itself (see StorageContainer::CopyObject) safe.
+//---------------------------------------------------------------------------
+
+ref class StorageChangeTracker sealed
+{
+public:
+
+	//-----------------------------------------------------------------------
+	// Constructor
+
+	StorageChangeTracker(ComStorage^ storage);
+
+	//-----------------------------------------------------------------------
+	// Member Functions
+
+	// Forget
+	//
+	// Removes the modification times recorded for one or more elements
+	HRESULT Forget(Guid id);
+	HRESULT Forget(IEnumerable<Guid>^ ids);
+
+	// ToDictionary
+	//
+	// Loads every recorded modification time in one operation
+	Dictionary<Guid, DateTime>^ ToDictionary(void);
+
+	// Touch
+	//
+	// Records the current time as the modification time of an element
+	HRESULT Touch(Guid id);
+
+	// TryGetTime
+	//
+	// Retrieves the recorded modification time of an element, if there is one
+	bool TryGetTime(Guid id, DateTime% time);
+
+private:
+
+	// DESTRUCTOR / FINALIZER
+	~StorageChangeTracker() { this->!StorageChangeTracker(); m_disposed = true; }
+	!StorageChangeTracker();
+
+	//-----------------------------------------------------------------------
+	// Private Constants
+
+	// TRACKER_BASEID
+	//
+	// Used as the base property ID code for sets defined by the tracker
+	literal int TRACKER_BASEID = 255;
+
+	// TRACKER_BATCHSIZE
+	//
+	// Number of properties enumerated and read at a time by ToDictionary
+	literal int TRACKER_BATCHSIZE = 64;
+
+	//-----------------------------------------------------------------------
+	// Private Member Functions
+
+	// GetPropertyStorage
+	//
+	// Instantiates and returns the contained IPropertyStorage
+	HRESULT GetPropertyStorage(IPropertyStorage** ppPropStorage);
+
+	//-----------------------------------------------------------------------
+	// Member Variables
+
+	bool						m_disposed;			// Object disposal flag
+	ComStorage^					m_storage;			// Referenced ComStorage
+	IPropertyStorage*			m_pPropStorage;		// Contained IPropertyStorage
+	initonly Object^			m_lock;				// Tracker lock
+};
+
+//---------------------------------------------------------------------------
+
+END_ROOT_NAMESPACE(zuki::storage)
+
+#pragma warning(pop)
+
+#endif	// __STORAGECHANGETRACKER_H_
@@ -52,13 +52,13 @@ StorageContainer::StorageContainer(StructuredStorage^ root, ComStorage^ parent,
 
 	if(m_root == nullptr) m_root = safe_cast<StructuredStorage^>(this);
 	
-	m_readOnly = StorageUtil::IsStorageReadOnly(m_storage);
+	m_readOnly = m_storage->ReadOnly;
 
 	// Retrieve the unique GUID that is the real name of this container
 	// and uniquely identifies it throughout the library.  The mystical 
 	// root container always gets the empty guid, though ...
 
-	m_contid = (m_parent != nullptr) ? StorageUtil::GetContainerID(m_storage) : Guid::Empty;
+	m_contid = (m_parent != nullptr) ? m_storage->ContainerID : Guid::Empty;
 
 	// Attempt to create the contained collection classes 
 
@@ -67,6 +67,58 @@ StorageContainer::StorageContainer(StructuredStorage^ root, ComStorage^ parent,
 	m_propsets = gcnew StoragePropertySetCollection(m_root, m_storage);
 }
 
+//---------------------------------------------------------------------------
+// StorageContainer::CheckConflicts (private)
+//
+// Verifies that none of the top-level containers, objects or property sets
+// in this container have the same name as one that exists in the target.
+// Used to implement StorageConflictMode::Fail before anything gets copied
+//
+// Arguments:
+//
+//	target			- Target container to check for conflicting names
+
+void StorageContainer::CheckConflicts(StorageContainer^ target)
+{
+	ComStorage^				dest = target->m_storage;	// Target ComStorage
+
+	// MapNamesToGuids() only returns the names that already exist in the
+	// target mapper, so any result at all from it is a conflict
+
+	for each(String^ name in dest->ObjectNameMapper->MapNamesToGuids(
+		m_storage->ObjectNameMapper->ToNameArray())->Keys)
+		throw gcnew ObjectExistsException(name);
+
+	for each(String^ name in dest->PropertySetNameMapper->MapNamesToGuids(
+		m_storage->PropertySetNameMapper->ToNameArray())->Keys)
+		throw gcnew PropertySetExistsException(name);
+
+	for each(String^ name in dest->ContainerNameMapper->MapNamesToGuids(
+		m_storage->ContainerNameMapper->ToNameArray())->Keys)
+		throw gcnew ContainerExistsException(name);
+}
+
+//---------------------------------------------------------------------------
+// StorageContainer::ContainsContainer (private)
+//
+// Determines if a container with the specified GUID exists anywhere in the
+// tree of sub containers underneath this container
+//
+// Arguments:
+//
+//	contid			- Container ID GUID to search for
+
+bool StorageContainer::ContainsContainer(Guid contid)
+{
+	for each(KeyValuePair<String^, Guid> item in m_storage->ContainerNameMapper->ToDictionary()) {
+
+		if(item.Value == contid) return true;
+		if(m_containers[item.Value]->ContainsContainer(contid)) return true;
+	}
+
+	return false;
+}
+
 //---------------------------------------------------------------------------
 // StorageContainer::Containers::get
 //
@@ -78,6 +130,495 @@ StorageContainerCollection^ StorageContainer::Containers::get(void)
 	return m_containers;
 }
 
+//---------------------------------------------------------------------------
+// StorageContainer::CopyInternal (private)
+//
+// Copies (or moves) the objects, property sets and sub containers of this
+// container into the target container.  Every copied item gets a brand new
+// GUID in the target so the root-wide COM caches never see duplicates, and
+// the target name mappers are updated to point the same names at them
+//
+// Arguments:
+//
+//	target			- Target container to copy everything into
+//	mode			- Name conflict resolution mode
+//	move			- Flag to remove each item from this container once copied
+
+bool StorageContainer::CopyInternal(StorageContainer^ target, StorageConflictMode mode, bool move)
+{
+	ComStorage^					dest = target->m_storage;	// Target ComStorage
+	Dictionary<String^, Guid>^	existing;			// Conflicting target names
+	List<String^>^				removed;			// Names removed during a move
+	List<Guid>^					removedIds;			// GUIDs removed during a move
+	GUIDNAME					elemname;			// Element name
+	Guid						newid;				// GUID of the copied item
+	bool						complete = true;	// Flag if nothing was skipped
+	HRESULT						hResult;			// Result from function call
+
+	// OBJECTS: The object streams are copied by the storage engine itself
+	// (see CopyObject) and are then mapped by name into the target container
+
+	Dictionary<String^, Guid>^ objects = m_storage->ObjectNameMapper->ToDictionary();
+	existing = dest->ObjectNameMapper->MapNamesToGuids(objects->Keys);
+	removed = gcnew List<String^>();
+	removedIds = gcnew List<Guid>();
+
+	try {
+
+		for each(KeyValuePair<String^, Guid> item in objects) {
+
+			if(existing->ContainsKey(item.Key)) {
+
+				if(mode == StorageConflictMode::Fail) throw gcnew ObjectExistsException(item.Key);
+				if(mode == StorageConflictMode::Skip) { complete = false; continue; }
+				target->m_objects->Remove(item.Key);
+			}
+
+			newid = Guid::NewGuid();
+			CopyObject(item.Value, dest, newid);
+			dest->ObjectNameMapper->AddMapping(item.Key, newid);
+
+			hResult = dest->ChangeTracker->Touch(newid);
+			if(FAILED(hResult)) throw gcnew StorageException(hResult, item.Key);
+
+			if(!move) continue;
+
+			StorageUtil::SysGuidToBase64(item.Value, elemname);
+			hResult = m_storage->DestroyElement(elemname);
+			if(FAILED(hResult)) throw gcnew StorageException(hResult, item.Key);
+
+			removed->Add(item.Key);
+			removedIds->Add(item.Value);
+		}
+	}
+
+	// The mappings and modification times of anything that was already moved
+	// have to be removed no matter what, but a failure doing that mustn't hide
+	// the original exception
+
+	catch(Exception^) {
+
+		try {
+
+			m_storage->ObjectNameMapper->RemoveMappings(removed);
+			if(removedIds->Count > 0) m_storage->ChangeTracker->Forget(removedIds);
+		}
+
+		catch(Exception^) { /* DO NOTHING */ }
+
+		throw;
+	}
+
+	m_storage->ObjectNameMapper->RemoveMappings(removed);
+
+	if(removedIds->Count > 0) {
+
+		hResult = m_storage->ChangeTracker->Forget(removedIds);
+		if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	}
+
+	// PROPERTY SETS: The FMTID of a property set is also it's identity in the
+	// cache, so these have to be recreated in the target and copied by value
+
+	Dictionary<String^, Guid>^ propsets = m_storage->PropertySetNameMapper->ToDictionary();
+	existing = dest->PropertySetNameMapper->MapNamesToGuids(propsets->Keys);
+	removed = gcnew List<String^>();
+
+	try {
+
+		for each(KeyValuePair<String^, Guid> item in propsets) {
+
+			if(existing->ContainsKey(item.Key)) {
+
+				if(mode == StorageConflictMode::Fail) throw gcnew PropertySetExistsException(item.Key);
+				if(mode == StorageConflictMode::Skip) { complete = false; continue; }
+				target->m_propsets->Remove(item.Key);
+			}
+
+			m_propsets[item.Value]->CopyPropertiesTo(target->m_propsets->Add(item.Key));
+
+			if(!move) continue;
+
+			hResult = m_storage->DeletePropertySet(StorageUtil::SysGuidToUUID(item.Value));
+			if(FAILED(hResult)) throw gcnew StorageException(hResult, item.Key);
+
+			removed->Add(item.Key);
+
+			// The property set is deleted directly rather than through the
+			// collection, so the property value index has to be told here
+
+			if(m_root->PropertyIndex->Contains(item.Key))
+				m_root->PropertyIndex->UpdateAll(item.Key, StoragePropertyIndex::GetPath(m_storage), nullptr);
+		}
+	}
+
+	catch(Exception^) {
+
+		try { m_storage->PropertySetNameMapper->RemoveMappings(removed); }
+		catch(Exception^) { /* DO NOTHING */ }
+
+		throw;
+	}
+
+	m_storage->PropertySetNameMapper->RemoveMappings(removed);
+
+	// CONTAINERS: Each sub container is recreated in the target and then
+	// recursively copied.  A moved sub container is only destroyed if all
+	// of it's contents actually made it over to the target
+
+	Dictionary<String^, Guid>^ containers = m_storage->ContainerNameMapper->ToDictionary();
+	existing = dest->ContainerNameMapper->MapNamesToGuids(containers->Keys);
+	removed = gcnew List<String^>();
+	removedIds = gcnew List<Guid>();
+
+	try {
+
+		for each(KeyValuePair<String^, Guid> item in containers) {
+
+			if(existing->ContainsKey(item.Key)) {
+
+				if(mode == StorageConflictMode::Fail) throw gcnew ContainerExistsException(item.Key);
+				if(mode == StorageConflictMode::Skip) { complete = false; continue; }
+				target->m_containers->Remove(item.Key);
+			}
+
+			if(!m_containers[item.Value]->CopyInternal(target->m_containers->Add(item.Key), mode, move)) {
+				
+				complete = false;
+				continue;
+			}
+
+			if(!move) continue;
+
+			StorageUtil::SysGuidToBase64(item.Value, elemname);
+			hResult = m_storage->DestroyElement(elemname);
+			if(FAILED(hResult)) throw gcnew StorageException(hResult, item.Key);
+
+			removed->Add(item.Key);
+			removedIds->Add(item.Value);
+		}
+	}
+
+	catch(Exception^) {
+
+		try {
+
+			m_storage->ContainerNameMapper->RemoveMappings(removed);
+			if(removedIds->Count > 0) m_storage->ChangeTracker->Forget(removedIds);
+		}
+
+		catch(Exception^) { /* DO NOTHING */ }
+
+		if(removed->Count > 0) m_root->InvalidatePaths();
+		throw;
+	}
+
+	m_storage->ContainerNameMapper->RemoveMappings(removed);
+	if(removed->Count > 0) m_root->InvalidatePaths();
+
+	if(removedIds->Count > 0) {
+
+		hResult = m_storage->ChangeTracker->Forget(removedIds);
+		if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	}
+
+	return complete;
+}
+
+//---------------------------------------------------------------------------
+// StorageContainer::CopyObject (private)
+//
+// Copies a single object stream from this container into another container
+// under a new GUID.  Nothing gets copied through managed buffers
+//
+// Arguments:
+//
+//	objid			- Object ID GUID of the source object stream
+//	dest			- Target ComStorage to copy the object stream into
+//	newid			- Object ID GUID to assign to the copy
+
+void StorageContainer::CopyObject(Guid objid, ComStorage^ dest, Guid newid)
+{
+	GUIDNAME				elemname;			// Source object name
+	GUIDNAME				newname;			// Target object name
+	ComStream^				stream;				// Cached source ComStream
+	ComStream^				clone;				// Clone of the cached stream
+	IStream*				pStream;			// Target IStream interface
+	ULARGE_INTEGER			cb;					// Number of bytes to copy
+	HRESULT					hResult;			// Result from function call
+
+	StorageUtil::SysGuidToBase64(objid, elemname);
+	StorageUtil::SysGuidToBase64(newid, newname);
+
+	lock cacheLock(m_root->ComStreamCache->SyncRoot);		// <--- THREAD SAFETY
+
+	// If the object stream isn't open anywhere, just let the storage engine
+	// copy the whole thing into the target with a single call
+
+	if(!m_root->ComStreamCache->TryGetValue(objid, stream)) {
+
+		hResult = m_storage->MoveElementTo(elemname, dest, const_cast<LPWSTR>(newname), STGMOVE_COPY);
+		if(FAILED(hResult)) throw gcnew StorageException(hResult);
+		return;
+	}
+
+	// The stream is open (exclusively), so it can't be copied by name.  Use
+	// a clone of it instead, which leaves the original seek pointer alone
+
+	hResult = stream->CreateClone(clone);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	try {
+
+		hResult = dest->CreateStream(newname, dest->ChildMode, 0, 0, &pStream);
+		if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+		cb.QuadPart = MAXULONGLONG;
+		hResult = clone->CopyTo(pStream, cb, NULL, NULL);
+		pStream->Release();
+
+		// Don't leave a partial copy of the stream lying around in the target
+
+		if(FAILED(hResult)) { dest->DestroyElement(newname); throw gcnew StorageException(hResult); }
+	}
+
+	finally { delete clone; }
+}
+
+//---------------------------------------------------------------------------
+// StorageContainer::CopyTo
+//
+// Copies the entire contents of this container into another container,
+// which can be part of a different StructuredStorage
+//
+// Arguments:
+//
+//	target			- Target container to copy everything into
+//	mode			- Name conflict resolution mode
+
+void StorageContainer::CopyTo(StorageContainer^ target, StorageConflictMode mode)
+{
+	CHECK_DISPOSED(m_storage->IsDisposed());
+
+	ValidateTarget(target);
+	if(mode == StorageConflictMode::Fail) CheckConflicts(target);
+
+	CopyInternal(target, mode, false);
+}
+
+//---------------------------------------------------------------------------
+// StorageContainer::ExportChanges (internal)
+//
+// Exports the changes made to this container since the specified time into
+// the target container, which is normally the root of a new file.  Every
+// sub container and property set is exported, so that the import side can
+// tell what's been removed, but only the objects that were modified since
+// the specified time are copied.  The rest are just listed by name
+//
+// Arguments:
+//
+//	target			- Target container to export the changes into
+//	since			- Point in time (UTC) to export the changes after
+//	all				- Flag to export every object regardless of time
+
+void StorageContainer::ExportChanges(StorageContainer^ target, DateTime since, bool all)
+{
+	ComStorage^					dest = target->m_storage;	// Target ComStorage
+	Dictionary<Guid, DateTime>^	times;				// Recorded modification times
+	StorageNameMapper^			unchanged;			// Unchanged object names
+	DateTime					modified;			// Modification time of an item
+	Guid						newid;				// GUID of the copied item
+
+	times = m_storage->ChangeTracker->ToDictionary();
+
+	// OBJECTS: Modified objects are copied by the storage engine, the same
+	// way as CopyTo(), and the others go into the unchanged objects list
+
+	unchanged = gcnew StorageNameMapper(FMTID_UnchangedObjects, dest);
+
+	try {
+
+		for each(KeyValuePair<String^, Guid> item in m_storage->ObjectNameMapper->ToDictionary()) {
+
+			if(all || !times->TryGetValue(item.Value, modified) || (modified >= since)) {
+
+				newid = Guid::NewGuid();
+				CopyObject(item.Value, dest, newid);
+				dest->ObjectNameMapper->AddMapping(item.Key, newid);
+			}
+
+			else unchanged->AddMapping(item.Key, item.Value);
+		}
+	}
+
+	finally { delete unchanged; }
+
+	// PROPERTY SETS: There's no way to tell if these have changed, but they
+	// are usually small enough that it doesn't matter
+
+	for each(KeyValuePair<String^, Guid> item in m_storage->PropertySetNameMapper->ToDictionary())
+		m_propsets[item.Value]->CopyPropertiesTo(target->m_propsets->Add(item.Key));
+
+	// CONTAINERS: A sub container that was created or renamed since the
+	// specified time has to be exported in it's entirety
+
+	for each(KeyValuePair<String^, Guid> item in m_storage->ContainerNameMapper->ToDictionary()) {
+
+		m_containers[item.Value]->ExportChanges(target->m_containers->Add(item.Key), since,
+			all || !times->TryGetValue(item.Value, modified) || (modified >= since));
+	}
+}
+
+//---------------------------------------------------------------------------
+// StorageContainer::FindContainer (internal)
+//
+// Locates a sub container from a path of container GUIDs relative to this
+// container, as generated by StoragePropertyIndex::GetPath.  Returns NULLPTR
+// if any container along the path no longer exists
+//
+// Arguments:
+//
+//	path		- Slash-delimited path of container GUIDs
+
+StorageContainer^ StorageContainer::FindContainer(String^ path)
+{
+	StorageContainer^		current = this;		// Current container
+	Guid					contid;				// Container GUID
+
+	CHECK_DISPOSED(m_storage->IsDisposed());
+	if(path == nullptr) throw gcnew ArgumentNullException();
+
+	if(path->Length == 0) return this;			// Path to this container
+
+	for each(String^ segment in path->Split(L'/')) {
+
+		if(!Guid::TryParseExact(segment, "N", contid)) return nullptr;
+		if(!current->m_storage->ContainerNameMapper->ContainsGuid(contid)) return nullptr;
+
+		current = current->m_containers[contid];
+	}
+
+	return current;
+}
+
+//---------------------------------------------------------------------------
+// StorageContainer::ImportChanges (internal)
+//
+// Applies a set of changes exported by ExportChanges to this container, which
+// has to be the same container (or a copy of it) that the changes were made
+// against.  Anything that doesn't appear in the source has been removed
+//
+// Arguments:
+//
+//	source			- Source container with the exported changes
+
+void StorageContainer::ImportChanges(StorageContainer^ source)
+{
+	ComStorage^					src = source->m_storage;	// Source ComStorage
+	StorageNameMapper^			mapper;				// Unchanged objects mapper
+	Dictionary<String^, Guid>^	unchanged;			// Unchanged object names
+	List<String^>^				removed;			// Names to be removed
+	Guid						id;					// GUID of an item
+	HRESULT						hResult;			// Result from function call
+
+	// OBJECTS: Every object that was left out of the export must already be
+	// here, otherwise the changes weren't exported from this container
+
+	mapper = gcnew StorageNameMapper(FMTID_UnchangedObjects, src);
+	try { unchanged = mapper->ToDictionary(); }
+	finally { delete mapper; }
+
+	for each(String^ name in unchanged->Keys)
+		if(!m_storage->ObjectNameMapper->ContainsName(name)) throw gcnew ObjectNotFoundException(name);
+
+	Dictionary<String^, Guid>^ objects = src->ObjectNameMapper->ToDictionary();
+	removed = gcnew List<String^>();
+
+	for each(String^ name in m_storage->ObjectNameMapper->ToNameArray())
+		if(!objects->ContainsKey(name) && !unchanged->ContainsKey(name)) removed->Add(name);
+
+	m_objects->RemoveRange(removed);
+
+	for each(KeyValuePair<String^, Guid> item in objects) {
+
+		m_objects->Remove(item.Key);
+
+		id = Guid::NewGuid();
+		source->CopyObject(item.Value, m_storage, id);
+		m_storage->ObjectNameMapper->AddMapping(item.Key, id);
+
+		hResult = m_storage->ChangeTracker->Touch(id);
+		if(FAILED(hResult)) throw gcnew StorageException(hResult, item.Key);
+	}
+
+	// PROPERTY SETS: All of these are exported, so just replace them
+
+	m_propsets->Clear();
+
+	for each(KeyValuePair<String^, Guid> item in src->PropertySetNameMapper->ToDictionary())
+		source->m_propsets[item.Value]->CopyPropertiesTo(m_propsets->Add(item.Key));
+
+	// CONTAINERS: Remove the ones that aren't in the source any more, and
+	// create any that don't exist here yet before importing into them
+
+	Dictionary<String^, Guid>^ containers = src->ContainerNameMapper->ToDictionary();
+	removed = gcnew List<String^>();
+
+	for each(String^ name in m_storage->ContainerNameMapper->ToNameArray())
+		if(!containers->ContainsKey(name)) removed->Add(name);
+
+	for each(String^ name in removed) m_containers->Remove(name);
+
+	for each(KeyValuePair<String^, Guid> item in containers) {
+
+		StorageContainer^ container = (m_storage->ContainerNameMapper->TryMapNameToGuid(item.Key, id)) ?
+			m_containers[id] : m_containers->Add(item.Key);
+
+		container->ImportChanges(source->m_containers[item.Value]);
+	}
+}
+
+//---------------------------------------------------------------------------
+// StorageContainer::LastModified::get
+//
+// Gets the last time (UTC) the container was created or renamed, or null
+// if that isn't known.  The root container never has a modification time
+
+Nullable<DateTime> StorageContainer::LastModified::get(void)
+{
+	DateTime				time;				// Recorded modification time
+
+	CHECK_DISPOSED(m_storage->IsDisposed());
+
+	if((m_parent != nullptr) && (m_parent->ChangeTracker->TryGetTime(m_contid, time))) 
+		return Nullable<DateTime>(time);
+
+	return Nullable<DateTime>();
+}
+
+//---------------------------------------------------------------------------
+// StorageContainer::MoveTo
+//
+// Moves the entire contents of this container into another container, 
+// which can be part of a different StructuredStorage.  Anything that was
+// skipped due to a name conflict is left behind in this container
+//
+// Arguments:
+//
+//	target			- Target container to move everything into
+//	mode			- Name conflict resolution mode
+
+void StorageContainer::MoveTo(StorageContainer^ target, StorageConflictMode mode)
+{
+	CHECK_DISPOSED(m_storage->IsDisposed());
+	if(m_readOnly) throw gcnew ContainerReadOnlyException();
+
+	ValidateTarget(target);
+	if(mode == StorageConflictMode::Fail) CheckConflicts(target);
+
+	CopyInternal(target, mode, true);
+}
+
 //---------------------------------------------------------------------------
 // StorageContainer::Name::get
 //
@@ -100,6 +641,8 @@ String^ StorageContainer::Name::get(void)
 
 void StorageContainer::Name::set(String^ value)
 {
+	HRESULT					hResult;			// Result from function call
+
 	CHECK_DISPOSED(m_storage->IsDisposed());
 
 	// The root storage container cannot be renamed under any circumstances,
@@ -110,6 +653,13 @@ void StorageContainer::Name::set(String^ value)
 	if(m_readOnly) throw gcnew ContainerReadOnlyException();
 
 	m_parent->ContainerNameMapper->RenameMapping(m_contid, value);
+	m_root->InvalidatePaths();
+
+	// The import side of an exported delta works by name, so a renamed
+	// container has to be exported in it's entirety the next time around
+
+	hResult = m_parent->ChangeTracker->Touch(m_contid);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
 }
 
 //---------------------------------------------------------------------------
@@ -134,6 +684,32 @@ StoragePropertySetCollection^ StorageContainer::PropertySets::get(void)
 	return m_propsets;
 }
 
+//---------------------------------------------------------------------------
+// StorageContainer::ValidateTarget (private)
+//
+// Verifies that the contents of this container can be copied into the
+// specified target container
+//
+// Arguments:
+//
+//	target			- Target container to be validated
+
+void StorageContainer::ValidateTarget(StorageContainer^ target)
+{
+	if(target == nullptr) throw gcnew ArgumentNullException();
+
+	CHECK_DISPOSED(target->m_storage->IsDisposed());
+	if(target->m_readOnly) throw gcnew ContainerReadOnlyException();
+
+	// Within the same storage, a container can't be copied into itself or into
+	// any of it's own sub containers since the copy would never finish
+
+	if(target->m_root != m_root) return;
+
+	if(target->m_contid == m_contid) throw gcnew InvalidOperationException();
+	if(ContainsContainer(target->m_contid)) throw gcnew InvalidOperationException();
+}
+
 //---------------------------------------------------------------------------
 
 END_ROOT_NAMESPACE(zuki::storage)
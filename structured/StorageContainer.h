@@ -25,6 +25,7 @@
 #pragma once
 
 #include "ComStorage.h"						// Include ComStorage declarations
+#include "StorageConflictMode.h"			// Include StorageConflictMode decls
 #include "StorageContainerCollection.h"		// Include StorageContainerCollection decls
 #include "StorageException.h"				// Include StorageException declarations
 #include "StorageExceptions.h"				// Include exception declarations
@@ -56,9 +57,22 @@ STRUCTURED_STORAGE_PUBLIC ref class StorageContainer
 {
 public:
 
+	//-----------------------------------------------------------------------
+	// Member Functions
+
+	void CopyTo(StorageContainer^ target) { CopyTo(target, StorageConflictMode::Fail); }
+	void CopyTo(StorageContainer^ target, StorageConflictMode mode);
+	void MoveTo(StorageContainer^ target) { MoveTo(target, StorageConflictMode::Fail); }
+	void MoveTo(StorageContainer^ target, StorageConflictMode mode);
+
 	//-----------------------------------------------------------------------
 	// Properties
 
+	property Nullable<DateTime> LastModified
+	{
+		Nullable<DateTime> get(void);
+	}
+
 	property String^ Name
 	{
 		String^ get(void);
@@ -76,6 +90,24 @@ internal:
 	// INTERNAL CONSTRUCTOR
 	StorageContainer(StructuredStorage^ root, ComStorage^ parent, ComStorage^ storage);
 
+	//-----------------------------------------------------------------------
+	// Internal Member Functions
+
+	// ExportChanges
+	//
+	// Exports everything modified since the specified time into target
+	void ExportChanges(StorageContainer^ target, DateTime since, bool all);
+
+	// FindContainer
+	//
+	// Locates a container from a path generated by StoragePropertyIndex
+	StorageContainer^ FindContainer(String^ path);
+
+	// ImportChanges
+	//
+	// Applies a set of changes exported by ExportChanges to this container
+	void ImportChanges(StorageContainer^ source);
+
 	//-----------------------------------------------------------------------
 	// Internal Properties
 
@@ -102,6 +134,34 @@ private:
 
 	literal String^ CONTAINER_NAME_ROOT = gcnew String("StorageRoot");
 
+	//-----------------------------------------------------------------------
+	// Private Member Functions
+
+	// CheckConflicts
+	//
+	// Throws if any top-level name in this container also exists in the target
+	void CheckConflicts(StorageContainer^ target);
+
+	// ContainsContainer
+	//
+	// Determines if a container GUID exists anywhere underneath this container
+	bool ContainsContainer(Guid contid);
+
+	// CopyInternal
+	//
+	// Implementation of CopyTo and MoveTo
+	bool CopyInternal(StorageContainer^ target, StorageConflictMode mode, bool move);
+
+	// CopyObject
+	//
+	// Copies a single object stream into another container under a new GUID
+	void CopyObject(Guid objid, ComStorage^ dest, Guid newid);
+
+	// ValidateTarget
+	//
+	// Verifies that the contents of this container can be copied into target
+	void ValidateTarget(StorageContainer^ target);
+
 	//-----------------------------------------------------------------------
 	// Member Variables
 
@@ -43,7 +43,7 @@ StorageContainerCollection::StorageContainerCollection(StructuredStorage^ root,
 	if(m_root == nullptr) throw gcnew ArgumentNullException();	
 	if(m_storage == nullptr) throw gcnew ArgumentNullException();
 
-	m_readOnly = StorageUtil::IsStorageReadOnly(m_storage);
+	m_readOnly = m_storage->ReadOnly;
 }
 
 //---------------------------------------------------------------------------
@@ -58,8 +58,7 @@ StorageContainerCollection::StorageContainerCollection(StructuredStorage^ root,
 StorageContainer^ StorageContainerCollection::Add(String^ name)
 {
 	Guid					contid;				// Container ID guid
-	String^					contname;			// Container BASE64 name
-	PinnedStringPtr			pinName;			// Pinned container name
+	GUIDNAME				contname;			// Container BASE64 name
 	ComStorage^				subContainer;		// New subcontainer reference
 	IStorage*				pSubContainer;		// New subcontainer IStorage
 	HRESULT					hResult;			// Result from function call
@@ -73,29 +72,33 @@ StorageContainer^ StorageContainerCollection::Add(String^ name)
 	if(m_storage->ContainerNameMapper->ContainsName(name)) throw gcnew ContainerExistsException(name);
 
 	contid = Guid::NewGuid();							// Generate a new container GUID
-	contname = StorageUtil::SysGuidToBase64(contid);	// Convert into BASE64
-	pinName = PtrToStringChars(contname);				// Pin it down in memory
+	StorageUtil::SysGuidToBase64(contid, contname);	// Convert into BASE64
 
 	// Attempt to physically create the new container, and if successful
 	// add it's name and GUID to the name mapper as well
 
-	hResult = m_storage->CreateStorage(pinName, StorageUtil::GetStorageMode(m_storage), 
+	hResult = m_storage->CreateStorage(contname, m_storage->ChildMode, 
 		0, 0, &pSubContainer);
 	if(FAILED(hResult)) throw gcnew StorageException(hResult, name);
 
 	// Create the IStorage wrapper and release the raw pointer.  If something
 	// goes wrong from here, it will release itself automatically on finalization
 
-	subContainer = gcnew ComStorage(pSubContainer);
+	subContainer = gcnew ComStorage(pSubContainer, m_storage, m_storage->Statistics);
 	pSubContainer->Release();
 
 	// Attempt to add the new pointer wrapper into the cache, and be sure to delete
 	// the newly created sub container on exception since it will be orphaned
 
 	try { m_root->ComStorageCache->Add(contid, subContainer); }
-	catch(Exception^) { m_storage->DestroyElement(pinName); throw; }
+	catch(Exception^) { m_storage->DestroyElement(contname); throw; }
 
 	m_storage->ContainerNameMapper->AddMapping(name, contid);
+
+	// A new container without a modification time just looks modified, so
+	// there's no need to fail the whole operation if it can't be recorded
+
+	m_storage->ChangeTracker->Touch(contid);
 	return gcnew StorageContainer(m_root, m_storage, subContainer);
 }
 
@@ -110,33 +113,14 @@ StorageContainer^ StorageContainerCollection::Add(String^ name)
 
 void StorageContainerCollection::Clear(void)
 {
-	PinnedStringPtr			pinContName;	// Pinned container name
-	HRESULT					hResult;		// Result from function call
-
 	CHECK_DISPOSED(m_storage->IsDisposed());
 	if(m_readOnly) throw gcnew ContainerReadOnlyException();
 
-	// The NameMapper has a handy ToList() function that essentially enumerates
-	// all of the objects we placed into this container, so that should suffice.
-	// Without it, we would still have to ask it to look up GUIDs which ends
-	// up doing all kinds of enumerations anyway.  This is just better overall.
-
-	for each(KeyValuePair<String^, Guid> item in m_storage->ContainerNameMapper->ToDictionary()) {
-
-		// The physical IStorage is the GUID base64 encoded. The "name" from
-		// the name mapper has no bearing on this operation whatsoever
-
-		pinContName = PtrToStringChars(StorageUtil::SysGuidToBase64(item.Value));
-		
-		// First try to physically remove the container from storage
+	// The NameMapper has a handy ToDictionary() function that enumerates all
+	// of the containers we placed into this container in a single pass, which
+	// is all that RemoveContainers() needs to do the rest in bulk
 
-		hResult = m_storage->DestroyElement(pinContName);
-		if(FAILED(hResult)) throw gcnew StorageException(hResult);
-
-		// Remove the mapping from the container's property set mapper
-
-		m_storage->ContainerNameMapper->RemoveMapping(item.Value);
-	}
+	RemoveContainers(m_storage->ContainerNameMapper->ToDictionary());
 }
 
 //---------------------------------------------------------------------------
@@ -269,16 +253,14 @@ StorageContainer^ StorageContainerCollection::default::get(int index)
 
 StorageContainer^ StorageContainerCollection::default::get(Guid contid)
 {
-	String^					contname;			// Container BASE64 name
-	PinnedStringPtr			pinName;			// Pinned container name
+	GUIDNAME				contname;			// Container BASE64 name
 	ComStorage^				subContainer;		// Sub container reference
 	IStorage*				pSubContainer;		// Sub container IStorage
 	HRESULT					hResult;			// Result from function call
 
 	CHECK_DISPOSED(m_storage->IsDisposed());
 
-	contname = StorageUtil::SysGuidToBase64(contid);		// Convert into BASE64
-	pinName = PtrToStringChars(contname);					// Pin it down in memory
+	StorageUtil::SysGuidToBase64(contid, contname);		// Convert into BASE64
 
 	lock cacheLock(m_root->ComStorageCache->SyncRoot);		// <--- THREAD SAFETY
 
@@ -290,14 +272,14 @@ StorageContainer^ StorageContainerCollection::default::get(Guid contid)
 
 	// This container hasn't been cached, so we need to actually open it up.
 
-	hResult = m_storage->OpenStorage(pinName, NULL, StorageUtil::GetStorageChildOpenMode(m_storage), 
+	hResult = m_storage->OpenStorage(contname, NULL, m_storage->ChildMode, 
 		NULL, 0, &pSubContainer);
 	if(FAILED(hResult)) throw gcnew StorageException(hResult);
 
 	// Wrap the new IStorage pointer up, and release our local reference
 	// to it.  The ComStorage instance maintains it from here on
 
-	subContainer = gcnew ComStorage(pSubContainer);
+	subContainer = gcnew ComStorage(pSubContainer, m_storage, m_storage->Statistics);
 	pSubContainer->Release();
 
 	// Insert the new pointer wrapper into cache (hence the lock), and
@@ -307,6 +289,37 @@ StorageContainer^ StorageContainerCollection::default::get(Guid contid)
 	return gcnew StorageContainer(m_root, m_storage, subContainer);
 }
 
+//---------------------------------------------------------------------------
+// StorageContainerCollection::GetChangedSince
+//
+// Gets all of the sub containers in this container that have been created
+// or renamed since the specified time.  This doesn't look at the contents of
+// the sub containers; see StorageObjectCollection::GetChangedSince for that.
+// A time with an Unspecified kind is taken to be local time, the same way
+// DateTime::ToUniversalTime() treats it, so pass UTC when that's not right
+//
+// Arguments:
+//
+//	since		- Point in time to look for changes after
+
+List<StorageContainer^>^ StorageContainerCollection::GetChangedSince(DateTime since)
+{
+	Dictionary<Guid, DateTime>^	times;			// Recorded modification times
+	DateTime					modified;		// Modification time of a container
+	List<StorageContainer^>^	changed;		// Modified containers
+
+	CHECK_DISPOSED(m_storage->IsDisposed());
+
+	since = since.ToUniversalTime();
+	times = m_storage->ChangeTracker->ToDictionary();
+	changed = gcnew List<StorageContainer^>();
+
+	for each(Guid contid in m_storage->ContainerNameMapper->ToGuidArray())
+		if(!times->TryGetValue(contid, modified) || (modified >= since)) changed->Add(this[contid]);
+
+	return changed;
+}
+
 //---------------------------------------------------------------------------
 // StorageContainerCollection::GetEnumerator
 //
@@ -360,7 +373,7 @@ String^ StorageContainerCollection::LookupIndex(int index)
 				// Convert the BASE64 string back into a GUID, and if we
 				// end up with Guid::Empty (error), skip this item
 
-				contid = StorageUtil::Base64ToSysGuid(gcnew String(statstg.pwcsName));
+				contid = StorageUtil::Base64ToSysGuid(statstg.pwcsName);
 				if(contid == Guid::Empty) continue;
 
 				// Attempt to look up the name for this container, and if it
@@ -396,8 +409,7 @@ String^ StorageContainerCollection::LookupIndex(int index)
 bool StorageContainerCollection::Remove(String^ name)
 {
 	Guid					contid;			// Container ID guid
-	String^					contname;		// Container BASE64 name
-	PinnedStringPtr			pinName;		// Pinned container name
+	GUIDNAME				contname;		// Container BASE64 name
 	HRESULT					hResult;		// Result from function call
 
 	CHECK_DISPOSED(m_storage->IsDisposed());
@@ -409,16 +421,20 @@ bool StorageContainerCollection::Remove(String^ name)
 
 	if(!m_storage->ContainerNameMapper->TryMapNameToGuid(name, contid)) return false;
 
-	contname = StorageUtil::SysGuidToBase64(contid);	// Convert into BASE64
-	pinName = PtrToStringChars(contname);				// Pin it down in memory
+	StorageUtil::SysGuidToBase64(contid, contname);	// Convert into BASE64
 
 	// Attempt to physically delete the container from this container,
 	// and if successful remove it from cache and the name mapper
 
-	hResult = m_storage->DestroyElement(pinName);
+	hResult = m_storage->DestroyElement(contname);
 	if(FAILED(hResult)) throw gcnew StorageException(hResult, name);
 
 	m_storage->ContainerNameMapper->RemoveMapping(name);		// Remove mapping
+	m_root->InvalidatePaths();									// Forget paths
+
+	hResult = m_storage->ChangeTracker->Forget(contid);			// Forget mod time
+	if(FAILED(hResult)) throw gcnew StorageException(hResult, name);
+
 	return true;											// Success
 }
 
@@ -439,6 +455,70 @@ bool StorageContainerCollection::Remove(StorageContainer^ item)
 	return Remove(item->Name);
 }
 
+//---------------------------------------------------------------------------
+// StorageContainerCollection::RemoveContainers (private)
+//
+// Physically deletes a set of sub containers and then removes all of their
+// mappings from the name mapper with a single operation
+//
+// Arguments:
+//
+//	containers	- NAME->GUID dictionary of the containers to be deleted
+
+int StorageContainerCollection::RemoveContainers(Dictionary<String^, Guid>^ containers)
+{
+	List<String^>^			removed;			// Successfully removed names
+	List<Guid>^				removedIds;			// Successfully removed GUIDs
+	GUIDNAME				contname;			// Container name
+	HRESULT					hResult;			// Result from function call
+
+	removed = gcnew List<String^>(containers->Count);
+	removedIds = gcnew List<Guid>(containers->Count);
+
+	try {
+
+		for each(KeyValuePair<String^, Guid> item in containers) {
+
+			// The physical IStorage is the GUID base64 encoded. The "name" from
+			// the name mapper has no bearing on this operation whatsoever
+
+			StorageUtil::SysGuidToBase64(item.Value, contname);
+
+			hResult = m_storage->DestroyElement(contname);
+			if(FAILED(hResult)) throw gcnew StorageException(hResult, item.Key);
+
+			removed->Add(item.Key);
+			removedIds->Add(item.Value);
+		}
+	}
+
+	// Whatever happens, the mappings for any containers that were actually
+	// destroyed need to be removed so they don't end up orphaned in the mapper,
+	// but a failure doing that can't be allowed to hide the original exception
+
+	catch(Exception^) {
+
+		try {
+
+			m_storage->ContainerNameMapper->RemoveMappings(removed);
+			m_storage->ChangeTracker->Forget(removedIds);
+		}
+
+		catch(Exception^) { /* DO NOTHING */ }
+
+		m_root->InvalidatePaths();
+		throw;
+	}
+
+	m_storage->ContainerNameMapper->RemoveMappings(removed);
+	m_root->InvalidatePaths();
+
+	hResult = m_storage->ChangeTracker->Forget(removedIds);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	return removed->Count;
+}
+
 //---------------------------------------------------------------------------
 // StorageContainerCollection::ToDictionary (internal)
 //
@@ -76,6 +76,11 @@ public:
 	virtual property int  Count { int get(void); }
 	virtual property bool IsReadOnly { bool get(void) { return m_readOnly; } }
 
+	//-----------------------------------------------------------------------
+	// Member Functions
+
+	List<StorageContainer^>^ GetChangedSince(DateTime since);
+
 	//-----------------------------------------------------------------------
 	// Properties
 
@@ -112,6 +117,7 @@ private:
 	// Private Member Functions
 
 	String^	LookupIndex(int index);
+	int		RemoveContainers(Dictionary<String^, Guid>^ containers);
 
 	// ICollection<T>::Add
 	virtual void Add(StorageContainer^) sealed =
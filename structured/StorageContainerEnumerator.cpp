@@ -40,8 +40,6 @@ BEGIN_ROOT_NAMESPACE(zuki::storage)
 StorageContainerEnumerator::StorageContainerEnumerator(StructuredStorage^ root, 
 	ComStorage^ storage) : m_root(root), m_storage(storage), m_current(-1)
 {
-	Generic::ICollection<Guid>^		guids;		// Enumerated storage GUIDs
-
 	if(m_root == nullptr) throw gcnew ArgumentNullException();
 	if(m_storage == nullptr) throw gcnew ArgumentNullException();
 
@@ -50,9 +48,7 @@ StorageContainerEnumerator::StorageContainerEnumerator(StructuredStorage^ root,
 	// the name mapper to see if that thing is valid.  NOW it just asks the name mapper
 	// for everything it knows about, saving both execution time and resources
 
-	guids = m_storage->ContainerNameMapper->ToDictionary()->Values;
-	m_items = gcnew array<Guid>(guids->Count);
-	if(m_items->Length > 0) guids->CopyTo(m_items, 0);
+	m_items = m_storage->ContainerNameMapper->ToGuidArray();
 }
 
 //---------------------------------------------------------------------------
@@ -71,8 +67,7 @@ StorageContainer^ StorageContainerEnumerator::Current::get(void)
 	Guid					contid;				// Container ID code
 	ComStorage^				subStorage;			// Child container instance
 	IStorage*				pSubStorage;		// Child container pointer
-	String^					name;				// BASE64 container name
-	PinnedStringPtr			pinName;			// Pinned container name
+	GUIDNAME				name;				// BASE64 container name
 	HRESULT					hResult;			// Result from function call
 
 	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
@@ -93,19 +88,18 @@ StorageContainer^ StorageContainerEnumerator::Current::get(void)
 
 	// The container hasn't been cached (or is dead), so we need to make a new one
 
-	name = StorageUtil::SysGuidToBase64(contid);	// Convert GUID to BASE64
-	pinName = PtrToStringChars(name);				// Pin it down
+	StorageUtil::SysGuidToBase64(contid, name);	// Convert GUID to BASE64
 
 	// Attempt to open up the sub container's IStorage interface 
 
-	hResult = m_storage->OpenStorage(pinName, NULL, 
-		StorageUtil::GetStorageChildOpenMode(m_storage), NULL, 0, &pSubStorage);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult, name);
+	hResult = m_storage->OpenStorage(name, NULL, 
+		m_storage->ChildMode, NULL, 0, &pSubStorage);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult, gcnew String(name));
 
 	// Create a new ComStorage wrapper for the container, and cache it off
 	// in case anyone else tries to access it later on ...
 
-	subStorage = gcnew ComStorage(pSubStorage);
+	subStorage = gcnew ComStorage(pSubStorage, m_storage, m_storage->Statistics);
 	pSubStorage->Release();
 
 	m_root->ComStorageCache->Add(contid, subStorage);
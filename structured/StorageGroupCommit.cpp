@@ -0,0 +1,146 @@
+//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+#include "stdafx.h"						// Include project pre-compiled headers
+#include "StorageGroupCommit.h"			// Include StorageGroupCommit declarations
+
+#pragma warning(push, 4)				// Enable maximum compiler warnings
+
+BEGIN_ROOT_NAMESPACE(zuki::storage)
+
+//---------------------------------------------------------------------------
+// StorageGroupCommit Constructor
+//
+// Arguments:
+//
+//	commit			- Operation that commits the storage; throws on failure
+//	interval		- Time that each batch is held open for
+
+StorageGroupCommit::StorageGroupCommit(Action^ commit, TimeSpan interval) : 
+	m_commit(commit), m_interval(interval)
+{
+	if(m_commit == nullptr) throw gcnew ArgumentNullException();
+	if(m_interval < TimeSpan::Zero) throw gcnew ArgumentOutOfRangeException("interval");
+
+	m_lock = gcnew Object();
+
+	m_thread = gcnew Thread(gcnew ThreadStart(this, &StorageGroupCommit::CommitThread));
+	m_thread->IsBackground = true;
+	m_thread->Name = "StorageGroupCommit";
+	m_thread->Start();
+}
+
+//---------------------------------------------------------------------------
+// StorageGroupCommit Destructor
+//
+// Stops the commit thread.  A batch that is still open gets committed first,
+// so nobody is left waiting on a Task that will never complete
+
+StorageGroupCommit::~StorageGroupCommit()
+{
+	if(m_disposed) return;
+
+	{
+		lock cs(m_lock);
+		m_stopping = true;
+		Monitor::PulseAll(m_lock);
+	}
+
+	m_thread->Join();
+	m_disposed = true;
+}
+
+//---------------------------------------------------------------------------
+// StorageGroupCommit::CommitThread (private)
+//
+// Waits for a batch to be opened, holds it open for the interval and then
+// commits it on behalf of every request that joined it
+//
+// Arguments:
+//
+//	NONE
+
+void StorageGroupCommit::CommitThread(void)
+{
+	TaskCompletionSource<bool>^		batch;		// Batch being committed
+	DateTime						deadline;	// When the batch closes
+	TimeSpan						remaining;	// Time left until deadline
+
+	while(true) {
+
+		{
+			lock cs(m_lock);
+
+			while((m_pending == nullptr) && (!m_stopping)) Monitor::Wait(m_lock);
+			if(m_pending == nullptr) return;
+
+			// Hold the batch open for the interval unless the thread is being
+			// stopped, in which case it gets committed right away
+
+			deadline = DateTime::UtcNow + m_interval;
+			while(!m_stopping) {
+
+				remaining = deadline - DateTime::UtcNow;
+				if(remaining <= TimeSpan::Zero) break;
+				Monitor::Wait(m_lock, remaining);
+			}
+
+			// Close the batch; any request from here on opens a new one
+
+			batch = m_pending;
+			m_pending = nullptr;
+		}
+
+		try { m_commit(); batch->SetResult(true); }
+		catch(Exception^ ex) { batch->SetException(ex); }
+	}
+}
+
+//---------------------------------------------------------------------------
+// StorageGroupCommit::Request
+//
+// Requests a commit by joining the open batch, or opening a new one
+//
+// Arguments:
+//
+//	NONE
+
+Task^ StorageGroupCommit::Request(void)
+{
+	lock cs(m_lock);
+
+	CHECK_DISPOSED(m_disposed || m_stopping);
+
+	if(m_pending == nullptr) {
+
+		m_pending = gcnew TaskCompletionSource<bool>();
+		Monitor::PulseAll(m_lock);
+	}
+
+	return m_pending->Task;
+}
+
+//---------------------------------------------------------------------------
+
+END_ROOT_NAMESPACE(zuki::storage)
+
+#pragma warning(pop)
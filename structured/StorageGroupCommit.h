@@ -0,0 +1,110 @@
+//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+#ifndef __STORAGEGROUPCOMMIT_H_
+#define __STORAGEGROUPCOMMIT_H_
+#pragma once
+
+#pragma warning(push, 4)				// Enable maximum compiler warnings
+
+using namespace System;
+using namespace System::Threading;
+using namespace System::Threading::Tasks;
+using namespace msclr;
+
+BEGIN_ROOT_NAMESPACE(zuki::storage)
+
+//---------------------------------------------------------------------------
+// Class StorageGroupCommit (internal)
+//
+// StorageGroupCommit coalesces commit requests from any number of threads
+// into batches that are committed by a single background thread.  The first
+// request after a commit opens a new batch, and the thread waits for the
+// interval to let other requests join it before committing.  Every request
+// in a batch gets the same Task, which completes once the commit that covers
+// it has finished, or faults with whatever the commit threw.
+//
+// A request never joins a batch whose commit has already started, so a
+// completed Task always means that everything written before the request
+// was made has been committed.
+//---------------------------------------------------------------------------
+
+ref class StorageGroupCommit sealed
+{
+public:
+
+	//-----------------------------------------------------------------------
+	// Constructor
+
+	StorageGroupCommit(Action^ commit, TimeSpan interval);
+
+	//-----------------------------------------------------------------------
+	// Member Functions
+
+	// Request
+	//
+	// Requests a commit; the returned Task completes when it's durable
+	Task^ Request(void);
+
+	//-----------------------------------------------------------------------
+	// Properties
+
+	// Interval
+	//
+	// Gets the time that a batch is held open for before being committed
+	property TimeSpan Interval
+	{
+		TimeSpan get(void) { return m_interval; }
+	}
+
+private:
+
+	// DESTRUCTOR
+	~StorageGroupCommit();
+
+	//-----------------------------------------------------------------------
+	// Private Member Functions
+
+	// CommitThread
+	//
+	// Background thread that commits each batch
+	void CommitThread(void);
+
+	//-----------------------------------------------------------------------
+	// Member Variables
+
+	bool							m_disposed;		// Object disposal flag
+	initonly Action^				m_commit;		// Commit operation
+	initonly TimeSpan				m_interval;		// Batch interval
+	initonly Object^				m_lock;			// Synchronization object
+	initonly Thread^				m_thread;		// Commit thread
+	TaskCompletionSource<bool>^		m_pending;		// Open batch, if any
+	bool							m_stopping;		// Flag to stop the thread
+};
+
+//---------------------------------------------------------------------------
+
+END_ROOT_NAMESPACE(zuki::storage)
+
+#pragma warning(pop)
+
+#endif	// __STORAGEGROUPCOMMIT_H_
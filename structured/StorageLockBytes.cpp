@@ -0,0 +1,735 @@
+//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+#include "stdafx.h"						// Include project pre-compiled headers
+#include "StorageLockBytes.h"			// Include StorageLockBytes declarations
+
+#include <algorithm>					// Include STL algorithm declarations
+#include <new>							// Include STL nothrow declarations
+
+#pragma warning(push, 4)				// Enable maximum compiler warnings
+
+// This is all called directly from the compound file implementation, so keep
+// it native and avoid a managed transition for every read and write
+
+#pragma managed(push, off)
+
+BEGIN_ROOT_NAMESPACE(zuki::storage)
+
+//---------------------------------------------------------------------------
+// StorageLockBytes Constructor (private)
+//
+// Arguments:
+//
+//	hFile			- Unbuffered file handle; ownership is transferred
+//	pwcsPath		- Full path to the file
+//	grfMode			- STGM_XXXX mode flags the file was opened with
+//	cbSize			- Current size of the file
+//	cbPage			- Size of each cache page, a multiple of the sector size
+//	cPages			- Maximum number of pages to cache
+//	cRunPages		- Maximum number of pages to read or write at once
+
+StorageLockBytes::StorageLockBytes(HANDLE hFile, LPCWSTR pwcsPath, DWORD grfMode, ULONGLONG cbSize, 
+	ULONG cbPage, size_t cPages, ULONG cRunPages) : m_cRef(1), m_hFile(hFile), m_grfMode(grfMode), 
+	m_cbSize(cbSize), m_cbPage(cbPage), m_cPages(cPages), m_cRunPages(cRunPages), m_pRun(NULL)
+{
+	InitializeCriticalSection(&m_cs);
+	m_path.assign(pwcsPath, pwcsPath + wcslen(pwcsPath) + 1);
+}
+
+//---------------------------------------------------------------------------
+// StorageLockBytes Destructor (private)
+
+StorageLockBytes::~StorageLockBytes()
+{
+	Flush();									// Write back dirty pages
+
+	for(PageList::iterator it = m_lru.begin(); it != m_lru.end(); it++) {
+
+		VirtualFree((*it)->data, 0, MEM_RELEASE);
+		delete *it;
+	}
+
+	if(m_pRun) VirtualFree(m_pRun, 0, MEM_RELEASE);
+
+	CloseHandle(m_hFile);
+	DeleteCriticalSection(&m_cs);
+}
+
+//---------------------------------------------------------------------------
+// StorageLockBytes::AddRef (IUnknown)
+
+STDMETHODIMP_(ULONG) StorageLockBytes::AddRef(void)
+{
+	return static_cast<ULONG>(InterlockedIncrement(&m_cRef));
+}
+
+//---------------------------------------------------------------------------
+// StorageLockBytes::Create (static)
+//
+// Opens or creates a file for unbuffered I/O and wraps a new StorageLockBytes
+// instance around it
+//
+// Arguments:
+//
+//	pwcsPath		- Full path to the file
+//	grfMode			- STGM_XXXX access and sharing flags
+//	dwDisposition	- CreateFile() disposition (CREATE_ALWAYS, OPEN_EXISTING, ...)
+//	cbCache			- Size of the page cache, in bytes
+//	cReadAhead		- Maximum number of pages to read or write at once
+//	ppLockBytes		- On success, receives the new ILockBytes
+
+HRESULT StorageLockBytes::Create(LPCWSTR pwcsPath, DWORD grfMode, DWORD dwDisposition, 
+	size_t cbCache, ULONG cReadAhead, ILockBytes** ppLockBytes)
+{
+	wchar_t					volume[MAX_PATH + 1];	// Volume mount point
+	DWORD					cSectorsPerCluster;		// Sectors per cluster
+	DWORD					cbSector = 0;			// Bytes per sector
+	DWORD					cFreeClusters;			// Free clusters
+	DWORD					cTotalClusters;			// Total clusters
+	DWORD					dwAccess;				// File access flags
+	DWORD					dwShare;				// File sharing flags
+	ULONG					cbPage;					// Page size
+	size_t					cPages;					// Number of cached pages
+	LARGE_INTEGER			liSize;					// Size of the file
+	HANDLE					hFile;					// Unbuffered file handle
+	StorageLockBytes*		pLockBytes;				// New instance
+
+	if((pwcsPath == NULL) || (ppLockBytes == NULL)) return E_POINTER;
+	*ppLockBytes = NULL;
+
+	// The page cache isn't shared with anyone, so nothing else can be allowed
+	// to write to the file while it's open
+
+	switch(grfMode & (STGM_SHARE_EXCLUSIVE | STGM_SHARE_DENY_READ | STGM_SHARE_DENY_WRITE | STGM_SHARE_DENY_NONE)) {
+
+		case STGM_SHARE_EXCLUSIVE: dwShare = 0; break;
+		case STGM_SHARE_DENY_WRITE: dwShare = FILE_SHARE_READ; break;
+		default: return STG_E_INVALIDFLAG;
+	}
+
+	dwAccess = ((grfMode & 0xF) == STGM_READ) ? GENERIC_READ : (GENERIC_READ | GENERIC_WRITE);
+
+	// Unbuffered I/O has to be done in multiples of the volume sector size, so
+	// round the page size up to that.  Assume 4KiB if it can't be determined
+
+	if(GetVolumePathNameW(pwcsPath, volume, MAX_PATH + 1))
+		GetDiskFreeSpaceW(volume, &cSectorsPerCluster, &cbSector, &cFreeClusters, &cTotalClusters);
+	if(cbSector == 0) cbSector = 4096;
+
+	cbPage = ((PAGE_SIZE + cbSector - 1) / cbSector) * cbSector;
+
+	hFile = CreateFileW(pwcsPath, dwAccess, dwShare, NULL, dwDisposition, 
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING, NULL);
+	if(hFile == INVALID_HANDLE_VALUE) return HRESULT_FROM_WIN32(GetLastError());
+
+	if(!GetFileSizeEx(hFile, &liSize)) {
+
+		DWORD dwError = GetLastError();
+		CloseHandle(hFile);
+		return HRESULT_FROM_WIN32(dwError);
+	}
+
+	// A run can't be allowed to push more than half of the cache out, or it
+	// would start evicting the pages that it had just read in
+
+	cPages = (std::max)(cbCache / cbPage, MIN_PAGES);
+	cReadAhead = static_cast<ULONG>((std::min)(static_cast<size_t>((std::max)(cReadAhead, 1UL)), cPages / 2));
+
+	pLockBytes = new(std::nothrow) StorageLockBytes(hFile, pwcsPath, grfMode, 
+		static_cast<ULONGLONG>(liSize.QuadPart), cbPage, cPages, cReadAhead);
+	if(pLockBytes == NULL) { CloseHandle(hFile); return E_OUTOFMEMORY; }
+
+	*ppLockBytes = pLockBytes;
+	return S_OK;
+}
+
+//---------------------------------------------------------------------------
+// StorageLockBytes::Flush (ILockBytes)
+//
+// Writes all dirty pages back into the file in file order, trims the file to
+// the logical size and flushes it to disk
+//
+// Arguments:
+//
+//	NONE
+
+STDMETHODIMP StorageLockBytes::Flush(void)
+{
+	std::vector<Page*>		dirty;				// Dirty pages
+	HRESULT					hResult = S_OK;		// Result from function call
+
+	if((m_grfMode & 0xF) == STGM_READ) return S_OK;
+
+	EnterCriticalSection(&m_cs);
+
+	for(PageList::iterator it = m_lru.begin(); it != m_lru.end(); it++)
+		if((*it)->dirty) dirty.push_back(*it);
+
+	std::sort(dirty.begin(), dirty.end(), [](Page* lhs, Page* rhs) { return lhs->index < rhs->index; });
+
+	// Split the dirty pages into runs of adjacent pages and write each run
+	// back with a single transfer
+
+	for(size_t first = 0, last; (first < dirty.size()) && SUCCEEDED(hResult); first = last) {
+
+		for(last = first + 1; last < dirty.size(); last++) {
+
+			if((last - first) >= m_cRunPages) break;
+			if(dirty[last]->index != (dirty[last - 1]->index + 1)) break;
+		}
+
+		hResult = WriteRun(&dirty[first], static_cast<ULONG>(last - first));
+	}
+
+	if(SUCCEEDED(hResult)) hResult = TrimFile();
+	if(SUCCEEDED(hResult) && !FlushFileBuffers(m_hFile)) hResult = HRESULT_FROM_WIN32(GetLastError());
+
+	LeaveCriticalSection(&m_cs);
+
+	return hResult;
+}
+
+//---------------------------------------------------------------------------
+// StorageLockBytes::GetPage (private)
+//
+// Gets a page from the cache, recycling the least recently used page if the
+// cache is full.  Must be called with the critical section held
+//
+// Arguments:
+//
+//	index			- Index of the page in the file
+//	load			- Flag to read the page from the file; otherwise it's zeroed
+//	ppPage			- On success, receives the cached page
+
+HRESULT StorageLockBytes::GetPage(ULONGLONG index, bool load, Page** ppPage)
+{
+	PageMap::iterator		found;				// Existing cache entry
+	Page*					pPage;				// Page to be returned
+	HRESULT					hResult;			// Result from function call
+
+	// If the page is already cached, just move it to the front of the list
+
+	found = m_pages.find(index);
+	if(found != m_pages.end()) {
+
+		m_lru.splice(m_lru.begin(), m_lru, found->second);
+		*ppPage = *(found->second);
+		return S_OK;
+	}
+
+	// Recycle the least recently used page if the cache is full, otherwise
+	// allocate a new one.  VirtualAlloc() buffers are always sector-aligned
+
+	if(m_pages.size() >= m_cPages) {
+
+		pPage = m_lru.back();
+		if(pPage->dirty) {
+
+			hResult = WritePage(pPage);
+			if(FAILED(hResult)) return hResult;
+		}
+
+		m_pages.erase(pPage->index);
+		m_lru.pop_back();
+	}
+
+	else {
+
+		pPage = new(std::nothrow) Page;
+		if(pPage == NULL) return E_OUTOFMEMORY;
+
+		pPage->data = reinterpret_cast<BYTE*>(VirtualAlloc(NULL, m_cbPage, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+		if(pPage->data == NULL) { delete pPage; return E_OUTOFMEMORY; }
+	}
+
+	pPage->index = index;
+	pPage->dirty = false;
+
+	if(load) hResult = ReadPage(pPage);
+	else { memset(pPage->data, 0, m_cbPage); hResult = S_OK; }
+
+	if(FAILED(hResult)) {
+
+		VirtualFree(pPage->data, 0, MEM_RELEASE);
+		delete pPage;
+		return hResult;
+	}
+
+	m_lru.push_front(pPage);
+	m_pages[index] = m_lru.begin();
+
+	*ppPage = pPage;
+	return S_OK;
+}
+
+//---------------------------------------------------------------------------
+// StorageLockBytes::LockRegion (ILockBytes)
+//
+// Region locking isn't supported; Stat() reports that so it isn't called
+
+STDMETHODIMP StorageLockBytes::LockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD)
+{
+	return STG_E_INVALIDFUNCTION;
+}
+
+//---------------------------------------------------------------------------
+// StorageLockBytes::QueryInterface (IUnknown)
+
+STDMETHODIMP StorageLockBytes::QueryInterface(REFIID riid, void** ppvObject)
+{
+	if(ppvObject == NULL) return E_POINTER;
+
+	if((riid == IID_IUnknown) || (riid == IID_ILockBytes)) {
+
+		*ppvObject = static_cast<ILockBytes*>(this);
+		AddRef();
+		return S_OK;
+	}
+
+	*ppvObject = NULL;
+	return E_NOINTERFACE;
+}
+
+//---------------------------------------------------------------------------
+// StorageLockBytes::ReadAt (ILockBytes)
+//
+// Reads data from the file through the page cache
+//
+// Arguments:
+//
+//	ulOffset		- Offset into the file to start reading from
+//	pv				- Buffer to receive the data
+//	cb				- Number of bytes to read
+//	pcbRead			- Optionally receives the number of bytes read
+
+STDMETHODIMP StorageLockBytes::ReadAt(ULARGE_INTEGER ulOffset, void* pv, ULONG cb, ULONG* pcbRead)
+{
+	ULONGLONG				offset;				// Current offset
+	ULONG					total = 0;			// Total bytes read
+	ULONG					pageOffset;			// Offset into current page
+	ULONG					count;				// Bytes to read from page
+	Page*					pPage;				// Current page
+	HRESULT					hResult = S_OK;		// Result from function call
+
+	if(pcbRead) *pcbRead = 0;
+	if(pv == NULL) return STG_E_INVALIDPOINTER;
+
+	EnterCriticalSection(&m_cs);
+
+	for(offset = ulOffset.QuadPart; (total < cb) && (offset < m_cbSize); offset += count, total += count) {
+
+		pageOffset = static_cast<ULONG>(offset % m_cbPage);
+		count = (std::min)(cb - total, m_cbPage - pageOffset);
+		count = static_cast<ULONG>((std::min)(static_cast<ULONGLONG>(count), m_cbSize - offset));
+
+		// Pages that aren't cached yet are read in along with the pages that
+		// follow them, so sequential reads only go to the file once per run
+
+		if(m_pages.find(offset / m_cbPage) == m_pages.end()) {
+
+			hResult = ReadRun(offset / m_cbPage);
+			if(FAILED(hResult)) break;
+		}
+
+		hResult = GetPage(offset / m_cbPage, true, &pPage);
+		if(FAILED(hResult)) break;
+
+		memcpy(reinterpret_cast<BYTE*>(pv) + total, pPage->data + pageOffset, count);
+	}
+
+	LeaveCriticalSection(&m_cs);
+
+	if(pcbRead) *pcbRead = total;
+	return hResult;
+}
+
+//---------------------------------------------------------------------------
+// StorageLockBytes::ReadPage (private)
+//
+// Reads a whole page from the file.  Anything past the logical end of the
+// file is zeroed, whether or not it physically exists yet
+//
+// Arguments:
+//
+//	pPage			- Page to be read
+
+HRESULT StorageLockBytes::ReadPage(Page* pPage)
+{
+	ULONGLONG				offset;				// Offset of the page
+	OVERLAPPED				overlapped;			// Offset for ReadFile()
+	DWORD					cbRead = 0;			// Bytes read from the file
+
+	offset = pPage->index * m_cbPage;
+
+	if(offset < m_cbSize) {
+
+		memset(&overlapped, 0, sizeof(OVERLAPPED));
+		overlapped.Offset = static_cast<DWORD>(offset);
+		overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+		if(!ReadFile(m_hFile, pPage->data, m_cbPage, &cbRead, &overlapped)) {
+
+			DWORD dwError = GetLastError();
+			if(dwError != ERROR_HANDLE_EOF) return HRESULT_FROM_WIN32(dwError);
+			cbRead = 0;
+		}
+
+		cbRead = static_cast<DWORD>((std::min)(static_cast<ULONGLONG>(cbRead), m_cbSize - offset));
+	}
+
+	memset(pPage->data + cbRead, 0, m_cbPage - cbRead);
+	return S_OK;
+}
+
+//---------------------------------------------------------------------------
+// StorageLockBytes::ReadRun (private)
+//
+// Reads a page that isn't cached, along with the pages that follow it up to
+// the end of the file, the next cached page or the read-ahead depth, using a
+// single transfer.  Must be called with the critical section held
+//
+// Arguments:
+//
+//	index			- Index of the first page in the run
+
+HRESULT StorageLockBytes::ReadRun(ULONGLONG index)
+{
+	ULONGLONG				offset;				// Offset of the run
+	ULONGLONG				cPagesInFile;		// Number of pages in the file
+	ULONG					cPages;				// Number of pages in the run
+	OVERLAPPED				overlapped;			// Offset for ReadFile()
+	DWORD					cbRead = 0;			// Bytes read from the file
+	ULONG					cbValid;			// Bytes of the page in the file
+	Page*					pPage;				// Current page
+	HRESULT					hResult;			// Result from function call
+
+	offset = index * m_cbPage;
+	if(offset >= m_cbSize) return S_OK;			// Nothing to read
+
+	cPagesInFile = (m_cbSize + m_cbPage - 1) / m_cbPage;
+
+	for(cPages = 1; cPages < m_cRunPages; cPages++) {
+
+		if((index + cPages) >= cPagesInFile) break;
+		if(m_pages.find(index + cPages) != m_pages.end()) break;
+	}
+
+	// Single pages are read straight into the cache by GetPage()
+
+	if(cPages == 1) return S_OK;
+
+	if(m_pRun == NULL) {
+
+		m_pRun = reinterpret_cast<BYTE*>(VirtualAlloc(NULL, m_cRunPages * m_cbPage, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+		if(m_pRun == NULL) return E_OUTOFMEMORY;
+	}
+
+	memset(&overlapped, 0, sizeof(OVERLAPPED));
+	overlapped.Offset = static_cast<DWORD>(offset);
+	overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+	if(!ReadFile(m_hFile, m_pRun, cPages * m_cbPage, &cbRead, &overlapped)) {
+
+		DWORD dwError = GetLastError();
+		if(dwError != ERROR_HANDLE_EOF) return HRESULT_FROM_WIN32(dwError);
+		cbRead = 0;
+	}
+
+	// Distribute the run into freshly allocated (zeroed) cache pages, and
+	// clip each one to what was read and to the logical end of the file
+
+	for(ULONG page = 0; page < cPages; page++) {
+
+		hResult = GetPage(index + page, false, &pPage);
+		if(FAILED(hResult)) return hResult;
+
+		offset = (index + page) * m_cbPage;
+		cbValid = static_cast<ULONG>((std::min)(static_cast<ULONGLONG>(m_cbPage), m_cbSize - offset));
+		cbValid = (std::min)(cbValid, (cbRead > (page * m_cbPage)) ? cbRead - (page * m_cbPage) : 0UL);
+
+		memcpy(pPage->data, m_pRun + (page * m_cbPage), cbValid);
+	}
+
+	return S_OK;
+}
+
+//---------------------------------------------------------------------------
+// StorageLockBytes::Release (IUnknown)
+
+STDMETHODIMP_(ULONG) StorageLockBytes::Release(void)
+{
+	LONG cRef = InterlockedDecrement(&m_cRef);
+	if(cRef == 0) delete this;
+
+	return static_cast<ULONG>(cRef);
+}
+
+//---------------------------------------------------------------------------
+// StorageLockBytes::SetSize (ILockBytes)
+//
+// Changes the logical size of the file
+//
+// Arguments:
+//
+//	cb				- New size of the file
+
+STDMETHODIMP StorageLockBytes::SetSize(ULARGE_INTEGER cb)
+{
+	PageList::iterator		it;					// List iterator
+	PageMap::iterator		found;				// Cache entry
+	HRESULT					hResult;			// Result from function call
+
+	if((m_grfMode & 0xF) == STGM_READ) return STG_E_ACCESSDENIED;
+
+	EnterCriticalSection(&m_cs);
+
+	// When shrinking, throw away every cached page past the new end of file
+	// and zero the tail of the page that the new end of file falls in, so it
+	// reads back as zeros if the file is grown again later
+
+	if(cb.QuadPart < m_cbSize) {
+
+		for(it = m_lru.begin(); it != m_lru.end();) {
+
+			if(((*it)->index * m_cbPage) >= cb.QuadPart) {
+
+				m_pages.erase((*it)->index);
+				VirtualFree((*it)->data, 0, MEM_RELEASE);
+				delete *it;
+				it = m_lru.erase(it);
+			}
+
+			else it++;
+		}
+
+		found = m_pages.find(cb.QuadPart / m_cbPage);
+		if(found != m_pages.end()) {
+
+			ULONG pageOffset = static_cast<ULONG>(cb.QuadPart % m_cbPage);
+			memset((*(found->second))->data + pageOffset, 0, m_cbPage - pageOffset);
+		}
+	}
+
+	m_cbSize = cb.QuadPart;
+	hResult = TrimFile();
+
+	LeaveCriticalSection(&m_cs);
+
+	return hResult;
+}
+
+//---------------------------------------------------------------------------
+// StorageLockBytes::Stat (ILockBytes)
+//
+// Retrieves a STATSTG structure for the file
+//
+// Arguments:
+//
+//	pstatstg		- STATSTG structure to be filled in
+//	grfStatFlag		- STATFLAG_XXXX flags
+
+STDMETHODIMP StorageLockBytes::Stat(::STATSTG* pstatstg, DWORD grfStatFlag)
+{
+	if(pstatstg == NULL) return STG_E_INVALIDPOINTER;
+
+	memset(pstatstg, 0, sizeof(::STATSTG));
+
+	if((grfStatFlag & STATFLAG_NONAME) == 0) {
+
+		pstatstg->pwcsName = reinterpret_cast<LPOLESTR>(CoTaskMemAlloc(m_path.size() * sizeof(wchar_t)));
+		if(pstatstg->pwcsName == NULL) return STG_E_INSUFFICIENTMEMORY;
+		memcpy(pstatstg->pwcsName, m_path.data(), m_path.size() * sizeof(wchar_t));
+	}
+
+	EnterCriticalSection(&m_cs);
+	pstatstg->cbSize.QuadPart = m_cbSize;
+	LeaveCriticalSection(&m_cs);
+
+	pstatstg->type = STGTY_LOCKBYTES;
+	pstatstg->grfMode = m_grfMode;
+	pstatstg->grfLocksSupported = 0;
+	GetFileTime(m_hFile, &pstatstg->ctime, &pstatstg->atime, &pstatstg->mtime);
+
+	return S_OK;
+}
+
+//---------------------------------------------------------------------------
+// StorageLockBytes::TrimFile (private)
+//
+// Sets the physical end of the file to the logical size.  Whole-page writes
+// can leave the file longer than it should be.  Must be called with the
+// critical section held
+//
+// Arguments:
+//
+//	NONE
+
+HRESULT StorageLockBytes::TrimFile(void)
+{
+	LARGE_INTEGER			liSize;				// New end of file
+
+	liSize.QuadPart = static_cast<LONGLONG>(m_cbSize);
+
+	if(!SetFilePointerEx(m_hFile, liSize, NULL, FILE_BEGIN)) return HRESULT_FROM_WIN32(GetLastError());
+	if(!::SetEndOfFile(m_hFile)) return HRESULT_FROM_WIN32(GetLastError());
+
+	return S_OK;
+}
+
+//---------------------------------------------------------------------------
+// StorageLockBytes::UnlockRegion (ILockBytes)
+//
+// Region locking isn't supported; Stat() reports that so it isn't called
+
+STDMETHODIMP StorageLockBytes::UnlockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD)
+{
+	return STG_E_INVALIDFUNCTION;
+}
+
+//---------------------------------------------------------------------------
+// StorageLockBytes::WriteAt (ILockBytes)
+//
+// Writes data into the file through the page cache
+//
+// Arguments:
+//
+//	ulOffset		- Offset into the file to start writing at
+//	pv				- Buffer with the data to be written
+//	cb				- Number of bytes to write
+//	pcbWritten		- Optionally receives the number of bytes written
+
+STDMETHODIMP StorageLockBytes::WriteAt(ULARGE_INTEGER ulOffset, const void* pv, ULONG cb, ULONG* pcbWritten)
+{
+	ULONGLONG				offset;				// Current offset
+	ULONG					total = 0;			// Total bytes written
+	ULONG					pageOffset;			// Offset into current page
+	ULONG					count;				// Bytes to write into page
+	ULONGLONG				index;				// Current page index
+	Page*					pPage;				// Current page
+	HRESULT					hResult = S_OK;		// Result from function call
+
+	if(pcbWritten) *pcbWritten = 0;
+	if(pv == NULL) return STG_E_INVALIDPOINTER;
+	if((m_grfMode & 0xF) == STGM_READ) return STG_E_ACCESSDENIED;
+
+	EnterCriticalSection(&m_cs);
+
+	for(offset = ulOffset.QuadPart; total < cb; offset += count, total += count) {
+
+		index = offset / m_cbPage;
+		pageOffset = static_cast<ULONG>(offset % m_cbPage);
+		count = (std::min)(cb - total, m_cbPage - pageOffset);
+
+		// There's no need to read in a page that's about to be completely
+		// overwritten, or one that lies entirely past the end of the file
+
+		hResult = GetPage(index, ((count < m_cbPage) && ((index * m_cbPage) < m_cbSize)), &pPage);
+		if(FAILED(hResult)) break;
+
+		memcpy(pPage->data + pageOffset, reinterpret_cast<const BYTE*>(pv) + total, count);
+		pPage->dirty = true;
+
+		if((offset + count) > m_cbSize) m_cbSize = offset + count;
+	}
+
+	LeaveCriticalSection(&m_cs);
+
+	if(pcbWritten) *pcbWritten = total;
+	return hResult;
+}
+
+//---------------------------------------------------------------------------
+// StorageLockBytes::WritePage (private)
+//
+// Writes a whole page back into the file.  Must be called with the critical
+// section held
+//
+// Arguments:
+//
+//	pPage			- Page to be written
+
+HRESULT StorageLockBytes::WritePage(Page* pPage)
+{
+	ULONGLONG				offset;				// Offset of the page
+	OVERLAPPED				overlapped;			// Offset for WriteFile()
+	DWORD					cbWritten;			// Bytes written to the file
+
+	offset = pPage->index * m_cbPage;
+
+	memset(&overlapped, 0, sizeof(OVERLAPPED));
+	overlapped.Offset = static_cast<DWORD>(offset);
+	overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+	if(!WriteFile(m_hFile, pPage->data, m_cbPage, &cbWritten, &overlapped)) 
+		return HRESULT_FROM_WIN32(GetLastError());
+
+	pPage->dirty = false;
+	return S_OK;
+}
+
+//---------------------------------------------------------------------------
+// StorageLockBytes::WriteRun (private)
+//
+// Writes a run of adjacent dirty pages back into the file with a single
+// transfer.  Must be called with the critical section held
+//
+// Arguments:
+//
+//	rgpPages		- Adjacent pages to be written, in file order
+//	cPages			- Number of pages in the run
+
+HRESULT StorageLockBytes::WriteRun(Page** rgpPages, ULONG cPages)
+{
+	ULONGLONG				offset;				// Offset of the run
+	OVERLAPPED				overlapped;			// Offset for WriteFile()
+	DWORD					cbWritten;			// Bytes written to the file
+
+	if(cPages == 1) return WritePage(rgpPages[0]);
+
+	if(m_pRun == NULL) {
+
+		m_pRun = reinterpret_cast<BYTE*>(VirtualAlloc(NULL, m_cRunPages * m_cbPage, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+		if(m_pRun == NULL) return E_OUTOFMEMORY;
+	}
+
+	for(ULONG page = 0; page < cPages; page++) memcpy(m_pRun + (page * m_cbPage), rgpPages[page]->data, m_cbPage);
+
+	offset = rgpPages[0]->index * m_cbPage;
+
+	memset(&overlapped, 0, sizeof(OVERLAPPED));
+	overlapped.Offset = static_cast<DWORD>(offset);
+	overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+	if(!WriteFile(m_hFile, m_pRun, cPages * m_cbPage, &cbWritten, &overlapped)) 
+		return HRESULT_FROM_WIN32(GetLastError());
+
+	for(ULONG page = 0; page < cPages; page++) rgpPages[page]->dirty = false;
+	return S_OK;
+}
+
+//---------------------------------------------------------------------------
+
+END_ROOT_NAMESPACE(zuki::storage)
+
+#pragma managed(pop)
+#pragma warning(pop)
@@ -0,0 +1,183 @@
+//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+#ifndef __STORAGELOCKBYTES_H_
+#define __STORAGELOCKBYTES_H_
+#pragma once
+
+#include <list>							// Include STL list<> declarations
+#include <unordered_map>				// Include STL unordered_map<> decls
+#include <vector>						// Include STL vector<> declarations
+
+#pragma warning(push, 4)				// Enable maximum compiler warnings
+
+BEGIN_ROOT_NAMESPACE(zuki::storage)
+
+//---------------------------------------------------------------------------
+// Class StorageLockBytes (internal)
+//
+// StorageLockBytes implements an unmanaged ILockBytes over a file that is
+// opened for unbuffered I/O, with its own fixed-size page cache in front of
+// it.  The compound file implementation makes lots of small, unaligned reads
+// and writes; this turns them into whole-page, sector-aligned transfers and
+// keeps the file out of the system cache so memory use is predictable.
+//
+// Pages are evicted in least-recently-used order, and dirty pages are only
+// written back when they're evicted or when the ILockBytes is flushed.  The
+// file may temporarily be longer than the logical size because every write
+// is a whole page; Flush() and SetSize() trim it back down.
+//
+// Cache misses are read as runs: the missing page and the pages after it
+// that aren't cached yet, up to the read-ahead depth, in a single transfer.
+// Adjacent dirty pages are likewise written back as runs by Flush().
+//
+// The cache is private to this instance, so the file can't be shared with
+// anything else that writes to it.
+//---------------------------------------------------------------------------
+
+class StorageLockBytes : public ILockBytes
+{
+public:
+
+	//-----------------------------------------------------------------------
+	// Member Functions
+
+	// Create (static)
+	//
+	// Opens or creates a file and wraps a new StorageLockBytes around it
+	static HRESULT Create(LPCWSTR pwcsPath, DWORD grfMode, DWORD dwDisposition, 
+		size_t cbCache, ULONG cReadAhead, ILockBytes** ppLockBytes);
+
+	//-----------------------------------------------------------------------
+	// IUnknown
+
+	STDMETHOD(QueryInterface)(REFIID riid, void** ppvObject);
+	STDMETHOD_(ULONG, AddRef)(void);
+	STDMETHOD_(ULONG, Release)(void);
+
+	//-----------------------------------------------------------------------
+	// ILockBytes
+
+	STDMETHOD(Flush)(void);
+	STDMETHOD(LockRegion)(ULARGE_INTEGER libOffset, ULARGE_INTEGER cb, DWORD dwLockType);
+	STDMETHOD(ReadAt)(ULARGE_INTEGER ulOffset, void* pv, ULONG cb, ULONG* pcbRead);
+	STDMETHOD(SetSize)(ULARGE_INTEGER cb);
+	STDMETHOD(Stat)(::STATSTG* pstatstg, DWORD grfStatFlag);
+	STDMETHOD(UnlockRegion)(ULARGE_INTEGER libOffset, ULARGE_INTEGER cb, DWORD dwLockType);
+	STDMETHOD(WriteAt)(ULARGE_INTEGER ulOffset, const void* pv, ULONG cb, ULONG* pcbWritten);
+
+private:
+
+	// PRIVATE CONSTRUCTOR / DESTRUCTOR
+	StorageLockBytes(HANDLE hFile, LPCWSTR pwcsPath, DWORD grfMode, ULONGLONG cbSize, ULONG cbPage, 
+		size_t cPages, ULONG cRunPages);
+	~StorageLockBytes();
+
+	StorageLockBytes(const StorageLockBytes&);
+	StorageLockBytes& operator=(const StorageLockBytes&);
+
+	//-----------------------------------------------------------------------
+	// Private Constants
+
+	// PAGE_SIZE
+	//
+	// Default size of a cache page; rounded up to the volume sector size
+	static const ULONG PAGE_SIZE = 65536;
+
+	// MIN_PAGES
+	//
+	// Minimum number of pages in the cache, regardless of requested size
+	static const size_t MIN_PAGES = 4;
+
+	//-----------------------------------------------------------------------
+	// Private Data Types
+
+	// Page
+	//
+	// A single cached page of the file
+	struct Page
+	{
+		ULONGLONG			index;				// Page index in the file
+		BYTE*				data;				// Sector-aligned page buffer
+		bool				dirty;				// Flag if page needs writing
+	};
+
+	typedef std::list<Page*>								PageList;
+	typedef std::unordered_map<ULONGLONG, PageList::iterator>	PageMap;
+
+	//-----------------------------------------------------------------------
+	// Private Member Functions
+
+	// GetPage
+	//
+	// Gets a page from the cache, reading it in from the file if necessary
+	HRESULT GetPage(ULONGLONG index, bool load, Page** ppPage);
+
+	// ReadPage
+	//
+	// Reads a page from the file; anything past the end of file is zeroed
+	HRESULT ReadPage(Page* pPage);
+
+	// ReadRun
+	//
+	// Reads a missing page and the uncached pages after it in one transfer
+	HRESULT ReadRun(ULONGLONG index);
+
+	// TrimFile
+	//
+	// Sets the physical end of the file to the logical size
+	HRESULT TrimFile(void);
+
+	// WritePage
+	//
+	// Writes a dirty page back into the file
+	HRESULT WritePage(Page* pPage);
+
+	// WriteRun
+	//
+	// Writes a run of adjacent dirty pages back into the file in one transfer
+	HRESULT WriteRun(Page** rgpPages, ULONG cPages);
+
+	//-----------------------------------------------------------------------
+	// Member Variables
+
+	volatile LONG			m_cRef;				// Reference count
+	CRITICAL_SECTION		m_cs;				// Synchronization object
+	HANDLE					m_hFile;			// Unbuffered file handle
+	std::vector<wchar_t>	m_path;				// Full path to the file
+	DWORD					m_grfMode;			// STGM_XXXX mode flags
+	ULONG					m_cbPage;			// Size of each page
+	size_t					m_cPages;			// Maximum cached pages
+	ULONG					m_cRunPages;		// Maximum pages per transfer
+	BYTE*					m_pRun;				// Run transfer buffer
+	ULONGLONG				m_cbSize;			// Logical size of the file
+	PageList				m_lru;				// Pages, most recent first
+	PageMap					m_pages;			// Page index -> m_lru entry
+};
+
+//---------------------------------------------------------------------------
+
+END_ROOT_NAMESPACE(zuki::storage)
+
+#pragma warning(pop)
+
+#endif	// __STORAGELOCKBYTES_H_
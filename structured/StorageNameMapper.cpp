@@ -65,6 +65,25 @@ StorageNameMapper::StorageNameMapper(const FMTID& fmtid, ComStorage^ storage)
 	: m_fmtid(StorageUtil::UUIDToSysGuid(fmtid)), m_storage(storage)
 {
 	if(m_storage == nullptr) throw gcnew ArgumentNullException();
+
+	m_lock = gcnew ReaderWriterLockSlim(LockRecursionPolicy::NoRecursion);
+	m_initLock = gcnew Object();
+}
+
+//---------------------------------------------------------------------------
+// StorageNameMapper Destructor
+
+StorageNameMapper::~StorageNameMapper()
+{
+	if(m_disposed) return;
+
+	this->!StorageNameMapper();
+
+	// ReaderWriterLockSlim allocates wait events once it has been contended,
+	// and those are only released by disposing of it
+
+	delete m_lock;
+	m_disposed = true;
 }
 
 //---------------------------------------------------------------------------
@@ -89,12 +108,14 @@ StorageNameMapper::!StorageNameMapper()
 
 void StorageNameMapper::AddMapping(String^ name, Guid guid)
 {
-	lock					cs(SyncRoot);		// Automatic critical section
+	WriteLock				cs(m_lock);			// Automatic write lock
 	IPropertyStorage*		pPropStorage;		// IPropertyStorage interface
 	PROPSPEC				propspec;			// Property specification
 	PinnedStringPtr			pinName;			// Pinned string pointer
 	PROPVARIANT				varValue;			// value as a PROPVARIANT
 	GUID					uuid;				// The real UUID value
+	Guid					existing;			// Existing mapped GUID
+	PROPID					propid;				// Property ID code
 	HRESULT					hResult;			// Result from function call
 
 	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
@@ -104,7 +125,7 @@ void StorageNameMapper::AddMapping(String^ name, Guid guid)
 
 	// Check to see if this name already exists in the property set
 
-	if(ContainsName(name)) throw gcnew MappingExistsException(name);
+	if(MapNameInternal(name, existing)) throw gcnew MappingExistsException(name);
 
 	// Retrieve the appropriate IPropertyStorage for this template instance
 
@@ -118,20 +139,81 @@ void StorageNameMapper::AddMapping(String^ name, Guid guid)
 	varValue.vt = VT_CLSID;						// Always sending in a VT_CLSID
 	varValue.puuid = &uuid;						// Point to our unmanaged UUID
 
-	// Set up the PROPSPEC structure .. we'll be using a name here
+	// WriteMultiple() never reports the PROPID it assigns to a new name, so
+	// the PROPID is chosen here and the name is assigned to it separately;
+	// that way the index knows it and RenameMapping() doesn't have to look
 
-	propspec.ulKind = PRSPEC_LPWSTR;
-	propspec.lpwstr = const_cast<LPWSTR>(pinName);
+	propid = m_nextPropid;
+	propspec.ulKind = PRSPEC_PROPID;
+	propspec.propid = propid;
 
-	hResult = pPropStorage->WriteMultiple(1, &propspec, reinterpret_cast<PROPVARIANT*>(&varValue), 
-		NAMEMAPPER_BASEID);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	LPOLESTR rgwsz[] = { const_cast<LPOLESTR>(pinName) };
 
-	hResult = pPropStorage->Commit(STGC_DEFAULT);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	// If anything goes wrong once the property set starts changing, the index
+	// can no longer be trusted and has to be reloaded the next time it's used
+
+	try {
+
+		hResult = pPropStorage->WriteMultiple(1, &propspec, reinterpret_cast<PROPVARIANT*>(&varValue), 
+			NAMEMAPPER_BASEID);
+		if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+		hResult = pPropStorage->WritePropertyNames(1, &propid, rgwsz);
+		if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+		hResult = pPropStorage->Commit(STGC_DEFAULT);
+		if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	}
+
+	catch(Exception^) { InvalidateIndex(); throw; }
 
 	// NOTE: Do not call PropVariantClear() here, since it would try to 
 	// release the pinned string (not a good thing to be doing)
+
+	m_names[name] = guid;
+	m_guids[guid] = name;
+	m_propids[guid] = propid;
+	m_nextPropid = propid + 1;
+}
+
+//---------------------------------------------------------------------------
+// StorageNameMapper::AllocNamePropSpecs (private, static)
+//
+// Allocates an unmanaged array of PROPSPEC structures that reference each of
+// the names by string.  The array must be released with FreeNamePropSpecs
+//
+// Arguments:
+//
+//	names			- List of names to be converted into PROPSPECs
+
+PROPSPEC* StorageNameMapper::AllocNamePropSpecs(List<String^>^ names)
+{
+	PROPSPEC*				rgpropspec;			// Allocated PROPSPEC array
+	ULONG					cpspec;				// Number of PROPSPECs
+
+	cpspec = static_cast<ULONG>(names->Count);
+	rgpropspec = new PROPSPEC[cpspec];
+	memset(rgpropspec, 0, sizeof(PROPSPEC) * cpspec);
+
+	// The names can't all be pinned at the same time with pin_ptr<>, so they
+	// have to be copied into unmanaged memory instead.  Any NULL name in the
+	// list is the caller's fault, but the array still has to be cleaned up
+
+	try {
+
+		for(ULONG index = 0; index < cpspec; index++) {
+
+			String^ name = names[static_cast<int>(index)];
+			if(name == nullptr) throw gcnew ArgumentNullException();
+
+			rgpropspec[index].ulKind = PRSPEC_LPWSTR;
+			rgpropspec[index].lpwstr = reinterpret_cast<LPOLESTR>(Marshal::StringToCoTaskMemUni(name).ToPointer());
+		}
+	}
+
+	catch(Exception^) { FreeNamePropSpecs(rgpropspec, cpspec); throw; }
+
+	return rgpropspec;
 }
 
 //---------------------------------------------------------------------------
@@ -145,12 +227,12 @@ void StorageNameMapper::AddMapping(String^ name, Guid guid)
 
 bool StorageNameMapper::ContainsGuid(Guid guid)
 {
-	lock				cs(SyncRoot);		// Automatic critical section
+	ReadLock			cs(m_lock);			// Automatic read lock
 	String^				name;				// Located mapped name
 
 	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
 
-	return MapGuidInternal(guid, name, NULL);	// Use MapGuidInternal
+	return MapGuidInternal(guid, name);		// Use MapGuidInternal
 }
 
 //---------------------------------------------------------------------------
@@ -164,12 +246,12 @@ bool StorageNameMapper::ContainsGuid(Guid guid)
 
 bool StorageNameMapper::ContainsName(String^ name)
 {
-	lock				cs(SyncRoot);		// Automatic critical section
+	ReadLock			cs(m_lock);			// Automatic read lock
 	Guid				guid;				// Located mapped GUID
 
 	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
 
-	return TryMapNameToGuid(name, guid);	// Use TryMapNameToGuid
+	return MapNameInternal(name, guid);		// Use MapNameInternal
 }
 
 //---------------------------------------------------------------------------
@@ -179,33 +261,32 @@ bool StorageNameMapper::ContainsName(String^ name)
 
 int StorageNameMapper::Count::get(void)
 {
-	lock					cs(SyncRoot);		// Automatic critical section
-	IPropertyStorage*		pPropStorage;		// IPropertyStorage interface
-	IEnumSTATPROPSTG*		pEnumStg;			// Storage enumerator
-	STATPROPSTG				statstg;			// Enumerated information
-	ULONG					ulRead;				// Number of items enumerated
-	int						count = 0;			// Number of items read
-	HRESULT					hResult;			// Result from function call
+	ReadLock				cs(m_lock);			// Automatic read lock
 
 	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
 
-	hResult = GetPropertyStorage(&pPropStorage);
-	if(FAILED(hResult)) return 0;
-
-	// Attempt to grab the property set enumerator from the PropertySetStorage
-
-	hResult = pPropStorage->Enum(&pEnumStg);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	if(FAILED(LoadIndex())) return 0;		// No property set, no mappings
+	return m_names->Count;
+}
 
-	// Enumerate all of the properties and keep track of how many we saw
+//---------------------------------------------------------------------------
+// StorageNameMapper::FreeNamePropSpecs (private, static)
+//
+// Releases a PROPSPEC array that was allocated with AllocNamePropSpecs
+//
+// Arguments:
+//
+//	rgpropspec		- PROPSPEC array to be released
+//	cpspec			- Number of elements in the PROPSPEC array
 
-	while(pEnumStg->Next(1, &statstg, &ulRead) == S_OK) {
+void StorageNameMapper::FreeNamePropSpecs(PROPSPEC* rgpropspec, ULONG cpspec)
+{
+	if(rgpropspec == NULL) return;
 
-		count++;
-		if(statstg.lpwstrName) CoTaskMemFree(statstg.lpwstrName); 
-	}
+	for(ULONG index = 0; index < cpspec; index++)
+		if(rgpropspec[index].lpwstr) CoTaskMemFree(rgpropspec[index].lpwstr);
 
-	return count;							// Return the number of properties
+	delete[] rgpropspec;
 }
 
 //---------------------------------------------------------------------------
@@ -231,9 +312,15 @@ HRESULT StorageNameMapper::GetPropertyStorage(IPropertyStorage** ppPropStorage)
 
 	if(m_pPropStorage) { *ppPropStorage = m_pPropStorage; return S_OK; }
 
+	// Any number of readers can get here at the same time, so the one-time
+	// creation of the IPropertyStorage has to be serialized on its own lock
+
+	lock cs(m_initLock);
+	if(m_pPropStorage) { *ppPropStorage = m_pPropStorage; return S_OK; }
+
 	fmtid = StorageUtil::SysGuidToUUID(m_fmtid);
 	propSetStorage = safe_cast<IComPropertySetStorage^>(m_storage);
-	readOnly = StorageUtil::IsStorageReadOnly(m_storage);
+	readOnly = m_storage->ReadOnly;
 
 	// First try to open an existing property set with the FMTID from the template
 
@@ -256,80 +343,156 @@ HRESULT StorageNameMapper::GetPropertyStorage(IPropertyStorage** ppPropStorage)
 }
 
 //---------------------------------------------------------------------------
-// StorageNameMapper::MapGuidInternal (private)
+// StorageNameMapper::InvalidateIndex (private)
 //
-// Internal version of MapGuidToName.  Enumerates all of the properties in the
-// set and if the GUID is found, it's corresponding name is returned
+// Discards the in-memory index so that it gets reloaded on next access.  Must
+// be called with the write lock held
 //
 // Arguments:
 //
-//	guid				- GUID to be tested for existance
-//	name				- On success, contains the mapped NAME
-//	pPropid				- Optional pointer to receive the PROPID
+//	NONE
+
+void StorageNameMapper::InvalidateIndex(void)
+{
+	m_names = nullptr;
+	m_guids = nullptr;
+	m_propids = nullptr;
+}
+
+//---------------------------------------------------------------------------
+// StorageNameMapper::LoadIndex (private)
+//
+// Loads the in-memory NAME<->GUID index from the property set the first time
+// it's needed.  The property set is enumerated and read in batches, so this
+// costs a handful of calls rather than one or more calls per mapping.  The
+// PROPID of each mapping is kept as well, along with the next unused one
+//
+// Arguments:
+//
+//	NONE
 
-bool StorageNameMapper::MapGuidInternal(Guid guid, String^% name, PROPID *pPropid)
+HRESULT StorageNameMapper::LoadIndex(void)
 {
 	IPropertyStorage*		pPropStorage;		// IPropertyStorage interface
 	IEnumSTATPROPSTG*		pEnumStg;			// Storage enumerator
-	STATPROPSTG				statstg;			// Enumerated information
+	STATPROPSTG				rgstatstg[INDEX_BATCHSIZE];		// Enumerated information
+	PROPSPEC				rgpropspec[INDEX_BATCHSIZE];	// Property specifications
+	PROPVARIANT				rgvarProperty[INDEX_BATCHSIZE];	// Property values
 	ULONG					ulRead;				// Number of items read
-	PROPSPEC				propspec;			// Property specification
-	PROPVARIANT				varProperty;		// VARIANT property value
+	PROPID					nextPropid;			// Next unused PROPID
 	HRESULT					hResult;			// Result from function call
 
-	name = nullptr;								// Initialize [out] variable
-	if(pPropid) *pPropid = PID_ILLEGAL;			// Initialize [out] variable
+	if(m_names != nullptr) return S_OK;			// Index is already loaded
 
 	hResult = GetPropertyStorage(&pPropStorage);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	if(FAILED(hResult)) return hResult;
 
-	// Attempt to grab the property set enumerator from the PropertySetStorage
+	// Any number of readers can get here at the same time, so the index is
+	// loaded under the same lock as the IPropertyStorage itself
+
+	lock cs(m_initLock);
+	if(m_names != nullptr) return S_OK;
+
+	m_storage->Statistics->MapperScan();
+
+	Dictionary<String^, Guid>^ names = gcnew Dictionary<String^, Guid>(StringComparer::OrdinalIgnoreCase);
+	Dictionary<Guid, String^>^ guids = gcnew Dictionary<Guid, String^>();
+	Dictionary<Guid, PROPID>^ propids = gcnew Dictionary<Guid, PROPID>();
+	nextPropid = NAMEMAPPER_BASEID;
 
 	hResult = pPropStorage->Enum(&pEnumStg);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	if(FAILED(hResult)) return hResult;
 
 	try {
 
-		// Enumerate all of the properties currently stuck in here one at a time
-		// so we can examine each GUID until we find the one we're looking for
+		// Enumerate the properties a batch at a time and read all of the values
+		// for each batch with a single ReadMultiple() call
+
+		do {
 
-		while(pEnumStg->Next(1, &statstg, &ulRead) == S_OK) {
+			hResult = pEnumStg->Next(INDEX_BATCHSIZE, rgstatstg, &ulRead);
+			if(FAILED(hResult)) throw gcnew StorageException(hResult);
+			if(ulRead == 0) break;
 
 			try {
 
-				propspec.propid = statstg.propid;		// Set the property ID
-				propspec.ulKind = PRSPEC_PROPID;		// Using the ID code
+				for(ULONG index = 0; index < ulRead; index++) {
+
+					rgpropspec[index].ulKind = PRSPEC_PROPID;
+					rgpropspec[index].propid = rgstatstg[index].propid;
+				}
+
+				memset(rgvarProperty, 0, sizeof(PROPVARIANT) * ulRead);
+
+				HRESULT hRead = pPropStorage->ReadMultiple(ulRead, rgpropspec, rgvarProperty);
+				if(FAILED(hRead)) throw gcnew StorageException(hRead);
 
-				// Read information about the enumerated property and test to see if
-				// it's name happens to match the one passed in by the caller
+				try {
 
-				hResult = pPropStorage->ReadMultiple(1, &propspec, &varProperty);
-				if(FAILED(hResult)) throw gcnew StorageException(hResult);
+					for(ULONG index = 0; index < ulRead; index++) {
 
-				try { 
+						PROPID propid = rgstatstg[index].propid;
+						if((propid >= nextPropid) && (propid < PID_MIN_READONLY)) nextPropid = propid + 1;
 
-					// If the property type is VT_CLSID and it matches our GUID,
-					// return the name associated with it back to the caller
+						if((rgvarProperty[index].vt != VT_CLSID) || (!rgstatstg[index].lpwstrName)) continue;
 
-					if((varProperty.vt == VT_CLSID) && (guid == StorageUtil::UUIDToSysGuid(*varProperty.puuid))) {
+						String^ name = gcnew String(rgstatstg[index].lpwstrName);
+						Guid guid = StorageUtil::UUIDToSysGuid(*rgvarProperty[index].puuid);
 
-						if(pPropid) *pPropid = statstg.propid;		// Set PROPID as needed
-						name = gcnew String(statstg.lpwstrName);	// Return the name
-						return true;								// Mapping successful
+						names[name] = guid;
+						guids[guid] = name;
+						propids[guid] = propid;
 					}
 				}
 
-				finally { PropVariantClear(&varProperty); }
-			} 
+				finally { FreePropVariantArray(ulRead, rgvarProperty); }
+			}
 
-			finally { if(statstg.lpwstrName) CoTaskMemFree(statstg.lpwstrName); }
+			finally { 
+				
+				for(ULONG index = 0; index < ulRead; index++)
+					if(rgstatstg[index].lpwstrName) CoTaskMemFree(rgstatstg[index].lpwstrName);
+			}
 
-		} // while(pEnumStg->Next
-	} // try
+		} while(hResult == S_OK);
+	}
 
 	finally { pEnumStg->Release(); }			// Make sure this gets released
 
-	return false;								// GUID could not be located
+	// Readers test m_names without the lock, so it has to be published last
+
+	m_guids = guids;
+	m_propids = propids;
+	m_nextPropid = nextPropid;
+	Thread::MemoryBarrier();
+	m_names = names;
+
+	return S_OK;
+}
+
+//---------------------------------------------------------------------------
+// StorageNameMapper::MapGuidInternal (private)
+//
+// Internal version of MapGuidToName.  Looks up the GUID in the index and if
+// it's found, it's corresponding name is returned
+//
+// Arguments:
+//
+//	guid				- GUID to be tested for existance
+//	name				- On success, contains the mapped NAME
+
+bool StorageNameMapper::MapGuidInternal(Guid guid, String^% name)
+{
+	HRESULT					hResult;			// Result from function call
+
+	name = nullptr;								// Initialize [out] variable
+
+	m_storage->Statistics->MapperLookup(1);
+
+	hResult = LoadIndex();
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	return m_guids->TryGetValue(guid, name);
 }
 
 //---------------------------------------------------------------------------
@@ -343,18 +506,45 @@ bool StorageNameMapper::MapGuidInternal(Guid guid, String^% name, PROPID *pPropi
 
 String^ StorageNameMapper::MapGuidToName(Guid guid)
 {
-	lock				cs(SyncRoot);		// Automatic critical section
+	ReadLock			cs(m_lock);			// Automatic read lock
 	String^				name;				// Located mapped name string
 
 	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
 
-	// Use the handy new TryMapGuidToName and just throw the old exception
-	// if we were unable to find the specified GUID in the collection
+	// Use MapGuidInternal and just throw the old exception if we were
+	// unable to find the specified GUID in the collection
 
-	if(TryMapGuidToName(guid, name)) return name;
+	if(MapGuidInternal(guid, name)) return name;
 	else throw gcnew MappingNotFoundException(guid.ToString("D"));
 }
 
+//---------------------------------------------------------------------------
+// StorageNameMapper::MapNameInternal (private)
+//
+// Internal version of TryMapNameToGuid.  Looks up the name in the index and
+// returns the GUID it maps to, if it exists.  Does not acquire the lock
+//
+// Arguments:
+//
+//	name				- Name to be mapped back into a GUID
+//	guid				- On success, contains the located GUID
+
+bool StorageNameMapper::MapNameInternal(String^ name, Guid% guid)
+{
+	HRESULT					hResult;			// Result from function call
+
+	guid = Guid::Empty;							// Initialize [out] reference
+
+	if(name == nullptr) throw gcnew ArgumentNullException();
+
+	m_storage->Statistics->MapperLookup(1);
+
+	hResult = LoadIndex();
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	return m_names->TryGetValue(name, guid);
+}
+
 //---------------------------------------------------------------------------
 // StorageNameMapper::MapNameToGuid
 //
@@ -366,18 +556,58 @@ String^ StorageNameMapper::MapGuidToName(Guid guid)
 
 Guid StorageNameMapper::MapNameToGuid(String^ name)
 {
-	lock				cs(SyncRoot);		// Automatic critical section
+	ReadLock			cs(m_lock);			// Automatic read lock
 	Guid				guid;				// Located mapped GUID value
 
 	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
 
-	// Use the handy new TryMapNameToGuid and just throw the old exception
-	// if we were unable to find the specified GUID in the collection
+	// Use MapNameInternal and just throw the old exception if we were
+	// unable to find the specified NAME in the collection
 
-	if(TryMapNameToGuid(name, guid)) return guid;
+	if(MapNameInternal(name, guid)) return guid;
 	else throw gcnew MappingNotFoundException(name);
 }
 
+//---------------------------------------------------------------------------
+// StorageNameMapper::MapNamesToGuids
+//
+// Maps a set of NAMEs into their GUIDs in one operation.  Names that do not
+// exist in the mapper are not included in the returned dictionary
+//
+// Arguments:
+//
+//	names		- NAMEs to be mapped into their GUIDs
+
+Dictionary<String^, Guid>^ StorageNameMapper::MapNamesToGuids(IEnumerable<String^>^ names)
+{
+	ReadLock				cs(m_lock);			// Automatic read lock
+	List<String^>^			list;				// List of names to be mapped
+	Guid					guid;				// Located mapped GUID value
+	HRESULT					hResult;			// Result from function call
+
+	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
+
+	if(names == nullptr) throw gcnew ArgumentNullException();
+
+	Dictionary<String^, Guid>^ col = gcnew Dictionary<String^, Guid>(StringComparer::OrdinalIgnoreCase);
+
+	list = gcnew List<String^>(names);			// Take a snapshot of the names
+	if(list->Count == 0) return col;			// Nothing to map
+
+	m_storage->Statistics->MapperLookup(list->Count);
+
+	hResult = LoadIndex();
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	for each(String^ name in list) {
+
+		if(name == nullptr) throw gcnew ArgumentNullException();
+		if(m_names->TryGetValue(name, guid)) col[name] = guid;
+	}
+
+	return col;
+}
+
 //---------------------------------------------------------------------------
 // StorageNameMapper::RemoveMapping
 //
@@ -389,7 +619,7 @@ Guid StorageNameMapper::MapNameToGuid(String^ name)
 
 void StorageNameMapper::RemoveMapping(String^ name)
 {
-	lock					cs(SyncRoot);	// Automatic critical section
+	WriteLock				cs(m_lock);		// Automatic write lock
 	IPropertyStorage*		pPropStorage;	// IPropertyStorage interface
 	PROPSPEC				propspec;		// Property specification
 	PinnedStringPtr			pinName;		// Pinned proerty name string
@@ -399,6 +629,9 @@ void StorageNameMapper::RemoveMapping(String^ name)
 
 	if(name == nullptr) throw gcnew ArgumentNullException();
 
+	hResult = LoadIndex();
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
 	hResult = GetPropertyStorage(&pPropStorage);
 	if(FAILED(hResult)) throw gcnew StorageException(hResult);
 
@@ -415,7 +648,9 @@ void StorageNameMapper::RemoveMapping(String^ name)
 	if(FAILED(hResult)) throw gcnew MappingNotFoundException(name);
 
 	hResult = pPropStorage->Commit(STGC_DEFAULT);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	if(FAILED(hResult)) { InvalidateIndex(); throw gcnew StorageException(hResult); }
+
+	RemoveIndexEntry(name);
 }
 
 //---------------------------------------------------------------------------
@@ -429,11 +664,11 @@ void StorageNameMapper::RemoveMapping(String^ name)
 
 void StorageNameMapper::RemoveMapping(Guid guid)
 {
-	lock					cs(SyncRoot);	// Automatic critical section
+	WriteLock				cs(m_lock);		// Automatic write lock
 	IPropertyStorage*		pPropStorage;	// IPropertyStorage interface
 	String^					name;			// GUID->NAME mapping
 	PROPSPEC				propspec;		// Property specification
-	PROPID					propid;			// Property ID code
+	PinnedStringPtr			pinName;		// Pinned property name string
 	HRESULT					hResult;		// Result from function call
 
 	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
@@ -441,29 +676,107 @@ void StorageNameMapper::RemoveMapping(Guid guid)
 	hResult = GetPropertyStorage(&pPropStorage);
 	if(FAILED(hResult)) throw gcnew StorageException(hResult);
 
-	// Use MapGuidInternal to map the GUID into it's property ID.  We don't
-	// care about the name, but we have to get it back by contract here
+	// Use MapGuidInternal to map the GUID into it's name, which can be used
+	// to delete the property just as well as the PROPID could
 
-	if(!MapGuidInternal(guid, name, &propid)) 
+	if(!MapGuidInternal(guid, name)) 
 		throw gcnew MappingNotFoundException(guid.ToString("D"));
 
-	// Use the PROPID value to remove this property from the collection
-
-	propspec.ulKind = PRSPEC_PROPID;
-	propspec.propid = propid;
+	pinName = PtrToStringChars(name);
+	propspec.ulKind = PRSPEC_LPWSTR;
+	propspec.lpwstr = const_cast<LPWSTR>(pinName);
 
 	hResult = pPropStorage->DeleteMultiple(1, &propspec);
 	if(FAILED(hResult)) throw gcnew MappingNotFoundException(guid.ToString("D"));
 
 	hResult = pPropStorage->Commit(STGC_DEFAULT);
+	if(FAILED(hResult)) { InvalidateIndex(); throw gcnew StorageException(hResult); }
+
+	RemoveIndexEntry(name);
+}
+
+//---------------------------------------------------------------------------
+// StorageNameMapper::RemoveIndexEntry (private)
+//
+// Removes a name and the GUID it maps to from the index.  Must be called with
+// the write lock held
+//
+// Arguments:
+//
+//	name			- Name of the mapping to be removed from the index
+
+void StorageNameMapper::RemoveIndexEntry(String^ name)
+{
+	Guid					guid;			// GUID mapped to the name
+
+	if(m_names == nullptr) return;			// Index isn't loaded
+
+	if(m_names->TryGetValue(name, guid)) {
+
+		m_names->Remove(name);
+		m_guids->Remove(guid);
+		m_propids->Remove(guid);
+	}
+}
+
+//---------------------------------------------------------------------------
+// StorageNameMapper::RemoveMappings
+//
+// Deletes a set of mappings from the IStorage property set with a single
+// DeleteMultiple() call and a single Commit().  Names that do not exist in
+// the mapper are ignored
+//
+// Arguments:
+//
+//	names			- Names of the mappings to be removed
+
+void StorageNameMapper::RemoveMappings(IEnumerable<String^>^ names)
+{
+	WriteLock				cs(m_lock);		// Automatic write lock
+	IPropertyStorage*		pPropStorage;	// IPropertyStorage interface
+	List<String^>^			list;			// List of names to be removed
+	PROPSPEC*				rgpropspec;		// Property specifications
+	ULONG					cpspec;			// Number of specifications
+	HRESULT					hResult;		// Result from function call
+
+	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
+
+	if(names == nullptr) throw gcnew ArgumentNullException();
+
+	list = gcnew List<String^>(names);			// Take a snapshot of the names
+	if(list->Count == 0) return;				// Nothing to remove
+
+	hResult = LoadIndex();
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	hResult = GetPropertyStorage(&pPropStorage);
 	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	cpspec = static_cast<ULONG>(list->Count);
+	rgpropspec = AllocNamePropSpecs(list);
+
+	// Deleting by name removes both the property value and the dictionary
+	// entry, so there is no need to resolve the PROPIDs beforehand
+
+	try {
+
+		hResult = pPropStorage->DeleteMultiple(cpspec, rgpropspec);
+		if(FAILED(hResult)) { InvalidateIndex(); throw gcnew StorageException(hResult); }
+	}
+
+	finally { FreeNamePropSpecs(rgpropspec, cpspec); }
+
+	hResult = pPropStorage->Commit(STGC_DEFAULT);
+	if(FAILED(hResult)) { InvalidateIndex(); throw gcnew StorageException(hResult); }
+
+	for each(String^ name in list) RemoveIndexEntry(name);
 }
 
 //---------------------------------------------------------------------------
 // StorageNameMapper::RenameMapping
 //
-// Renames a mapping in this IStorage property set, if possible, by adding
-// a new mapping with the same GUID and then deleting the original one
+// Renames a mapping in this IStorage property set, if possible, by changing
+// the name assigned to the existing property's PROPID
 //
 // Arguments:
 //
@@ -472,9 +785,10 @@ void StorageNameMapper::RemoveMapping(Guid guid)
 
 void StorageNameMapper::RenameMapping(Guid guid, String^ newname)
 {
-	lock						cs(SyncRoot);		// Automatic critical section
+	WriteLock					cs(m_lock);			// Automatic write lock
 	IPropertyStorage*			pPropStorage;		// IPropertyStorage interface
 	String^						name;				// Original property name
+	Guid						existing;			// Existing mapped GUID
 	PinnedStringPtr				pinNewName;			// Pinned version of newname
 	PROPID						propid;				// Property ID code
 	HRESULT						hResult;			// Result from function call
@@ -486,10 +800,10 @@ void StorageNameMapper::RenameMapping(Guid guid, String^ newname)
 	hResult = GetPropertyStorage(&pPropStorage);
 	if(FAILED(hResult)) throw gcnew StorageException(hResult);
 
-	// Use MapGuidInternal to convert the NAME into it's GUID.  Throw if the GUID
+	// Use MapGuidInternal to convert the GUID into it's NAME.  Throw if the GUID
 	// could not be located in this name mapper instance
 
-	if(!MapGuidInternal(guid, name, &propid))
+	if(!MapGuidInternal(guid, name))
 		throw gcnew MappingNotFoundException(guid.ToString("D"));
 
 	pinNewName = PtrToStringChars(newname);					// Pin the new name
@@ -497,18 +811,32 @@ void StorageNameMapper::RenameMapping(Guid guid, String^ newname)
 	// If the name is actually changing, check to make sure it doesn't
 	// already exist before allowing the operation to go through
 
-	if((String::Compare(name, newname, true) != 0) && (ContainsName(newname)))
+	if((String::Compare(name, newname, true) != 0) && (MapNameInternal(newname, existing)))
 		throw gcnew MappingExistsException(newname);
 
+	// The PROPID comes from the index, which MapGuidInternal() just loaded
+
+	if(!m_propids->TryGetValue(guid, propid)) 
+		throw gcnew MappingNotFoundException(guid.ToString("D"));
+
 	// Attempt to rename the property in-place, without removing and re-adding it
 
 	LPOLESTR rgwsz[] = { const_cast<LPOLESTR>(pinNewName) };
 	
-	hResult = pPropStorage->WritePropertyNames(1, &propid, rgwsz);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	try {
 
-	hResult = pPropStorage->Commit(STGC_DEFAULT);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+		hResult = pPropStorage->WritePropertyNames(1, &propid, rgwsz);
+		if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+		hResult = pPropStorage->Commit(STGC_DEFAULT);
+		if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	}
+
+	catch(Exception^) { InvalidateIndex(); throw; }
+
+	RemoveIndexEntry(name);
+	m_names[newname] = guid;
+	m_guids[guid] = newname;
 }
 
 //---------------------------------------------------------------------------
@@ -523,69 +851,66 @@ void StorageNameMapper::RenameMapping(Guid guid, String^ newname)
 
 Dictionary<String^, Guid>^ StorageNameMapper::ToDictionary(void)
 {
-	lock					cs(SyncRoot);		// Automatic critical section
-	IPropertyStorage*		pPropStorage;		// Pointer to IPropertyStorage
-	IEnumSTATPROPSTG*		pEnumStg;			// Storage enumerator
-	STATPROPSTG				statstg;			// Enumerated information
-	ULONG					ulRead;				// Number of items read
-	PROPSPEC				propspec;			// Property specification
-	PROPVARIANT				varProperty;		// VARIANT property value
-	HRESULT					hResult;			// Result from function call
+	ReadLock				cs(m_lock);			// Automatic read lock
 
 	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
 
-	// Construct the local Dictionary<> collection that will hold the enumerated data
+	// The caller gets their own copy of the index; it can't be handed out
+	// directly since it will change underneath them as mappings are modified
 
-	Dictionary<String^, Guid>^ col = gcnew Dictionary<String^, Guid>(StringComparer::OrdinalIgnoreCase);
-
-	hResult = GetPropertyStorage(&pPropStorage);	// Attempt to get prop storage
-	if(FAILED(hResult)) return col;					// Return empty collection on error
-
-	// Attempt to grab the property set enumerator from the PropertyStorage,
-	// and immediately release that since we don't need it anymore
-
-	hResult = pPropStorage->Enum(&pEnumStg);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult);
-
-	try {
-
-		// Enumerate all of the properties currently stuck in here one at a time
-		// to determine the information we're looking for ...
-
-		while(pEnumStg->Next(1, &statstg, &ulRead) == S_OK) {
-
-			try {
+	if(FAILED(LoadIndex())) return gcnew Dictionary<String^, Guid>(StringComparer::OrdinalIgnoreCase);
+	return gcnew Dictionary<String^, Guid>(m_names, StringComparer::OrdinalIgnoreCase);
+}
 
-				propspec.propid = statstg.propid;		// Set the property ID
-				propspec.ulKind = PRSPEC_PROPID;		// Using the ID code
+//---------------------------------------------------------------------------
+// StorageNameMapper::ToGuidArray
+//
+// Copies all of the mapped GUIDs into a single array.  Callers that only need
+// the GUIDs should use this rather than ToDictionary(), which has to rebuild
+// an entire hash table; for large containers that's a lot of garbage
+//
+// Arguments:
+//
+//	NONE
 
-				// Read information about the enumerated property and test to see if
-				// it's name happens to match the one passed in by the caller
+array<Guid>^ StorageNameMapper::ToGuidArray(void)
+{
+	ReadLock				cs(m_lock);			// Automatic read lock
+	array<Guid>^			guids;				// Array of mapped GUIDs
 
-				hResult = pPropStorage->ReadMultiple(1, &propspec, &varProperty);
-				if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
 
-				try { 
+	if(FAILED(LoadIndex())) return gcnew array<Guid>(0);
 
-					if(varProperty.vt != VT_CLSID) continue;	// Should never happen
+	guids = gcnew array<Guid>(m_guids->Count);
+	m_guids->Keys->CopyTo(guids, 0);
 
-					// Insert the enumerated name and GUID into the local collection
-					
-					col->Add(gcnew String(statstg.lpwstrName), StorageUtil::UUIDToSysGuid(*varProperty.puuid));
-				}
+	return guids;
+}
 
-				finally { PropVariantClear(&varProperty); }
+//---------------------------------------------------------------------------
+// StorageNameMapper::ToNameArray
+//
+// Copies all of the mapped NAMEs into a single array.  Callers that only need
+// the NAMEs should use this rather than ToDictionary()
+//
+// Arguments:
+//
+//	NONE
 
-			}
+array<String^>^ StorageNameMapper::ToNameArray(void)
+{
+	ReadLock				cs(m_lock);			// Automatic read lock
+	array<String^>^			names;				// Array of mapped NAMEs
 
-			finally { if(statstg.lpwstrName) CoTaskMemFree(statstg.lpwstrName); }
+	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
 
-		} // while(pEnumStg->Next
-	} // try
+	if(FAILED(LoadIndex())) return gcnew array<String^>(0);
 
-	finally { pEnumStg->Release(); }			// Make sure this gets released
+	names = gcnew array<String^>(m_names->Count);
+	m_names->Keys->CopyTo(names, 0);
 
-	return col;								// Return the generated list
+	return names;
 }
 
 //---------------------------------------------------------------------------
@@ -600,11 +925,11 @@ Dictionary<String^, Guid>^ StorageNameMapper::ToDictionary(void)
 
 bool StorageNameMapper::TryMapGuidToName(Guid guid, String^% name)
 {
-	lock				cs(SyncRoot);		// Automatic critical section
+	ReadLock			cs(m_lock);			// Automatic read lock
 
 	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
 
-	return MapGuidInternal(guid, name, NULL);	// Use MapGuidInternal
+	return MapGuidInternal(guid, name);		// Use MapGuidInternal
 }
 
 //---------------------------------------------------------------------------
@@ -619,45 +944,13 @@ bool StorageNameMapper::TryMapGuidToName(Guid guid, String^% name)
 
 bool StorageNameMapper::TryMapNameToGuid(String^ name, Guid% guid)
 {
-	lock					cs(SyncRoot);		// Automatic critical section
-	IPropertyStorage*		pPropStorage;		// IPropertyStorage interface
-	PinnedStringPtr			pinName;			// Pinned string pointer
-	PROPSPEC				propspec;			// Property specification
-	PROPVARIANT				varProperty;		// VARIANT property value
-	HRESULT					hResult;			// Result from function call
+	ReadLock				cs(m_lock);			// Automatic read lock
 
 	guid = Guid::Empty;							// Initialize [out] reference
 	
 	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
 
-	if(name == nullptr) throw gcnew ArgumentNullException();
-
-	hResult = GetPropertyStorage(&pPropStorage);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult);
-
-	// Convert the property name into an unmanaged Unicode string and set
-	// up the values in the PROPSPEC structure appropriately
-
-	pinName = PtrToStringChars(name);
-	propspec.ulKind = PRSPEC_LPWSTR;
-	propspec.lpwstr = const_cast<LPWSTR>(pinName);
-
-	hResult = pPropStorage->ReadMultiple(1, &propspec, &varProperty);
-	if(FAILED(hResult)) return false;
-
-	try { 
-		
-		// If the property isn't VT_CLSID (which it won't be if the property
-		// didn't exist and ReadMultiple came back with S_FALSE), convert it
-		// back into a GUID and return it to the caller
-
-		if(varProperty.vt != VT_CLSID) return false;
-		guid = StorageUtil::UUIDToSysGuid(*varProperty.puuid);
-	}
-
-	finally { PropVariantClear(&varProperty); }		// Release variant data
-
-	return true;				// NAME was mapped into a GUID value
+	return MapNameInternal(name, guid);			// Use MapNameInternal
 }
 
 //---------------------------------------------------------------------------
@@ -665,4 +958,3 @@ bool StorageNameMapper::TryMapNameToGuid(String^ name, Guid% guid)
 END_ROOT_NAMESPACE(zuki::storage)
 
 #pragma warning(pop)
-
@@ -24,6 +24,7 @@
 #define __STORAGENAMEMAPPER_H_
 #pragma once
 
+#include "ReadWriteLock.h"				// Include ReadLock/WriteLock decls
 #include "StorageException.h"			// Include StorageException decls
 #include "StorageExceptions.h"			// Include StorageExceptions decls
 #include "StorageUtil.h"				// Include StorageUtil declarations
@@ -32,6 +33,8 @@
 
 using namespace System;
 using namespace System::Collections::Generic;
+using namespace System::Runtime::InteropServices;
+using namespace System::Threading;
 using namespace msclr;
 
 BEGIN_ROOT_NAMESPACE(zuki::storage)
@@ -61,6 +64,15 @@ ref class ComStorage;							// ComStorage.h
 // This is a replacement for the original "NameMapper" class.  It's now
 // an instance-based class rather than completely static, is thread-safe,
 // and works with the new ComXXXX smart pointers instead of raw pointers.
+//
+// Lookups only take a shared read lock, so any number of threads can map
+// names concurrently; only the operations that modify the underlying
+// property set need to take the exclusive write lock.
+//
+// The property set remains the on-disk format, but it's only read once: the
+// first lookup loads every mapping into an in-memory NAME<->GUID index and
+// all lookups after that are hash table probes in either direction.  The
+// mutators update the index along with the property set.
 //---------------------------------------------------------------------------
 
 ref class StorageNameMapper sealed
@@ -100,12 +112,22 @@ public:
 	// Maps a NAME into it's GUID representation
 	Guid MapNameToGuid(String^ name);
 
+	// MapNamesToGuids
+	//
+	// Maps a set of NAMEs into their GUID representations in one operation
+	Dictionary<String^, Guid>^ MapNamesToGuids(IEnumerable<String^>^ names);
+
 	// RemoveMapping
 	//
 	// Removes a mapping from the collection
 	void RemoveMapping(String^ name);
 	void RemoveMapping(Guid guid);
 
+	// RemoveMappings
+	//
+	// Removes a set of mappings from the collection in one operation
+	void RemoveMappings(IEnumerable<String^>^ names);
+
 	// RenameMapping
 	//
 	// Renames a mapping in the collection
@@ -116,6 +138,16 @@ public:
 	// Converts the entire collection into a Dictionary<String^, Guid> instance
 	Dictionary<String^, Guid>^ ToDictionary(void);
 
+	// ToGuidArray
+	//
+	// Copies all of the mapped GUIDs into a single array
+	array<Guid>^ ToGuidArray(void);
+
+	// ToNameArray
+	//
+	// Copies all of the mapped NAMEs into a single array
+	array<String^>^ ToNameArray(void);
+
 	// TryMapGuidToName
 	//
 	// Tries to map a GUID to a NAME without throwing an exception
@@ -137,18 +169,10 @@ public:
 		int get(void);
 	}
 
-	// SyncRoot
-	//
-	// Provides an object that can be used for synchronization
-	property Object^ SyncRoot
-	{
-		Object^ get(void) { return this; }
-	}
-	
 private:
 
 	// DESTRUCTOR / FINALIZER
-	~StorageNameMapper() { this->!StorageNameMapper(); m_disposed = true; }
+	~StorageNameMapper();
 	!StorageNameMapper();
 
 	//-----------------------------------------------------------------------
@@ -159,18 +183,53 @@ private:
 	// Used as the base property ID code for sets defined by the mapper
 	literal int NAMEMAPPER_BASEID = 255;
 
+	// INDEX_BATCHSIZE
+	//
+	// Number of properties enumerated and read at a time by LoadIndex
+	literal int INDEX_BATCHSIZE = 64;
+
 	//-----------------------------------------------------------------------
 	// Private Member Functions
 
+	// AllocNamePropSpecs (static)
+	//
+	// Allocates an unmanaged array of PRSPEC_LPWSTR PROPSPEC structures
+	static PROPSPEC* AllocNamePropSpecs(List<String^>^ names);
+
+	// FreeNamePropSpecs (static)
+	//
+	// Releases an array allocated with AllocNamePropSpecs
+	static void FreeNamePropSpecs(PROPSPEC* rgpropspec, ULONG cpspec);
+
 	// GetPropStorage
 	//
 	// Instantiates and returns the contained IPropertyStorage
 	HRESULT GetPropertyStorage(IPropertyStorage** ppPropStorage);
 
+	// InvalidateIndex
+	//
+	// Discards the in-memory index so that it gets reloaded on next access
+	void InvalidateIndex(void);
+
+	// LoadIndex
+	//
+	// Loads the in-memory NAME<->GUID<->PROPID index from the property set
+	HRESULT LoadIndex(void);
+
 	// MapGuidInternal
 	//
 	// Internal version of a GUID->NAME mapper
-	bool MapGuidInternal(Guid guid, String^% name, PROPID *pPropid);
+	bool MapGuidInternal(Guid guid, String^% name);
+
+	// MapNameInternal
+	//
+	// Internal version of a NAME->GUID mapper
+	bool MapNameInternal(String^ name, Guid% guid);
+
+	// RemoveIndexEntry
+	//
+	// Removes a name and the GUID it maps to from the index
+	void RemoveIndexEntry(String^ name);
 
 	//-----------------------------------------------------------------------
 	// Member Variables
@@ -179,6 +238,12 @@ private:
 	bool						m_disposed;			// Object disposal flag
 	ComStorage^					m_storage;			// Referenced ComStorage
 	IPropertyStorage*			m_pPropStorage;		// Contained IPropertyStorage
+	initonly ReaderWriterLockSlim^	m_lock;			// Mapper reader/writer lock
+	initonly Object^			m_initLock;			// GetPropertyStorage lock
+	Dictionary<String^, Guid>^	m_names;			// NAME->GUID index
+	Dictionary<Guid, String^>^	m_guids;			// GUID->NAME index
+	Dictionary<Guid, PROPID>^	m_propids;			// GUID->PROPID index
+	PROPID						m_nextPropid;		// Next unused PROPID
 };
 
 //---------------------------------------------------------------------------
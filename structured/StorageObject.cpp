@@ -48,8 +48,8 @@ StorageObject::StorageObject(StructuredStorage^ root, ComStorage^ parent,
 	// Get the read-only flag as well as the GUID associated with this
 	// particular object stream ...
 
-	m_readOnly = StorageUtil::IsStreamReadOnly(m_stream);
-	m_objid = StorageUtil::GetObjectID(m_stream);
+	m_readOnly = m_stream->ReadOnly;
+	m_objid = m_stream->ObjectID;
 }
 
 //---------------------------------------------------------------------------
@@ -144,7 +144,86 @@ StorageObjectReader^ StorageObject::GetReader(void)
 StorageObjectWriter^ StorageObject::GetWriter(void)
 {
 	CHECK_DISPOSED(m_stream->IsDisposed());
-	return gcnew StorageObjectWriter(m_stream);
+	return gcnew StorageObjectWriter(m_stream, m_parent->ChangeTracker);
+}
+
+//---------------------------------------------------------------------------
+// StorageObject::LastModified::get
+//
+// Gets the last time (UTC) the object was modified, or null if that isn't
+// known.  Objects that were never modified through this library aren't
+// tracked at all
+
+Nullable<DateTime> StorageObject::LastModified::get(void)
+{
+	DateTime				time;				// Recorded modification time
+
+	CHECK_DISPOSED(m_stream->IsDisposed());
+
+	if(m_parent->ChangeTracker->TryGetTime(m_objid, time)) return Nullable<DateTime>(time);
+	return Nullable<DateTime>();
+}
+
+//---------------------------------------------------------------------------
+// StorageObject::Read
+//
+// Reads a range of bytes from the object stream at the specified position.
+// Each call reads through it's own clone of the stream, so nothing is shared
+// with any other reader or writer, including other calls to Read()
+//
+// Arguments:
+//
+//	position	- Position in the object stream to start reading from
+//	buffer		- Buffer to copy the data into
+//	offset		- Offset into the buffer to start writing the data
+//	count		- Maximum number of bytes to write into the buffer
+
+int StorageObject::Read(__int64 position, array<Byte>^ buffer, int offset, int count)
+{
+	ComStream^			clone;					// Cloned stream instance
+	LARGE_INTEGER		liOffset;				// Offset as a LARGE_INTEGER
+	PinnedBytePtr		pinBuffer;				// Pinned buffer pointer
+	ULONG				cbRead;					// Number of bytes read
+	int					total = 0;				// Total number of bytes read
+	HRESULT				hResult;				// Result from function call
+
+	CHECK_DISPOSED(m_stream->IsDisposed());
+
+	if(buffer == nullptr) throw gcnew ArgumentNullException();
+	if(position < 0) throw gcnew ArgumentOutOfRangeException("Position cannot be a negative value");
+	if(offset < 0) throw gcnew ArgumentOutOfRangeException("Offset cannot be a negative value");
+	if(count < 0) throw gcnew ArgumentOutOfRangeException("Count cannot be a negative value");
+	if(buffer->Length - offset < count) throw gcnew ArgumentException();
+
+	if(count == 0) return 0;				// Nothing to do
+
+	hResult = m_stream->CreateClone(clone);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	try {
+
+		liOffset.QuadPart = position;
+		hResult = clone->Seek(liOffset, STREAM_SEEK_SET, NULL);
+		if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+		pinBuffer = &buffer[offset];		// Pin the byte array
+
+		// IStream::Read() is allowed to come back short, so keep going until
+		// the requested range has been filled or the end of stream is hit
+
+		while(total < count) {
+
+			hResult = clone->Read(pinBuffer + total, static_cast<ULONG>(count - total), &cbRead);
+			if(FAILED(hResult)) throw gcnew StorageException(hResult);
+			if(cbRead == 0) break;
+
+			total += static_cast<int>(cbRead);
+		}
+	}
+
+	finally { delete clone; }				// Release the clone right away
+
+	return total;							// Return number of bytes read
 }
 
 //---------------------------------------------------------------------------
@@ -165,12 +244,17 @@ String^ StorageObject::Name::get(void)
 
 void StorageObject::Name::set(String^ value)
 {
+	HRESULT					hResult;			// Result from function call
+
 	CHECK_DISPOSED(m_stream->IsDisposed());
 
 	if(value == nullptr) throw gcnew ArgumentNullException();
 	if(m_readOnly) throw gcnew ObjectReadOnlyException();
 	
 	m_parent->ObjectNameMapper->RenameMapping(m_objid, value);
+
+	hResult = m_parent->ChangeTracker->Touch(m_objid);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
 }
 
 //---------------------------------------------------------------------------
@@ -68,6 +68,11 @@ public:
 	StorageObjectReader^	GetReader(void);
 	StorageObjectWriter^	GetWriter(void);
 
+	// Read is a positional read with it's own seek pointer; any number of
+	// threads can call it at the same time against different ranges
+
+	int						Read(__int64 position, array<Byte>^ buffer, int offset, int count);
+
 	//-----------------------------------------------------------------------
 	// Properties
 
@@ -77,6 +82,11 @@ public:
 		void set(array<Byte>^ value);
 	}
 
+	property Nullable<DateTime> LastModified
+	{
+		Nullable<DateTime> get(void);
+	}
+
 	property String^ Name
 	{
 		String^ get(void);
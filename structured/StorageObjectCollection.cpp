@@ -43,7 +43,7 @@ StorageObjectCollection::StorageObjectCollection(StructuredStorage^ root,
 	if(m_root == nullptr) throw gcnew ArgumentNullException();	
 	if(m_storage == nullptr) throw gcnew ArgumentNullException();
 
-	m_readOnly = StorageUtil::IsStorageReadOnly(m_storage);
+	m_readOnly = m_storage->ReadOnly;
 }
 
 //---------------------------------------------------------------------------
@@ -58,8 +58,7 @@ StorageObjectCollection::StorageObjectCollection(StructuredStorage^ root,
 StorageObject^ StorageObjectCollection::Add(String^ name)
 {
 	Guid					objid;				// Object ID guid
-	String^					objname;			// Object BASE64 name
-	PinnedStringPtr			pinName;			// Pinned object name
+	GUIDNAME				objname;			// Object BASE64 name
 	ComStream^				stream;				// New ComStream instance
 	IStream*				pStream;			// New object IStream
 	HRESULT					hResult;			// Result from function call
@@ -73,29 +72,33 @@ StorageObject^ StorageObjectCollection::Add(String^ name)
 	if(m_storage->ObjectNameMapper->ContainsName(name)) throw gcnew ObjectExistsException(name);
 
 	objid = Guid::NewGuid();							// Generate a new object GUID
-	objname = StorageUtil::SysGuidToBase64(objid);		// Convert into BASE64
-	pinName = PtrToStringChars(objname);				// Pin it down in memory
+	StorageUtil::SysGuidToBase64(objid, objname);		// Convert into BASE64
 
 	// Attempt to physically create the new object stream, and if successful
 	// add it's name and GUID to the name mapper as well
 
-	hResult = m_storage->CreateStream(pinName, StorageUtil::GetStorageMode(m_storage), 
+	hResult = m_storage->CreateStream(objname, m_storage->ChildMode, 
 		0, 0, &pStream);
 	if(FAILED(hResult)) throw gcnew StorageException(hResult, name);
 
 	// Create the IStorage wrapper and release the raw pointer.  If something
 	// goes wrong from here, it will release itself automatically on finalization
 
-	stream = gcnew ComStream(pStream);
+	stream = gcnew ComStream(pStream, m_storage->Statistics, m_root->StreamCacheSize);
 	pStream->Release();
 
 	// Attempt to add the new pointer wrapper into the cache, and be sure to delete
 	// the newly created sub container on exception since it will be orphaned
 
 	try { m_root->ComStreamCache->Add(objid, stream); }
-	catch(Exception^) { m_storage->DestroyElement(pinName); throw; }
+	catch(Exception^) { m_storage->DestroyElement(objname); throw; }
 
 	m_storage->ObjectNameMapper->AddMapping(name, objid);
+
+	// A new object without a modification time just looks modified, so there's
+	// no need to fail the whole operation if it can't be recorded
+
+	m_storage->ChangeTracker->Touch(objid);
 	return gcnew StorageObject(m_root, m_storage, stream);
 }
 
@@ -110,33 +113,14 @@ StorageObject^ StorageObjectCollection::Add(String^ name)
 
 void StorageObjectCollection::Clear(void)
 {
-	PinnedStringPtr			pinObjName;		// Pinned object name
-	HRESULT					hResult;		// Result from function call
-
 	CHECK_DISPOSED(m_storage->IsDisposed());
 	if(m_readOnly) throw gcnew ContainerReadOnlyException();
 
-	// The NameMapper has a handy ToList() function that essentially enumerates
-	// all of the objects we placed into this container, so that should suffice.
-	// Without it, we would still have to ask it to look up GUIDs which ends
-	// up doing all kinds of enumerations anyway.  This is just better overall.
-
-	for each(KeyValuePair<String^, Guid> item in m_storage->ObjectNameMapper->ToDictionary()) {
-
-		// The physical IStream is the GUID base64 encoded. The "name" from
-		// the name mapper has no bearing on this operation whatsoever
+	// The NameMapper has a handy ToDictionary() function that enumerates all
+	// of the objects we placed into this container in a single pass, which
+	// is all that RemoveObjects() needs to do the rest in bulk
 
-		pinObjName = PtrToStringChars(StorageUtil::SysGuidToBase64(item.Value));
-		
-		// First try to physically remove the object stream from storage
-
-		hResult = m_storage->DestroyElement(pinObjName);
-		if(FAILED(hResult)) throw gcnew StorageException(hResult);
-
-		// Remove the mapping from the container's property set mapper
-
-		m_storage->ObjectNameMapper->RemoveMapping(item.Value);
-	}
+	RemoveObjects(m_storage->ObjectNameMapper->ToDictionary());
 }
 
 //---------------------------------------------------------------------------
@@ -269,42 +253,38 @@ StorageObject^ StorageObjectCollection::default::get(int index)
 
 StorageObject^ StorageObjectCollection::default::get(Guid objid)
 {
-	String^					objname;			// Object BASE64 name
-	PinnedStringPtr			pinName;			// Pinned object name
-	ComStream^				stream;				// Object ComStream instance
-	IStream*				pStream;			// Object IStream
-	HRESULT					hResult;			// Result from function call
-
 	CHECK_DISPOSED(m_storage->IsDisposed());
+	return gcnew StorageObject(m_root, m_storage, OpenComStream(objid));
+}
 
-	objname = StorageUtil::SysGuidToBase64(objid);			// Convert into BASE64
-	pinName = PtrToStringChars(objname);					// Pin it down in memory
-
-	lock cacheLock(m_root->ComStreamCache->SyncRoot);		// <--- THREAD SAFETY
-
-	// If an instance of this object already exists somewhere, we
-	// can get a copy of that pointer and just wrap with a new class
-
-	if(m_root->ComStreamCache->TryGetValue(objid, stream))
-		return gcnew StorageObject(m_root, m_storage, stream);
-
-	// This object hasn't been cached, so we need to actually open it up
+//---------------------------------------------------------------------------
+// StorageObjectCollection::GetChangedSince
+//
+// Gets all of the object streams in this container that have been modified
+// since the specified time.  Objects that have no recorded modification time
+// are always included.  A time with an Unspecified kind is taken to be local
+// time, the same way DateTime::ToUniversalTime() treats it
+//
+// Arguments:
+//
+//	since		- Point in time to look for changes after
 
-	hResult = m_storage->OpenStream(pinName, NULL, 
-		StorageUtil::GetStorageChildOpenMode(m_storage), 0, &pStream);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+List<StorageObject^>^ StorageObjectCollection::GetChangedSince(DateTime since)
+{
+	Dictionary<Guid, DateTime>^	times;			// Recorded modification times
+	DateTime					modified;		// Modification time of an object
+	List<StorageObject^>^		changed;		// Modified objects
 
-	// Wrap the new IStream pointer up, and release our local reference
-	// to it.  The ComStream instance maintains it from here on
+	CHECK_DISPOSED(m_storage->IsDisposed());
 
-	stream = gcnew ComStream(pStream);
-	pStream->Release();
+	since = since.ToUniversalTime();
+	times = m_storage->ChangeTracker->ToDictionary();
+	changed = gcnew List<StorageObject^>();
 
-	// Insert the new pointer wrapper into cache (hence the lock), and
-	// return a brand new StorageContainer back to the caller
+	for each(Guid objid in m_storage->ObjectNameMapper->ToGuidArray())
+		if(!times->TryGetValue(objid, modified) || (modified >= since)) changed->Add(this[objid]);
 
-	m_root->ComStreamCache->Add(objid, stream);
-	return gcnew StorageObject(m_root, m_storage, stream);
+	return changed;
 }
 
 //---------------------------------------------------------------------------
@@ -360,7 +340,7 @@ String^ StorageObjectCollection::LookupIndex(int index)
 				// Convert the BASE64 string back into a GUID, and if we
 				// end up with Guid::Empty (error), skip this item
 
-				objid = StorageUtil::Base64ToSysGuid(gcnew String(statstg.pwcsName));
+				objid = StorageUtil::Base64ToSysGuid(statstg.pwcsName);
 				if(objid == Guid::Empty) continue;
 
 				// Attempt to look up the name for this object, and if it
@@ -384,6 +364,183 @@ String^ StorageObjectCollection::LookupIndex(int index)
 	finally { pEnumStg->Release(); }			// Always release interface
 }
 
+//---------------------------------------------------------------------------
+// StorageObjectCollection::OpenComStream (private)
+//
+// Gets the ComStream for an object, either from the root cache or by opening
+// the underlying IStream and adding it to the root cache
+//
+// Arguments:
+//
+//	objid		- GUID of the object stream to be opened
+
+ComStream^ StorageObjectCollection::OpenComStream(Guid objid)
+{
+	GUIDNAME				objname;			// Object BASE64 name
+	ComStream^				stream;				// Object ComStream instance
+	IStream*				pStream;			// Object IStream
+	HRESULT					hResult;			// Result from function call
+
+	StorageUtil::SysGuidToBase64(objid, objname);			// Convert into BASE64
+
+	lock cacheLock(m_root->ComStreamCache->SyncRoot);		// <--- THREAD SAFETY
+
+	// If an instance of this object already exists somewhere, we
+	// can just share that pointer rather than opening it again
+
+	if(m_root->ComStreamCache->TryGetValue(objid, stream)) return stream;
+
+	// This object hasn't been cached, so we need to actually open it up
+
+	hResult = m_storage->OpenStream(objname, NULL, 
+		m_storage->ChildMode, 0, &pStream);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	// Wrap the new IStream pointer up, and release our local reference
+	// to it.  The ComStream instance maintains it from here on
+
+	stream = gcnew ComStream(pStream, m_storage->Statistics, m_root->StreamCacheSize);
+	pStream->Release();
+
+	// Insert the new pointer wrapper into cache (hence the lock)
+
+	m_root->ComStreamCache->Add(objid, stream);
+	return stream;
+}
+
+//---------------------------------------------------------------------------
+// StorageObjectCollection::ReadMany
+//
+// Reads the entire contents of a set of object streams.  All of the names are
+// resolved with a single name mapper operation, and each object is read with
+// one Stat() and one Read() against a clone of it's stream, without creating
+// any of the StorageObject or StorageObjectReader instances in between
+//
+// Arguments:
+//
+//	names		- Names of the object streams to be read
+
+Dictionary<String^, array<Byte>^>^ StorageObjectCollection::ReadMany(IEnumerable<String^>^ names)
+{
+	array<Byte>^			data;				// Object stream contents
+
+	CHECK_DISPOSED(m_storage->IsDisposed());
+	if(names == nullptr) throw gcnew ArgumentNullException();
+
+	// Names that don't exist in the collection are silently left out of the
+	// result, the caller can tell which ones were missing from the keys
+
+	Dictionary<String^, Guid>^ objects = m_storage->ObjectNameMapper->MapNamesToGuids(names);
+	Dictionary<String^, array<Byte>^>^ result = gcnew Dictionary<String^, array<Byte>^>(objects->Count, 
+		StringComparer::OrdinalIgnoreCase);
+
+	for each(KeyValuePair<String^, Guid> item in objects) {
+
+		data = nullptr;
+		ReadObject(item.Value, data, true);
+		result->Add(item.Key, data);
+	}
+
+	return result;
+}
+
+//---------------------------------------------------------------------------
+// StorageObjectCollection::ReadMany
+//
+// Reads the entire contents of a set of object streams into a single buffer
+// that gets reused for every object, and passes each one to a callback.  The
+// buffer only ever grows to fit the largest object, so this will not allocate
+// anything per object.  The callback must not hang onto the buffer, it will
+// be overwritten by the next object
+//
+// Arguments:
+//
+//	names		- Names of the object streams to be read
+//	callback	- Invoked with the name, buffer and length of each object
+
+int StorageObjectCollection::ReadMany(IEnumerable<String^>^ names, Action<String^, array<Byte>^, int>^ callback)
+{
+	array<Byte>^			buffer = nullptr;	// Shared object buffer
+	int						length;				// Length of one object
+
+	CHECK_DISPOSED(m_storage->IsDisposed());
+	if(names == nullptr) throw gcnew ArgumentNullException();
+	if(callback == nullptr) throw gcnew ArgumentNullException();
+
+	Dictionary<String^, Guid>^ objects = m_storage->ObjectNameMapper->MapNamesToGuids(names);
+
+	for each(KeyValuePair<String^, Guid> item in objects) {
+
+		length = ReadObject(item.Value, buffer, false);
+		callback(item.Key, buffer, length);
+	}
+
+	return objects->Count;
+}
+
+//---------------------------------------------------------------------------
+// StorageObjectCollection::ReadObject (private)
+//
+// Reads the entire contents of an object stream into a buffer, growing the
+// buffer if it isn't big enough.  A clone of the stream is used so that the
+// seek pointer of the cached stream, and any open readers, is left alone.  If
+// the stream turns out to be shorter than it said it was, an exact buffer is
+// trimmed to what was actually read
+//
+// Arguments:
+//
+//	objid		- GUID of the object stream to be read
+//	buffer		- Buffer to read into; replaced if it is too small
+//	exact		- Flag to allocate a buffer of exactly the object length
+
+int StorageObjectCollection::ReadObject(Guid objid, array<Byte>^% buffer, bool exact)
+{
+	ComStream^				clone;				// Cloned stream instance
+	STATSTG					statstg;			// Stream statistics
+	int						length;				// Length of the object
+	PinnedBytePtr			pinBuffer;			// Pinned buffer pointer
+	ULONG					cbRead;				// Bytes read from the stream
+	int						total = 0;			// Total bytes read
+	HRESULT					hResult;			// Result from function call
+
+	hResult = OpenComStream(objid)->CreateClone(clone);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	try {
+
+		hResult = clone->Stat(&statstg, STATFLAG_NONAME);
+		if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+		if(statstg.cbSize.QuadPart > Int32::MaxValue) throw gcnew ObjectTooLargeException();
+		length = static_cast<int>(statstg.cbSize.QuadPart);
+
+		if((buffer == nullptr) || (buffer->Length < length) || (exact && (buffer->Length != length)))
+			buffer = gcnew array<Byte>(length);
+
+		if(length == 0) return 0;
+
+		// CreateClone() has already put the seek pointer at the beginning of
+		// the stream.  IStream::Read() is allowed to come back short, so keep
+		// going until the whole object has been read or the end is hit
+
+		pinBuffer = &buffer[0];
+
+		while(total < length) {
+
+			hResult = clone->Read(pinBuffer + total, static_cast<ULONG>(length - total), &cbRead);
+			if(FAILED(hResult)) throw gcnew StorageException(hResult);
+			if(cbRead == 0) break;
+
+			total += static_cast<int>(cbRead);
+		}
+	}
+
+	finally { delete clone; }
+
+	if(exact && (total < length)) Array::Resize(buffer, total);
+	return total;
+}
+
 //---------------------------------------------------------------------------
 // StorageObjectCollection::Remove
 //
@@ -396,8 +553,7 @@ String^ StorageObjectCollection::LookupIndex(int index)
 bool StorageObjectCollection::Remove(String^ name)
 {
 	Guid					objid;			// Object ID guid
-	String^					objname;		// Object BASE64 name
-	PinnedStringPtr			pinName;		// Pinned object name
+	GUIDNAME				objname;		// Object BASE64 name
 	HRESULT					hResult;		// Result from function call
 
 	CHECK_DISPOSED(m_storage->IsDisposed());
@@ -408,19 +564,107 @@ bool StorageObjectCollection::Remove(String^ name)
 
 	if(!m_storage->ObjectNameMapper->TryMapNameToGuid(name, objid)) return false;
 
-	objname = StorageUtil::SysGuidToBase64(objid);		// Convert into BASE64
-	pinName = PtrToStringChars(objname);				// Pin it down in memory
+	StorageUtil::SysGuidToBase64(objid, objname);		// Convert into BASE64
 
 	// Attempt to physically delete the object from this container,
 	// and if successful remove it from cache and the name mapper
 
-	hResult = m_storage->DestroyElement(pinName);
+	hResult = m_storage->DestroyElement(objname);
 	if(FAILED(hResult)) throw gcnew StorageException(hResult, name);
 
 	m_storage->ObjectNameMapper->RemoveMapping(name);		// Remove mapping
+
+	hResult = m_storage->ChangeTracker->Forget(objid);		// Forget mod time
+	if(FAILED(hResult)) throw gcnew StorageException(hResult, name);
+
 	return true;											// Success
 }
 
+//---------------------------------------------------------------------------
+// StorageObjectCollection::RemoveObjects (private)
+//
+// Physically deletes a set of object streams and then removes all of their
+// mappings from the name mapper with a single operation
+//
+// Arguments:
+//
+//	objects		- NAME->GUID dictionary of the objects to be deleted
+
+int StorageObjectCollection::RemoveObjects(Dictionary<String^, Guid>^ objects)
+{
+	List<String^>^			removed;			// Successfully removed names
+	List<Guid>^				removedIds;			// Successfully removed GUIDs
+	GUIDNAME				objname;			// Object name
+	HRESULT					hResult;			// Result from function call
+
+	removed = gcnew List<String^>(objects->Count);
+	removedIds = gcnew List<Guid>(objects->Count);
+
+	try {
+
+		for each(KeyValuePair<String^, Guid> item in objects) {
+
+			// The physical IStream is the GUID base64 encoded. The "name" from
+			// the name mapper has no bearing on this operation whatsoever
+
+			StorageUtil::SysGuidToBase64(item.Value, objname);
+
+			hResult = m_storage->DestroyElement(objname);
+			if(FAILED(hResult)) throw gcnew StorageException(hResult, item.Key);
+
+			removed->Add(item.Key);
+			removedIds->Add(item.Value);
+		}
+	}
+
+	// Whatever happens, the mappings for any object streams that were actually
+	// destroyed need to be removed so they don't end up orphaned in the mapper,
+	// but a failure doing that can't be allowed to hide the original exception
+
+	catch(Exception^) {
+
+		try {
+
+			m_storage->ObjectNameMapper->RemoveMappings(removed);
+			m_storage->ChangeTracker->Forget(removedIds);
+		}
+
+		catch(Exception^) { /* DO NOTHING */ }
+
+		throw;
+	}
+
+	m_storage->ObjectNameMapper->RemoveMappings(removed);
+
+	hResult = m_storage->ChangeTracker->Forget(removedIds);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	return removed->Count;
+}
+
+//---------------------------------------------------------------------------
+// StorageObjectCollection::RemoveRange
+//
+// Deletes a set of object streams.  All of the names are resolved with a
+// single name mapper operation, and all of the mappings are removed with a
+// single name mapper operation rather than doing each object individually
+//
+// Arguments:
+//
+//	names		- Names of the object streams to be deleted
+
+int StorageObjectCollection::RemoveRange(IEnumerable<String^>^ names)
+{
+	CHECK_DISPOSED(m_storage->IsDisposed());
+	if(names == nullptr) throw gcnew ArgumentNullException();
+	if(m_readOnly) throw gcnew ContainerReadOnlyException();
+
+	// Names that don't exist in the collection are silently ignored, the same
+	// way that Remove() just returns false for them
+
+	return RemoveObjects(m_storage->ObjectNameMapper->MapNamesToGuids(names));
+}
+
 //---------------------------------------------------------------------------
 // StorageObjectCollection::Remove (private)
 //
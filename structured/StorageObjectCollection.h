@@ -77,6 +77,14 @@ public:
 	virtual property int  Count { int get(void); }
 	virtual property bool IsReadOnly { bool get(void) { return m_readOnly; } }
 
+	//-----------------------------------------------------------------------
+	// Member Functions
+
+	List<StorageObject^>^	GetChangedSince(DateTime since);
+	Dictionary<String^, array<Byte>^>^ ReadMany(IEnumerable<String^>^ names);
+	int						ReadMany(IEnumerable<String^>^ names, Action<String^, array<Byte>^, int>^ callback);
+	int						RemoveRange(IEnumerable<String^>^ names);
+
 	//-----------------------------------------------------------------------
 	// Properties
 
@@ -112,7 +120,10 @@ private:
 	//-----------------------------------------------------------------------
 	// Private Member Functions
 
-	String^	LookupIndex(int index);
+	String^		LookupIndex(int index);
+	ComStream^	OpenComStream(Guid objid);
+	int			ReadObject(Guid objid, array<Byte>^% buffer, bool exact);
+	int			RemoveObjects(Dictionary<String^, Guid>^ objects);
 
 	// ICollection<T>::Add
 	virtual void Add(StorageObject^) sealed =
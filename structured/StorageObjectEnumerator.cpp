@@ -40,8 +40,6 @@ BEGIN_ROOT_NAMESPACE(zuki::storage)
 StorageObjectEnumerator::StorageObjectEnumerator(StructuredStorage^ root, 
 	ComStorage^ storage) : m_root(root), m_storage(storage), m_current(-1)
 {
-	Generic::ICollection<Guid>^		guids;		// Enumerated storage GUIDs
-
 	if(m_root == nullptr) throw gcnew ArgumentNullException();
 	if(m_storage == nullptr) throw gcnew ArgumentNullException();
 
@@ -50,9 +48,7 @@ StorageObjectEnumerator::StorageObjectEnumerator(StructuredStorage^ root,
 	// the name mapper to see if that thing is valid.  NOW it just asks the name mapper
 	// for everything it knows about, saving both execution time and resources
 
-	guids = m_storage->ObjectNameMapper->ToDictionary()->Values;
-	m_items = gcnew array<Guid>(guids->Count);
-	if(m_items->Length > 0) guids->CopyTo(m_items, 0);
+	m_items = m_storage->ObjectNameMapper->ToGuidArray();
 }
 
 //---------------------------------------------------------------------------
@@ -71,8 +67,7 @@ StorageObject^ StorageObjectEnumerator::Current::get(void)
 	Guid					objid;				// Object stream ID code
 	ComStream^				stream;				// Reference to the stream object
 	IStream*				pStream;			// Pointer to the stream object
-	String^					name;				// BASE64 object name
-	PinnedStringPtr			pinName;			// Pinned object name
+	GUIDNAME				name;				// BASE64 object name
 	HRESULT					hResult;			// Result from function call
 
 	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
@@ -93,20 +88,19 @@ StorageObject^ StorageObjectEnumerator::Current::get(void)
 
 	// The object hasn't been cached (or is dead), so we need to make a new one
 
-	name = StorageUtil::SysGuidToBase64(objid);		// Convert GUID to BASE64
-	pinName = PtrToStringChars(name);				// Pin it down
+	StorageUtil::SysGuidToBase64(objid, name);		// Convert GUID to BASE64
 
 	// Attempt to open up the object's IStream interface using the same mode
 	// flags as the parent IStorage interface
 
-	hResult = m_storage->OpenStream(pinName, NULL, 
-		StorageUtil::GetStorageChildOpenMode(m_storage), 0, &pStream);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult, name);
+	hResult = m_storage->OpenStream(name, NULL, 
+		m_storage->ChildMode, 0, &pStream);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult, gcnew String(name));
 
 	// Create a new ComStream wrapper for the container, and cache it off
 	// in case anyone else tries to access it later on ...
 
-	stream = gcnew ComStream(pStream);
+	stream = gcnew ComStream(pStream, m_storage->Statistics, m_root->StreamCacheSize);
 	pStream->Release();
 
 	m_root->ComStreamCache->Add(objid, stream);
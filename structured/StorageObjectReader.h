@@ -45,7 +45,7 @@ STRUCTURED_STORAGE_PUBLIC ref class StorageObjectReader sealed : public StorageO
 internal:
 
 	StorageObjectReader(ComStream^ stream) : StorageObjectStream(stream, 
-		StorageObjectStreamMode::Reader) {}
+		StorageObjectStreamMode::Reader, nullptr) {}
 };
 
 //---------------------------------------------------------------------------
@@ -35,18 +35,43 @@ BEGIN_ROOT_NAMESPACE(zuki::storage)
 //
 //	stream			- Existing ComStream instance
 //	mode			- ObjectStream mode (reader/writer)
+//	tracker			- Parent change tracker, or NULLPTR for readers
 
-StorageObjectStream::StorageObjectStream(ComStream^ stream, 
-	StorageObjectStreamMode mode) : m_mode(mode)
+StorageObjectStream::StorageObjectStream(ComStream^ stream, StorageObjectStreamMode mode, 
+	StorageChangeTracker^ tracker) : m_mode(mode), m_tracker(tracker), m_position(0), m_length(-1)
 {
 	HRESULT					hResult;		// Result from function call
 
 	if(stream == nullptr) throw gcnew ArgumentNullException();
+	if((m_mode == StorageObjectStreamMode::Writer) && (m_tracker == nullptr)) throw gcnew ArgumentNullException();
+
+	m_objid = stream->ObjectID;
+
+	// CreateClone() resets the seek pointer of the clone to zero, which is
+	// where the position tracking starts out
 
 	hResult = stream->CreateClone(m_stream);
 	if(FAILED(hResult)) throw gcnew StorageException(hResult);
 }
 
+//---------------------------------------------------------------------------
+// StorageObjectStream Destructor
+
+StorageObjectStream::~StorageObjectStream()
+{
+	// If anything was written, record the modification time of the object.
+	// A failure can't be reported from here; call Flush() first to see it
+
+	if(m_modified) {
+
+		try { m_tracker->Touch(m_objid); }
+		catch(Exception^) { /* DO NOTHING */ }
+	}
+
+	m_stream = nullptr;
+	m_disposed = true;
+}
+
 //---------------------------------------------------------------------------
 // StorageObjectStream::CanRead::get
 //
@@ -100,27 +125,39 @@ void StorageObjectStream::Flush(void)
 
 	hResult = m_stream->Commit(STGC_DEFAULT);
 	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	// Record the modification time of the object if it's been written to
+
+	if(m_modified) {
+
+		hResult = m_tracker->Touch(m_objid);
+		if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+		m_modified = false;
+	}
 }
 
 //---------------------------------------------------------------------------
 // StorageObjectStream::Length::get
 //
-// Determines the length of the stream by seeking to the end and returning
-// that position back to the caller.
+// Determines the length of the stream.  A writer only asks the IStream the
+// first time, after that it's kept up to date by Write() and SetLength().  A
+// reader always asks, since the object can be written to by someone else
 
 __int64 StorageObjectStream::Length::get(void)
 {
-	__int64				current;		// The current stream position
+	::STATSTG				statstg;		// Stream statistics
+	HRESULT					hResult;		// Result from function call
 
 	CHECK_DISPOSED(m_disposed);
 
-	current = Position;					// Get the current position
-	
-	// Attempt to seek to the end and return that value.  Ensure that
-	// we put the stream pointer back where it started before leaving
+	if((m_mode == StorageObjectStreamMode::Writer) && (m_length >= 0)) return m_length;
 
-	try { return Seek(0, SeekOrigin::End); }
-	finally { Seek(current, SeekOrigin::Begin); }
+	hResult = m_stream->Stat(&statstg, STATFLAG_NONAME);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	if(m_mode == StorageObjectStreamMode::Writer) m_length = static_cast<__int64>(statstg.cbSize.QuadPart);
+	return static_cast<__int64>(statstg.cbSize.QuadPart);
 }
 
 //---------------------------------------------------------------------------
@@ -149,6 +186,8 @@ int StorageObjectStream::Read(array<Byte>^ buffer, int offset, int count)
 	if(m_mode != StorageObjectStreamMode::Reader) throw gcnew InvalidOperationException();
 
 	cbBytesToRead = Math::Min(count, buffer->Length - offset);	// Calculate size
+	if(cbBytesToRead == 0) return 0;
+
 	pinBuffer = &buffer[offset];								// Pin the byte array
 
 	// Attempt to load the data directly into the user supplied Byte[] array
@@ -156,13 +195,16 @@ int StorageObjectStream::Read(array<Byte>^ buffer, int offset, int count)
 	hResult = m_stream->Read(pinBuffer, cbBytesToRead, &cbRead);
 	if(FAILED(hResult)) throw gcnew StorageException(hResult);
 
+	m_position += cbRead;				// Track the new position
 	return cbRead;						// Return number of bytes actually read
 }
 
 //---------------------------------------------------------------------------
 // StorageObjectStream::Seek
 //
-// Seeks to a specific position in the underlying stream
+// Seeks to a specific position in the underlying stream.  The new position is
+// worked out here, and the underlying stream is only asked to seek if that
+// actually moves the position
 //
 // Arguments:
 //
@@ -171,18 +213,30 @@ int StorageObjectStream::Read(array<Byte>^ buffer, int offset, int count)
 
 __int64 StorageObjectStream::Seek(__int64 offset, SeekOrigin origin)
 {
+	__int64					position;			// The new position
 	LARGE_INTEGER			liOffset;			// Offset as a LARGE_INTEGER
-	ULARGE_INTEGER			uliPosition;		// The new position
 	HRESULT					hResult;			// Result from function call
 
 	CHECK_DISPOSED(m_disposed);
 
-	liOffset.QuadPart = offset;					// Convert into a LARGE_INTEGER
+	switch(origin) {
 
-	hResult = m_stream->Seek(liOffset, static_cast<DWORD>(origin), &uliPosition);
+		case SeekOrigin::Begin: position = offset; break;
+		case SeekOrigin::Current: position = m_position + offset; break;
+		case SeekOrigin::End: position = Length + offset; break;
+		default: throw gcnew ArgumentOutOfRangeException("origin");
+	}
+
+	if(position < 0) throw gcnew IOException("An attempt was made to move the position before the beginning of the stream");
+	if(position == m_position) return m_position;
+
+	liOffset.QuadPart = position;				// Convert into a LARGE_INTEGER
+
+	hResult = m_stream->Seek(liOffset, STREAM_SEEK_SET, NULL);
 	if(FAILED(hResult)) throw gcnew StorageException(hResult);
 
-	return uliPosition.QuadPart;				// Return the new position
+	m_position = position;						// Track the new position
+	return m_position;							// Return the new position
 }
 
 //---------------------------------------------------------------------------
@@ -206,6 +260,9 @@ void StorageObjectStream::SetLength(__int64 value)
 	uliNewSize.QuadPart = value;
 	hResult = m_stream->SetSize(uliNewSize);
 	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	m_length = value;
+	m_modified = true;
 }
 
 //---------------------------------------------------------------------------
@@ -241,6 +298,11 @@ void StorageObjectStream::Write(array<Byte>^ buffer, int offset, int count)
 
 	hResult = m_stream->Write(pinBuffer, cbBytesToWrite, &cbWritten);
 	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	m_position += cbWritten;					// Track the new position
+	if((m_length >= 0) && (m_position > m_length)) m_length = m_position;
+
+	m_modified = true;
 }
 
 //---------------------------------------------------------------------------
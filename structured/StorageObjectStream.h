@@ -25,6 +25,7 @@
 #pragma once
 
 #include "ComStream.h"					// Include ComStream declarations
+#include "StorageChangeTracker.h"		// Include StorageChangeTracker decls
 #include "StorageObjectStreamMode.h"	// Include stream mode enumeration
 #include "StorageException.h"			// Include StorageException declarations
 
@@ -39,6 +40,12 @@ BEGIN_ROOT_NAMESPACE(zuki::storage)
 // Class StorageObjectStream
 //
 // StorageObjectStream wraps an existing IStream pointer from a storage object
+//
+// The position and length of the stream are tracked here rather than asked
+// of the IStream every time.  Every seek into a compound file stream walks
+// its sector chain, so seeks that don't move the position are skipped, the
+// length comes from a single Stat(), and reads at the end of the stream
+// don't go to the IStream at all
 //---------------------------------------------------------------------------
 
 STRUCTURED_STORAGE_PUBLIC ref class StorageObjectStream abstract : public Stream
@@ -65,14 +72,14 @@ public:
 
 	virtual property __int64 Position 
 	{ 
-		__int64 get(void) override { return Seek(0, SeekOrigin::Current); } 
+		__int64 get(void) override { CHECK_DISPOSED(m_disposed); return m_position; } 
 		void set(__int64 pos) override { Seek(pos, SeekOrigin::Begin); }
 	}
 
 internal:
 
 	// INTERNAL CONSTRUCTOR
-	StorageObjectStream(ComStream^ stream, StorageObjectStreamMode mode);
+	StorageObjectStream(ComStream^ stream, StorageObjectStreamMode mode, StorageChangeTracker^ tracker);
 
 	//-----------------------------------------------------------------------
 	// Internal Properties
@@ -82,7 +89,7 @@ internal:
 private:
 
 	// DESTRUCTOR / FINALIZER
-	~StorageObjectStream() { m_stream = nullptr; m_disposed = true; }
+	~StorageObjectStream();
 	//!StorageObjectStream();
 
 	//-----------------------------------------------------------------------
@@ -91,6 +98,11 @@ private:
 	bool							m_disposed;		// Object disposal flag
 	StorageObjectStreamMode			m_mode;			// Object stream mode
 	ComStream^						m_stream;		// Parent stream instance
+	StorageChangeTracker^			m_tracker;		// Parent change tracker
+	Guid							m_objid;		// Object ID GUID
+	bool							m_modified;		// Flag if stream was written
+	__int64							m_position;		// Current stream position
+	__int64							m_length;		// Writer stream length, or -1
 	//IStream*						m_pStream;		// Contained COM stream
 };
 
@@ -44,8 +44,8 @@ STRUCTURED_STORAGE_PUBLIC ref class StorageObjectWriter sealed : public StorageO
 {
 internal:
 
-	StorageObjectWriter(ComStream^ stream) : StorageObjectStream(stream, 
-		StorageObjectStreamMode::Writer) {}
+	StorageObjectWriter(ComStream^ stream, StorageChangeTracker^ tracker) : 
+		StorageObjectStream(stream, StorageObjectStreamMode::Writer, tracker) {}
 };
 
 //---------------------------------------------------------------------------
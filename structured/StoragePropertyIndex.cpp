@@ -0,0 +1,737 @@
+//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+#include "stdafx.h"						// Include project pre-compiled headers
+#include "StoragePropertyIndex.h"		// Include StoragePropertyIndex declarations
+#include "StorageContainer.h"			// Include StorageContainer declarations
+#include "StoragePropertySet.h"			// Include StoragePropertySet declarations
+#include "StructuredStorage.h"			// Include StructuredStorage declarations
+
+#pragma warning(push, 4)				// Enable maximum compiler warnings
+
+BEGIN_ROOT_NAMESPACE(zuki::storage)
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex Constructor
+//
+// Arguments:
+//
+//	root		- Root StructuredStorage instance
+//	storage		- Root ComStorage instance
+
+StoragePropertyIndex::StoragePropertyIndex(StructuredStorage^ root, ComStorage^ storage) : 
+	m_root(root), m_storage(storage)
+{
+	if(m_root == nullptr) throw gcnew ArgumentNullException();
+	if(m_storage == nullptr) throw gcnew ArgumentNullException();
+
+	m_lock = gcnew Object();
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex Destructor
+
+StoragePropertyIndex::~StoragePropertyIndex()
+{
+	if(m_stream != nullptr) delete m_stream;
+	m_disposed = true;
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::Add
+//
+// Creates a new index over a property and populates it by scanning all of
+// the existing property sets.  Does nothing if the index already exists
+//
+// Arguments:
+//
+//	propertySet		- Name of the property set to be indexed
+//	property		- Name of the property to be indexed
+
+void StoragePropertyIndex::Add(String^ propertySet, String^ property)
+{
+	lock					cs(m_lock);			// Automatic lock
+	String^					key;				// Index dictionary key
+	IndexData^				index;				// The new index
+
+	CHECK_DISPOSED(m_disposed);
+
+	if(propertySet == nullptr) throw gcnew ArgumentNullException();
+	if(property == nullptr) throw gcnew ArgumentNullException();
+
+	Load();										// Load existing indexes
+
+	key = GetIndexKey(propertySet, property);
+	if(m_indexes->ContainsKey(key)) return;
+
+	index = gcnew IndexData(propertySet, property);
+	Build(m_root, String::Empty, gcnew List<IndexData^>(gcnew array<IndexData^> { index }));
+
+	MarkDirty();
+	m_indexes->Add(key, index);
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::Build (private)
+//
+// Populates a set of indexes by reading the indexed properties from every
+// container in a tree of containers.  This is how indexes get created, and
+// how they're rebuilt if the stored copy is out of date
+//
+// Arguments:
+//
+//	container		- Container at the top of the tree
+//	path			- Path of the container at the top of the tree
+//	indexes			- Indexes to be populated
+
+void StoragePropertyIndex::Build(StorageContainer^ container, String^ path, List<IndexData^>^ indexes)
+{
+	StoragePropertySetCollection^	propsets;		// Container property sets
+	StoragePropertySet^				propset;		// Indexed property set
+	String^							id;				// Sub container ID string
+
+	propsets = container->PropertySets;
+
+	for each(IndexData^ index in indexes) {
+
+		if(!propsets->Contains(index->PropertySet)) continue;
+
+		propset = propsets[index->PropertySet];
+		if(propset->Contains(index->Property)) index->Insert(path, propset[index->Property]);
+	}
+
+	for each(StorageContainer^ child in container->Containers) {
+
+		id = child->ContainerID.ToString("N");
+		Build(child, (path->Length == 0) ? id : String::Concat(path, "/", id), indexes);
+	}
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::Contains
+//
+// Determines if any property of the named property set has been indexed.
+// This is called for every property change, so it's kept cheap
+//
+// Arguments:
+//
+//	propertySet		- Name of the property set
+
+bool StoragePropertyIndex::Contains(String^ propertySet)
+{
+	lock					cs(m_lock);			// Automatic lock
+
+	CHECK_DISPOSED(m_disposed);
+
+	Load();										// Load existing indexes
+
+	for each(IndexData^ index in m_indexes->Values)
+		if(String::Compare(index->PropertySet, propertySet, StringComparison::OrdinalIgnoreCase) == 0) return true;
+
+	return false;
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::GetIndexKey (private, static)
+//
+// Generates the dictionary key for an index.  Property names can't contain
+// a NUL character, so that's used to separate the two names
+//
+// Arguments:
+//
+//	propertySet		- Name of the property set
+//	property		- Name of the property
+
+String^ StoragePropertyIndex::GetIndexKey(String^ propertySet, String^ property)
+{
+	return String::Concat(propertySet, gcnew String(L'\0', 1), property);
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::GetPath (static)
+//
+// Generates the path for a storage, which is the GUIDs of every container
+// from the root down to the storage separated by slashes.  The path of the
+// root storage itself is an empty string
+//
+// Arguments:
+//
+//	storage			- Storage to generate the path for
+
+String^ StoragePropertyIndex::GetPath(ComStorage^ storage)
+{
+	String^					path;				// Generated path string
+	String^					id;					// Container ID string
+
+	path = String::Empty;
+
+	for(ComStorage^ current = storage; current->Parent != nullptr; current = current->Parent) {
+
+		id = current->ContainerID.ToString("N");
+		path = (path->Length == 0) ? id : String::Concat(id, "/", path);
+	}
+
+	return path;
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::Load (private)
+//
+// Loads the indexes from the hidden stream the first time they're needed,
+// and rebuilds them if the stream was flagged as out of date.  Must be
+// called with the lock held
+//
+// Arguments:
+//
+//	NONE
+
+void StoragePropertyIndex::Load(void)
+{
+	LARGE_INTEGER			liOffset;			// Offset as a LARGE_INTEGER
+	ULARGE_INTEGER			uliLength;			// Length of the stream
+	array<Byte>^			buffer;				// Contents of the stream
+	PinnedBytePtr			pinBuffer;			// Pinned buffer pointer
+	ULONG					cbRead;				// Number of bytes read
+	int						total = 0;			// Total number of bytes read
+	bool					dirty;				// Stored dirty flag
+	HRESULT					hResult;			// Result from function call
+
+	if(m_indexes != nullptr) return;			// Already loaded
+
+	Dictionary<String^, IndexData^>^ indexes = gcnew Dictionary<String^, IndexData^>(StringComparer::OrdinalIgnoreCase);
+
+	// A storage that has never had an index created doesn't have the stream
+
+	hResult = OpenStream(false);
+	if(hResult == STG_E_FILENOTFOUND) { m_indexes = indexes; return; }
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	liOffset.QuadPart = 0;
+	hResult = m_stream->Seek(liOffset, STREAM_SEEK_END, &uliLength);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	if(uliLength.QuadPart > Int32::MaxValue) throw gcnew ObjectTooLargeException();
+
+	hResult = m_stream->Seek(liOffset, STREAM_SEEK_SET, NULL);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	buffer = gcnew array<Byte>(static_cast<int>(uliLength.QuadPart));
+
+	if(buffer->Length > 0) {
+
+		pinBuffer = &buffer[0];
+
+		while(total < buffer->Length) {
+
+			hResult = m_stream->Read(pinBuffer + total, static_cast<ULONG>(buffer->Length - total), &cbRead);
+			if(FAILED(hResult)) throw gcnew StorageException(hResult);
+			if(cbRead == 0) break;
+
+			total += static_cast<int>(cbRead);
+		}
+
+		pinBuffer = nullptr;
+	}
+
+	// HEADER: [INT32 version][BYTE dirty flag], followed by the [INT32]
+	// index count, and then each index: [STRING key from GetIndexKey()][INT32
+	// value count] followed by that many [STRING path][BYTE type][value]
+
+	MemoryStream^ stream = gcnew MemoryStream(buffer, 0, total, false);
+	BinaryReader^ reader = gcnew BinaryReader(stream);
+
+	if((total < 5) || (reader->ReadInt32() != INDEX_VERSION)) { m_indexes = indexes; return; }
+	dirty = reader->ReadBoolean();
+
+	if(stream->Position < stream->Length) {
+
+		int count = reader->ReadInt32();
+		if(count < 0) throw gcnew InvalidDataException();
+
+		for(int item = 0; item < count; item++) {
+
+			String^ key = reader->ReadString();
+			array<String^>^ names = key->Split(L'\0');
+			if(names->Length != 2) throw gcnew InvalidDataException();
+
+			IndexData^ index = gcnew IndexData(names[0], names[1]);
+
+			int values = reader->ReadInt32();
+			if(values < 0) throw gcnew InvalidDataException();
+
+			for(int entry = 0; entry < values; entry++) {
+
+				String^ path = reader->ReadString();
+				Object^ value = ReadValue(reader);
+				if(!dirty) index->Insert(path, value);
+			}
+
+			indexes[key] = index;
+		}
+	}
+
+	// If the stored indexes are out of date, throw the values away and rebuild
+	// them.  The stream stays flagged until the rebuilt indexes get saved
+
+	if(dirty) {
+
+		Build(m_root, String::Empty, gcnew List<IndexData^>(indexes->Values));
+		m_dirty = true;
+	}
+
+	m_indexes = indexes;
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::Lookup
+//
+// Finds the paths of all the containers where an indexed property has the
+// specified value.  If the property isn't indexed, the property sets are
+// scanned instead.  Values are compared with Object::Equals()
+//
+// Arguments:
+//
+//	propertySet		- Name of the property set
+//	property		- Name of the property
+//	value			- Value to be looked up
+
+List<String^>^ StoragePropertyIndex::Lookup(String^ propertySet, String^ property, Object^ value)
+{
+	lock					cs(m_lock);			// Automatic lock
+	IndexData^				index;				// Index to look in
+	Dictionary<String^, bool>^	paths;			// Matching container paths
+
+	CHECK_DISPOSED(m_disposed);
+
+	if(propertySet == nullptr) throw gcnew ArgumentNullException();
+	if(property == nullptr) throw gcnew ArgumentNullException();
+	if(value == nullptr) throw gcnew ArgumentNullException();
+
+	Load();										// Load existing indexes
+
+	if(!m_indexes->TryGetValue(GetIndexKey(propertySet, property), index)) {
+
+		index = gcnew IndexData(propertySet, property);
+		Build(m_root, String::Empty, gcnew List<IndexData^>(gcnew array<IndexData^> { index }));
+	}
+
+	if(!index->Paths->TryGetValue(value, paths)) return gcnew List<String^>();
+	return gcnew List<String^>(paths->Keys);
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::MarkDirty (private)
+//
+// Sets the dirty flag in the hidden stream the first time the indexes are
+// changed after being loaded or saved.  Must be called with the lock held
+//
+// Arguments:
+//
+//	NONE
+
+void StoragePropertyIndex::MarkDirty(void)
+{
+	LARGE_INTEGER			liOffset;			// Offset as a LARGE_INTEGER
+	BYTE					header[5];			// Stream header
+	int						version = INDEX_VERSION;	// Stream format version
+	HRESULT					hResult;			// Result from function call
+
+	if(m_dirty) return;							// Already flagged
+
+	// Nothing can be written into a read-only storage; the in-memory indexes
+	// are still kept up to date though
+
+	if(m_storage->ReadOnly) { m_dirty = true; return; }
+
+	hResult = OpenStream(true);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	memcpy(header, &version, sizeof(int));
+	header[4] = 1;
+
+	liOffset.QuadPart = 0;
+	hResult = m_stream->Seek(liOffset, STREAM_SEEK_SET, NULL);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	hResult = m_stream->Write(header, sizeof(header), NULL);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	m_dirty = true;
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::OpenStream (private)
+//
+// Opens the hidden index stream in the root storage, and optionally creates
+// it if it doesn't exist yet.  The name isn't a BASE64 GUID, so none of the
+// collections will ever see it
+//
+// Arguments:
+//
+//	create			- Flag to create the stream if it doesn't exist
+
+HRESULT StoragePropertyIndex::OpenStream(bool create)
+{
+	String^					name = INDEX_STREAM_NAME;	// Stream name
+	PinnedStringPtr			pinName;			// Pinned stream name
+	IStream*				pStream;			// Opened IStream
+	HRESULT					hResult;			// Result from function call
+
+	if(m_stream != nullptr) return S_OK;		// Already open
+
+	pinName = PtrToStringChars(name);
+
+	hResult = m_storage->OpenStream(pinName, NULL, m_storage->ChildMode, 0, &pStream);
+	if((hResult == STG_E_FILENOTFOUND) && create && (!m_storage->ReadOnly))
+		hResult = m_storage->CreateStream(pinName, m_storage->ChildMode, 0, 0, &pStream);
+
+	if(FAILED(hResult)) return hResult;
+
+	m_stream = gcnew ComStream(pStream, m_storage->Statistics, 0);
+	pStream->Release();
+
+	return S_OK;
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::ReadValue (private, static)
+//
+// Reads a property value written by WriteValue().  Only the scalar types that
+// can be stored in a property set are understood; anything else in the stream
+// means it's damaged (or wasn't written by this class) and is rejected
+//
+// Arguments:
+//
+//	reader			- BinaryReader positioned at the value
+
+Object^ StoragePropertyIndex::ReadValue(BinaryReader^ reader)
+{
+	switch(static_cast<TypeCode>(reader->ReadByte())) {
+
+		case TypeCode::Boolean:		return reader->ReadBoolean();
+		case TypeCode::Byte:		return reader->ReadByte();
+		case TypeCode::Char:		return reader->ReadChar();
+		case TypeCode::DateTime:	return DateTime::FromBinary(reader->ReadInt64());
+		case TypeCode::Decimal:		return reader->ReadDecimal();
+		case TypeCode::Double:		return reader->ReadDouble();
+		case TypeCode::Int16:		return reader->ReadInt16();
+		case TypeCode::Int32:		return reader->ReadInt32();
+		case TypeCode::Int64:		return reader->ReadInt64();
+		case TypeCode::SByte:		return reader->ReadSByte();
+		case TypeCode::Single:		return reader->ReadSingle();
+		case TypeCode::String:		return reader->ReadString();
+		case TypeCode::UInt16:		return reader->ReadUInt16();
+		case TypeCode::UInt32:		return reader->ReadUInt32();
+		case TypeCode::UInt64:		return reader->ReadUInt64();
+
+		// TimeSpan doesn't have a TypeCode of it's own; it is written with
+		// TypeCode::Object since no other object type is ever written
+
+		case TypeCode::Object:		return TimeSpan(reader->ReadInt64());
+	}
+
+	throw gcnew InvalidDataException();
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::Remove
+//
+// Removes an existing index
+//
+// Arguments:
+//
+//	propertySet		- Name of the indexed property set
+//	property		- Name of the indexed property
+
+bool StoragePropertyIndex::Remove(String^ propertySet, String^ property)
+{
+	lock					cs(m_lock);			// Automatic lock
+
+	CHECK_DISPOSED(m_disposed);
+
+	if(propertySet == nullptr) throw gcnew ArgumentNullException();
+	if(property == nullptr) throw gcnew ArgumentNullException();
+
+	Load();										// Load existing indexes
+
+	if(!m_indexes->ContainsKey(GetIndexKey(propertySet, property))) return false;
+
+	MarkDirty();
+	return m_indexes->Remove(GetIndexKey(propertySet, property));
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::Save
+//
+// Writes the indexes into the hidden stream if they've been changed.  The
+// data is written first and the dirty flag is only cleared at the very end
+//
+// Arguments:
+//
+//	NONE
+
+void StoragePropertyIndex::Save(void)
+{
+	lock					cs(m_lock);			// Automatic lock
+	LARGE_INTEGER			liOffset;			// Offset as a LARGE_INTEGER
+	ULARGE_INTEGER			uliSize;			// New size of the stream
+	array<Byte>^			buffer;				// Serialized indexes
+	PinnedBytePtr			pinBuffer;			// Pinned buffer pointer
+	BYTE					clean = 0;			// Cleared dirty flag
+	HRESULT					hResult;			// Result from function call
+
+	CHECK_DISPOSED(m_disposed);
+
+	if((!m_dirty) || (m_storage->ReadOnly)) return;
+
+	MemoryStream^ stream = gcnew MemoryStream();
+	BinaryWriter^ writer = gcnew BinaryWriter(stream);
+
+	writer->Write(INDEX_VERSION);
+	writer->Write(true);
+	writer->Write(m_indexes->Count);
+
+	for each(KeyValuePair<String^, IndexData^> item in m_indexes) {
+
+		writer->Write(item.Key);
+		writer->Write(item.Value->Values->Count);
+
+		for each(KeyValuePair<String^, Object^> entry in item.Value->Values) {
+
+			writer->Write(entry.Key);
+			WriteValue(writer, entry.Value);
+		}
+	}
+
+	writer->Flush();
+	buffer = stream->ToArray();
+
+	hResult = OpenStream(true);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	liOffset.QuadPart = 0;
+	hResult = m_stream->Seek(liOffset, STREAM_SEEK_SET, NULL);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	pinBuffer = &buffer[0];
+	hResult = m_stream->Write(pinBuffer, static_cast<ULONG>(buffer->Length), NULL);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	pinBuffer = nullptr;
+
+	uliSize.QuadPart = static_cast<ULONGLONG>(buffer->Length);
+	hResult = m_stream->SetSize(uliSize);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	// Now that everything else has been written, clear the dirty flag
+
+	liOffset.QuadPart = sizeof(int);
+	hResult = m_stream->Seek(liOffset, STREAM_SEEK_SET, NULL);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	hResult = m_stream->Write(&clean, sizeof(BYTE), NULL);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	m_dirty = false;
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::Update
+//
+// Updates the indexed value of a property for a single container
+//
+// Arguments:
+//
+//	propertySet		- Name of the property set that changed
+//	property		- Name of the property that changed
+//	path			- Path of the container that owns the property set
+//	value			- New value of the property, or NULLPTR if removed
+
+void StoragePropertyIndex::Update(String^ propertySet, String^ property, String^ path, Object^ value)
+{
+	lock					cs(m_lock);			// Automatic lock
+	IndexData^				index;				// Index to be updated
+
+	CHECK_DISPOSED(m_disposed);
+
+	Load();										// Load existing indexes
+
+	if(!m_indexes->TryGetValue(GetIndexKey(propertySet, property), index)) return;
+
+	MarkDirty();
+	index->Insert(path, value);
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::UpdateAll
+//
+// Updates every indexed property of a property set for a single container,
+// used when the property set is cleared, renamed, removed or copied
+//
+// Arguments:
+//
+//	propertySet		- Name of the property set that changed
+//	path			- Path of the container that owns the property set
+//	values			- The property set, or NULLPTR if it has been removed
+
+void StoragePropertyIndex::UpdateAll(String^ propertySet, String^ path, StoragePropertySet^ values)
+{
+	lock					cs(m_lock);			// Automatic lock
+
+	CHECK_DISPOSED(m_disposed);
+
+	Load();										// Load existing indexes
+
+	for each(IndexData^ index in m_indexes->Values) {
+
+		if(String::Compare(index->PropertySet, propertySet, StringComparison::OrdinalIgnoreCase) != 0) continue;
+
+		MarkDirty();
+
+		if((values != nullptr) && (values->Contains(index->Property))) index->Insert(path, values[index->Property]);
+		else index->Remove(path);
+	}
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::IndexData Implementation
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::IndexData Constructor
+//
+// Arguments:
+//
+//	propertySet		- Name of the indexed property set
+//	property		- Name of the indexed property
+
+StoragePropertyIndex::IndexData::IndexData(String^ propertySet, String^ property) :
+	PropertySet(propertySet), Property(property)
+{
+	Values = gcnew Dictionary<String^, Object^>();
+	Paths = gcnew Dictionary<Object^, Dictionary<String^, bool>^>();
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::IndexData::Insert
+//
+// Sets the value for a container path, replacing any existing one.  Array
+// values can't be compared with Equals(), so they aren't indexed at all
+//
+// Arguments:
+//
+//	path			- Container path
+//	value			- Property value, or NULLPTR to remove the path
+
+void StoragePropertyIndex::IndexData::Insert(String^ path, Object^ value)
+{
+	Dictionary<String^, bool>^	paths;			// Paths with the same value
+
+	Remove(path);
+
+	if((value == nullptr) || (dynamic_cast<Array^>(value) != nullptr)) return;
+
+	if(!Paths->TryGetValue(value, paths)) {
+
+		paths = gcnew Dictionary<String^, bool>();
+		Paths->Add(value, paths);
+	}
+
+	paths[path] = true;
+	Values[path] = value;
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::IndexData::Remove
+//
+// Removes a container path from the index
+//
+// Arguments:
+//
+//	path			- Container path
+
+void StoragePropertyIndex::IndexData::Remove(String^ path)
+{
+	Object^						value;			// Existing value
+	Dictionary<String^, bool>^	paths;			// Paths with the same value
+
+	if(!Values->TryGetValue(path, value)) return;
+
+	Values->Remove(path);
+
+	if(Paths->TryGetValue(value, paths)) {
+
+		paths->Remove(path);
+		if(paths->Count == 0) Paths->Remove(value);
+	}
+}
+
+//---------------------------------------------------------------------------
+// StoragePropertyIndex::WriteValue (private, static)
+//
+// Writes a property value as a TypeCode tag byte followed by the value.  The
+// index only ever holds the scalar types that a property set can store
+//
+// Arguments:
+//
+//	writer			- BinaryWriter to write the value with
+//	value			- Property value to be written
+
+void StoragePropertyIndex::WriteValue(BinaryWriter^ writer, Object^ value)
+{
+	if(value == nullptr) throw gcnew ArgumentNullException("value");
+
+	if(value->GetType() == TimeSpan::typeid) {
+
+		writer->Write(static_cast<Byte>(TypeCode::Object));
+		writer->Write(safe_cast<TimeSpan>(value).Ticks);
+		return;
+	}
+
+	TypeCode type = Type::GetTypeCode(value->GetType());
+	writer->Write(static_cast<Byte>(type));
+
+	switch(type) {
+
+		case TypeCode::Boolean:		writer->Write(safe_cast<bool>(value)); break;
+		case TypeCode::Byte:		writer->Write(safe_cast<Byte>(value)); break;
+		case TypeCode::Char:		writer->Write(safe_cast<wchar_t>(value)); break;
+		case TypeCode::DateTime:	writer->Write(safe_cast<DateTime>(value).ToBinary()); break;
+		case TypeCode::Decimal:		writer->Write(safe_cast<Decimal>(value)); break;
+		case TypeCode::Double:		writer->Write(safe_cast<double>(value)); break;
+		case TypeCode::Int16:		writer->Write(safe_cast<short>(value)); break;
+		case TypeCode::Int32:		writer->Write(safe_cast<int>(value)); break;
+		case TypeCode::Int64:		writer->Write(safe_cast<__int64>(value)); break;
+		case TypeCode::SByte:		writer->Write(safe_cast<SByte>(value)); break;
+		case TypeCode::Single:		writer->Write(safe_cast<float>(value)); break;
+		case TypeCode::String:		writer->Write(safe_cast<String^>(value)); break;
+		case TypeCode::UInt16:		writer->Write(safe_cast<unsigned short>(value)); break;
+		case TypeCode::UInt32:		writer->Write(safe_cast<unsigned int>(value)); break;
+		case TypeCode::UInt64:		writer->Write(safe_cast<unsigned __int64>(value)); break;
+
+		default: throw gcnew InvalidPropertyDataTypeException(value->GetType());
+	}
+}
+
+//---------------------------------------------------------------------------
+
+END_ROOT_NAMESPACE(zuki::storage)
+
+#pragma warning(pop)
@@ -0,0 +1,215 @@
+//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+#ifndef __STORAGEPROPERTYINDEX_H_
+#define __STORAGEPROPERTYINDEX_H_
+#pragma once
+
+#include "ComStorage.h"					// Include ComStorage declarations
+#include "ComStream.h"					// Include ComStream declarations
+#include "StorageException.h"			// Include StorageException decls
+#include "StorageExceptions.h"			// Include StorageExceptions decls
+
+#pragma warning(push, 4)				// Enable maximum compiler warnings
+
+using namespace System;
+using namespace System::Collections::Generic;
+using namespace System::IO;
+using namespace msclr;
+
+BEGIN_ROOT_NAMESPACE(zuki::storage)
+
+//---------------------------------------------------------------------------
+// Forward Class Declarations
+//
+// Include the specified header files in the .CPP file for this class
+//---------------------------------------------------------------------------
+
+ref class StorageContainer;					// <-- StorageContainer.h
+ref class StoragePropertySet;				// <-- StoragePropertySet.h
+ref class StructuredStorage;				// <-- StructuredStorage.h
+
+//---------------------------------------------------------------------------
+// Class StoragePropertyIndex (internal)
+//
+// StoragePropertyIndex implements the opt-in secondary indexes over property
+// values.  Each index covers one property of one named property set in every
+// container, and maps the values of that property to the containers that
+// have them.  Containers are identified by the path of GUIDs leading to them
+// from the root, so they can be opened without searching for them.
+//
+// The indexes are kept in memory and written into a hidden stream in the root
+// storage when the storage is flushed or closed.  The first change after that
+// sets a flag at the start of the stream, and if the flag is still set the
+// next time the file is opened (it wasn't closed properly) the indexes are
+// rebuilt from the property sets themselves.
+//---------------------------------------------------------------------------
+
+ref class StoragePropertyIndex sealed
+{
+public:
+
+	//-----------------------------------------------------------------------
+	// Constructor
+
+	StoragePropertyIndex(StructuredStorage^ root, ComStorage^ storage);
+
+	//-----------------------------------------------------------------------
+	// Member Functions
+
+	// Add
+	//
+	// Creates a new index and populates it from the existing property sets
+	void Add(String^ propertySet, String^ property);
+
+	// Contains
+	//
+	// Determines if any property of the named property set is indexed
+	bool Contains(String^ propertySet);
+
+	// GetPath (static)
+	//
+	// Generates the path string for a storage
+	static String^ GetPath(ComStorage^ storage);
+
+	// Lookup
+	//
+	// Finds the paths of all the containers where a property has a value
+	List<String^>^ Lookup(String^ propertySet, String^ property, Object^ value);
+
+	// Remove
+	//
+	// Removes an existing index
+	bool Remove(String^ propertySet, String^ property);
+
+	// Save
+	//
+	// Writes the indexes into the root storage if they've changed
+	void Save(void);
+
+	// Update
+	//
+	// Updates the value of a property for a container
+	void Update(String^ propertySet, String^ property, String^ path, Object^ value);
+
+	// UpdateAll
+	//
+	// Updates every indexed property of a property set for a container
+	void UpdateAll(String^ propertySet, String^ path, StoragePropertySet^ values);
+
+private:
+
+	// DESTRUCTOR
+	~StoragePropertyIndex();
+
+	//-----------------------------------------------------------------------
+	// Private Data Types
+
+	// IndexData
+	//
+	// The contents of a single index: PATH->VALUE and VALUE->PATHS.  There's
+	// no HashSet<> without System.Core, so the PATHS are dictionary keys
+	ref class IndexData
+	{
+	public:
+
+		IndexData(String^ propertySet, String^ property);
+
+		void Insert(String^ path, Object^ value);
+		void Remove(String^ path);
+
+		initonly String^										PropertySet;
+		initonly String^										Property;
+		initonly Dictionary<String^, Object^>^					Values;
+		initonly Dictionary<Object^, Dictionary<String^, bool>^>^	Paths;
+	};
+
+	//-----------------------------------------------------------------------
+	// Private Constants
+
+	// INDEX_STREAM_NAME
+	//
+	// Name of the hidden stream that holds the indexes
+	literal String^ INDEX_STREAM_NAME = "PropertyIndex";
+
+	// INDEX_VERSION
+	//
+	// Version of the hidden stream format
+	literal int INDEX_VERSION = 2;
+
+	//-----------------------------------------------------------------------
+	// Private Member Functions
+
+	// Build
+	//
+	// Populates a set of indexes from the property sets in a container tree
+	void Build(StorageContainer^ container, String^ path, List<IndexData^>^ indexes);
+
+	// GetIndexKey (static)
+	//
+	// Generates the dictionary key for an index
+	static String^ GetIndexKey(String^ propertySet, String^ property);
+
+	// Load
+	//
+	// Loads the indexes from the root storage the first time they're needed
+	void Load(void);
+
+	// MarkDirty
+	//
+	// Flags the stored indexes as out of date the first time they're changed
+	void MarkDirty(void);
+
+	// OpenStream
+	//
+	// Opens (or optionally creates) the hidden index stream
+	HRESULT OpenStream(bool create);
+
+	// ReadValue (static)
+	//
+	// Reads a type-tagged property value from the index stream
+	static Object^ ReadValue(BinaryReader^ reader);
+
+	// WriteValue (static)
+	//
+	// Writes a type-tagged property value into the index stream
+	static void WriteValue(BinaryWriter^ writer, Object^ value);
+
+	//-----------------------------------------------------------------------
+	// Member Variables
+
+	bool								m_disposed;		// Object disposal flag
+	StructuredStorage^					m_root;			// Root storage object
+	ComStorage^							m_storage;		// Root ComStorage
+	ComStream^							m_stream;		// Hidden index stream
+	Dictionary<String^, IndexData^>^	m_indexes;		// Loaded indexes
+	bool								m_dirty;		// Flag if indexes changed
+	initonly Object^					m_lock;			// Synchronization object
+};
+
+//---------------------------------------------------------------------------
+
+END_ROOT_NAMESPACE(zuki::storage)
+
+#pragma warning(pop)
+
+#endif	// __STORAGEPROPERTYINDEX_H_
@@ -22,6 +22,7 @@
 
 #include "stdafx.h"						// Include project pre-compiled headers
 #include "StoragePropertySet.h"			// Include StoragePropertySet declarations
+#include "StructuredStorage.h"			// Include StructuredStorage declarations
 
 #pragma warning(push, 4)				// Enable maximum compiler warnings
 
@@ -32,19 +33,21 @@ BEGIN_ROOT_NAMESPACE(zuki::storage)
 //
 // Arguments:
 //
+//	root			- Reference to the root StructuredStorage instance
 //	parent			- Reference to parent ComStorage instance
 //	propStorage		- ComPropertyStorage for this object to use
 
-StoragePropertySet::StoragePropertySet(ComStorage^ parent, ComPropertyStorage^ propStorage) : 
-	m_parent(parent), m_propStorage(propStorage)
+StoragePropertySet::StoragePropertySet(StructuredStorage^ root, ComStorage^ parent, ComPropertyStorage^ propStorage) : 
+	m_root(root), m_parent(parent), m_propStorage(propStorage)
 {
+	if(m_root == nullptr) throw gcnew ArgumentNullException();
 	if(m_parent == nullptr) throw gcnew ArgumentNullException();
 	if(m_propStorage == nullptr) throw gcnew ArgumentNullException();
 
 	// We can't get at the read-only flag directly for property sets via
 	// Stat(), but we can assume it's the same as the parent container
 
-	m_readOnly = StorageUtil::IsStorageReadOnly(m_parent);
+	m_readOnly = m_parent->ReadOnly;
 	m_fmtid = StorageUtil::GetPropertySetID(m_propStorage);
 }
 
@@ -122,6 +125,11 @@ void StoragePropertySet::Clear(void)
 	} // try
 
 	finally { pEnumStg->Release(); }			// Always release interface
+
+	// Every indexed property in this set is gone now, drop them from the index
+
+	if(m_root->PropertyIndex->Contains(Name))
+		m_root->PropertyIndex->UpdateAll(Name, StoragePropertyIndex::GetPath(m_parent), nullptr);
 }
 
 //---------------------------------------------------------------------------
@@ -161,6 +169,84 @@ bool StoragePropertySet::Contains(String^ name)
 	return (hResult == S_OK);				// S_OK = property existed
 }
 
+//---------------------------------------------------------------------------
+// StoragePropertySet::CopyPropertiesTo (internal)
+//
+// Copies every property in this set into another property set.  The raw
+// PROPVARIANTs and PROPIDs are copied as-is, so nothing is converted to 
+// and from managed objects along the way
+//
+// Arguments:
+//
+//	target			- The target property set
+
+void StoragePropertySet::CopyPropertiesTo(StoragePropertySet^ target)
+{
+	IEnumSTATPROPSTG*		pEnumStg;			// Storage enumerator
+	STATPROPSTG				statstg;			// Enumerated information
+	PROPSPEC				propspec;			// PROPSPEC structure
+	PROPVARIANT				varProperty;		// VARIANT property value
+	ULONG					ulRead;				// Number of items read
+	HRESULT					hResult;			// Result from function call
+
+	CHECK_DISPOSED(m_disposed || m_propStorage->IsDisposed());
+
+	if(target == nullptr) throw gcnew ArgumentNullException();
+	if(target->m_readOnly) throw gcnew PropertySetReadOnlyException();
+
+	// Attempt to grab the property set enumerator from the PropertySetStorage
+
+	hResult = m_propStorage->Enum(&pEnumStg);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	try { 
+	
+		while(pEnumStg->Next(1, &statstg, &ulRead) == S_OK) {
+
+			try {
+
+				propspec.ulKind = PRSPEC_PROPID;
+				propspec.propid = statstg.propid;
+
+				hResult = m_propStorage->ReadMultiple(1, &propspec, &varProperty);
+				if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+				// Write the value into the target under the same PROPID, and
+				// then give it the same string name as the original
+
+				try {
+
+					hResult = target->m_propStorage->WriteMultiple(1, &propspec, &varProperty, 
+						PROPERTYSET_BASEPROPID);
+					if(FAILED(hResult)) throw gcnew StorageException(hResult, gcnew String(statstg.lpwstrName));
+				}
+
+				finally { PropVariantClear(&varProperty); }
+
+				if(statstg.lpwstrName) {
+
+					hResult = target->m_propStorage->WritePropertyNames(1, &statstg.propid, &statstg.lpwstrName);
+					if(FAILED(hResult)) throw gcnew StorageException(hResult, gcnew String(statstg.lpwstrName));
+				}
+			}
+			
+			finally { if(statstg.lpwstrName) CoTaskMemFree(statstg.lpwstrName); }
+		
+		} // while
+	} // try
+
+	finally { pEnumStg->Release(); }			// Always release interface
+
+	hResult = target->m_propStorage->Commit(STGC_DEFAULT);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	// The target may belong to a different root storage, so use its index
+
+	String^ targetName = target->Name;
+	if(target->m_root->PropertyIndex->Contains(targetName))
+		target->m_root->PropertyIndex->UpdateAll(targetName, StoragePropertyIndex::GetPath(target->m_parent), target);
+}
+
 //---------------------------------------------------------------------------
 // StoragePropertySet::CopyTo
 //
@@ -328,6 +414,8 @@ void StoragePropertySet::default::set(String^ name, Object^ value)
 	}
 
 	finally { PropVariantClear(&varValue); }		// Always release VARIANT
+
+	UpdateIndex(name, value);						// Update any index
 }
 
 //---------------------------------------------------------------------------
@@ -544,7 +632,15 @@ void StoragePropertySet::Name::set(String^ value)
 	if(value == nullptr) throw gcnew ArgumentNullException();
 	if(m_readOnly) throw gcnew PropertySetReadOnlyException();
 	
+	String^ oldName = Name;
 	m_parent->PropertySetNameMapper->RenameMapping(m_fmtid, value);
+
+	// Indexes are keyed by property set name, so this set may have moved
+	// out of one set of indexes and into another one
+
+	String^ path = StoragePropertyIndex::GetPath(m_parent);
+	if(m_root->PropertyIndex->Contains(oldName)) m_root->PropertyIndex->UpdateAll(oldName, path, nullptr);
+	if(m_root->PropertyIndex->Contains(value)) m_root->PropertyIndex->UpdateAll(value, path, this);
 }
 
 //---------------------------------------------------------------------------
@@ -580,9 +676,31 @@ bool StoragePropertySet::Remove(String^ name)
 	hResult = m_propStorage->DeleteMultiple(1, &propspec);
 	if(SUCCEEDED(hResult)) m_propStorage->Commit(STGC_DEFAULT);
 
+	if(SUCCEEDED(hResult)) UpdateIndex(name, nullptr);
+
 	return (SUCCEEDED(hResult));
 }
 
+//---------------------------------------------------------------------------
+// StoragePropertySet::UpdateIndex (private)
+//
+// Updates the property value index after a property has been changed.  The
+// value is read back so that the index holds what the property set returns
+//
+// Arguments:
+//
+//	name		- Name of the property that was changed
+//	value		- New property value, or NULLPTR if it was removed
+
+void StoragePropertySet::UpdateIndex(String^ name, Object^ value)
+{
+	String^ setName = Name;
+	if(!m_root->PropertyIndex->Contains(setName)) return;
+
+	m_root->PropertyIndex->Update(setName, name, StoragePropertyIndex::GetPath(m_parent), 
+		(value == nullptr) ? nullptr : this[name]);
+}
+
 //---------------------------------------------------------------------------
 
 END_ROOT_NAMESPACE(zuki::storage)
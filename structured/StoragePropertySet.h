@@ -38,6 +38,14 @@ using namespace System::Runtime::InteropServices;
 
 BEGIN_ROOT_NAMESPACE(zuki::storage)
 
+//---------------------------------------------------------------------------
+// Forward Class Declarations
+//
+// Include the specified header files in the .CPP file for this class
+//---------------------------------------------------------------------------
+
+ref class StructuredStorage;					// <-- StructuredStorage.h
+
 //---------------------------------------------------------------------------
 // Class StoragePropertySet
 //
@@ -100,7 +108,15 @@ public:
 internal:
 
 	// INTERNAL CONSTRUCTOR
-	StoragePropertySet(ComStorage^ parent, ComPropertyStorage^ propStorage);
+	StoragePropertySet(StructuredStorage^ root, ComStorage^ parent, ComPropertyStorage^ propStorage);
+
+	//-----------------------------------------------------------------------
+	// Internal Member Functions
+
+	// CopyPropertiesTo
+	//
+	// Copies every property, including its name, into another property set
+	void CopyPropertiesTo(StoragePropertySet^ target);
 
 	//-----------------------------------------------------------------------
 	// Constants
@@ -126,6 +142,7 @@ private:
 	void		AddItem(String^, Object^);
 	bool		IsValidPropertyDataType(Type^ type);
 	String^		LookupIndex(int index);
+	void		UpdateIndex(String^ name, Object^ value);
 
 	List<KeyValuePair<String^, Object^>>^ GenerateList(void);
 
@@ -152,6 +169,7 @@ private:
 	// Member Variables
 
 	bool						m_disposed;			// Object disposal flag
+	StructuredStorage^			m_root;				// Root storage instance
 	ComStorage^					m_parent;			// Parent ComStorage
 	ComPropertyStorage^			m_propStorage;		// Contained ComPropertyStorage
 	bool						m_readOnly;			// Read-Only flag
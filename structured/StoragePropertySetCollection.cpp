@@ -43,7 +43,7 @@ StoragePropertySetCollection::StoragePropertySetCollection(StructuredStorage^ ro
 	if(m_root == nullptr) throw gcnew ArgumentNullException();	
 	if(m_storage == nullptr) throw gcnew ArgumentNullException();
 
-	m_readOnly = StorageUtil::IsStorageReadOnly(m_storage);
+	m_readOnly = m_storage->ReadOnly;
 }
 
 //---------------------------------------------------------------------------
@@ -76,13 +76,13 @@ StoragePropertySet^ StoragePropertySetCollection::Add(String^ name)
 	// it's name and GUID to the name mapper as well
 
 	hResult = m_storage->CreatePropertySet(StorageUtil::SysGuidToUUID(propsetid), 
-		NULL, PROPSETFLAG_DEFAULT, STGM_CREATE | StorageUtil::GetStorageMode(m_storage), &pPropStorage);
+		NULL, PROPSETFLAG_DEFAULT, STGM_CREATE | m_storage->ChildMode, &pPropStorage);
 	if(FAILED(hResult)) throw gcnew StorageException(hResult, name);
 
 	// Create the IPropertyStorage wrapper and release the raw pointer.  If something
 	// goes wrong from here, it will release itself automatically on finalization
 
-	propStorage = gcnew ComPropertyStorage(pPropStorage);
+	propStorage = gcnew ComPropertyStorage(pPropStorage, m_storage->Statistics);
 	pPropStorage->Release();
 
 	// Attempt to add the new pointer wrapper into the cache, and be sure to delete
@@ -92,7 +92,7 @@ StoragePropertySet^ StoragePropertySetCollection::Add(String^ name)
 	catch(Exception^) { m_storage->DeletePropertySet(StorageUtil::SysGuidToUUID(propsetid)); throw; }
 
 	m_storage->PropertySetNameMapper->AddMapping(name, propsetid);
-	return gcnew StoragePropertySet(m_storage, propStorage);
+	return gcnew StoragePropertySet(m_root, m_storage, propStorage);
 }
 
 //---------------------------------------------------------------------------
@@ -124,6 +124,11 @@ void StoragePropertySetCollection::Clear(void)
 		// Remove the mapping from the container's property set mapper
 
 		m_storage->PropertySetNameMapper->RemoveMapping(item.Value);
+
+		// Drop the removed property set from any property value indexes
+
+		if(m_root->PropertyIndex->Contains(item.Key))
+			m_root->PropertyIndex->UpdateAll(item.Key, StoragePropertyIndex::GetPath(m_storage), nullptr);
 	}
 }
 
@@ -269,25 +274,25 @@ StoragePropertySet^ StoragePropertySetCollection::default::get(Guid propsetid)
 	// can get a copy of that pointer and just wrap with a new class
 
 	if(m_root->ComPropStorageCache->TryGetValue(propsetid, propStorage))
-		return gcnew StoragePropertySet(m_storage, propStorage);
+		return gcnew StoragePropertySet(m_root, m_storage, propStorage);
 
 	// This property set hasn't been cached, so we need to actually open it up
 
 	hResult = m_storage->OpenPropertySet(StorageUtil::SysGuidToUUID(propsetid), 
-		StorageUtil::GetStorageMode(m_storage), &pPropStorage);
+		m_storage->ChildMode, &pPropStorage);
 	if(FAILED(hResult)) throw gcnew StorageException(hResult);
 
 	// Wrap the new IPropertyStorage pointer up, and release our local 
 	// reference to it.  The ComPropertyStorage maintains it from here on
 
-	propStorage = gcnew ComPropertyStorage(pPropStorage);
+	propStorage = gcnew ComPropertyStorage(pPropStorage, m_storage->Statistics);
 	pPropStorage->Release();
 
 	// Insert the new pointer wrapper into cache (hence the lock), and
 	// return a brand new StoragePropertySet back to the caller
 
 	m_root->ComPropStorageCache->Add(propsetid, propStorage);
-	return gcnew StoragePropertySet(m_storage, propStorage);
+	return gcnew StoragePropertySet(m_root, m_storage, propStorage);
 }
 
 //---------------------------------------------------------------------------
@@ -386,6 +391,10 @@ bool StoragePropertySetCollection::Remove(String^ name)
 	if(FAILED(hResult)) throw gcnew StorageException(hResult, name);
 
 	m_storage->PropertySetNameMapper->RemoveMapping(name);		// Remove mapping
+
+	if(m_root->PropertyIndex->Contains(name))
+		m_root->PropertyIndex->UpdateAll(name, StoragePropertyIndex::GetPath(m_storage), nullptr);
+
 	return true;											// Success
 }
 
@@ -40,8 +40,6 @@ BEGIN_ROOT_NAMESPACE(zuki::storage)
 StoragePropertySetEnumerator::StoragePropertySetEnumerator(StructuredStorage^ root, 
 	ComStorage^ storage) : m_root(root), m_storage(storage), m_current(-1)
 {
-	Generic::ICollection<Guid>^		guids;		// Enumerated storage GUIDs
-
 	if(m_root == nullptr) throw gcnew ArgumentNullException();
 	if(m_storage == nullptr) throw gcnew ArgumentNullException();
 
@@ -50,9 +48,7 @@ StoragePropertySetEnumerator::StoragePropertySetEnumerator(StructuredStorage^ ro
 	// the name mapper to see if that thing is valid.  NOW it just asks the name mapper
 	// for everything it knows about, saving both execution time and resources
 
-	guids = m_storage->PropertySetNameMapper->ToDictionary()->Values;
-	m_items = gcnew array<Guid>(guids->Count);
-	if(m_items->Length > 0) guids->CopyTo(m_items, 0);
+	m_items = m_storage->PropertySetNameMapper->ToGuidArray();
 }
 
 //---------------------------------------------------------------------------
@@ -71,8 +67,6 @@ StoragePropertySet^ StoragePropertySetEnumerator::Current::get(void)
 	Guid					propsetid;			// Property set ID code
 	ComPropertyStorage^		propStorage;		// ComPropertyStorage instance
 	IPropertyStorage*		pPropStorage;		// Pointer to the property storage
-	String^					name;				// BASE64 object name
-	PinnedStringPtr			pinName;			// Pinned object name
 	HRESULT					hResult;			// Result from function call
 
 	CHECK_DISPOSED(m_disposed || m_storage->IsDisposed());
@@ -89,28 +83,24 @@ StoragePropertySet^ StoragePropertySetEnumerator::Current::get(void)
 	// can get a copy of that pointer and just wrap with a new class
 
 	if(m_root->ComPropStorageCache->TryGetValue(propsetid, propStorage))
-		return gcnew StoragePropertySet(m_storage, propStorage);
-
-	// The interface hasn't been cached (or is dead), so we need to make a new one
-
-	name = StorageUtil::SysGuidToBase64(propsetid);	// Convert GUID to BASE64
-	pinName = PtrToStringChars(name);				// Pin it down
+		return gcnew StoragePropertySet(m_root, m_storage, propStorage);
 
+	// The interface hasn't been cached (or is dead), so we need to make a new one.
 	// Attempt to open up the object's IPropertyStorage interface using the same mode
 	// flags as the parent IStorage interface
 
 	hResult = m_storage->OpenPropertySet(StorageUtil::SysGuidToUUID(propsetid), 
-		StorageUtil::GetStorageMode(m_storage), &pPropStorage);
+		m_storage->ChildMode, &pPropStorage);
 	if(FAILED(hResult)) throw gcnew StorageException(hResult, propsetid.ToString("D"));
 
 	// Create a new ComPropertyStorage wrapper for the property set, and cache it
 	// off in case anyone else tries to access it later on ...
 
-	propStorage = gcnew ComPropertyStorage(pPropStorage);
+	propStorage = gcnew ComPropertyStorage(pPropStorage, m_storage->Statistics);
 	pPropStorage->Release();
 
 	m_root->ComPropStorageCache->Add(propsetid, propStorage);
-	return gcnew StoragePropertySet(m_storage, propStorage);
+	return gcnew StoragePropertySet(m_root, m_storage, propStorage);
 }
 
 //---------------------------------------------------------------------------
@@ -0,0 +1,370 @@
+//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+#include "stdafx.h"						// Include project pre-compiled headers
+#include "StorageSealedIndex.h"			// Include StorageSealedIndex declarations
+#include "StorageContainer.h"			// Include StorageContainer declarations
+
+#pragma warning(push, 4)				// Enable maximum compiler warnings
+
+BEGIN_ROOT_NAMESPACE(zuki::storage)
+
+//---------------------------------------------------------------------------
+// StorageSealedIndex Constructor (private)
+//
+// Arguments:
+//
+//	seeds		- Second hash seed for each bucket
+//	keys		- Key stored in each slot
+//	chains		- GUID chain stored in each slot
+
+StorageSealedIndex::StorageSealedIndex(array<int>^ seeds, array<String^>^ keys, array<array<Guid>^>^ chains) :
+	m_seeds(seeds), m_keys(keys), m_chains(chains)
+{
+	if(seeds == nullptr) throw gcnew ArgumentNullException("seeds");
+	if(keys == nullptr) throw gcnew ArgumentNullException("keys");
+	if(chains == nullptr) throw gcnew ArgumentNullException("chains");
+}
+
+//---------------------------------------------------------------------------
+// StorageSealedIndex::Collect (private, static)
+//
+// Gathers the keys and GUID chains of every object and container in a
+// container tree.  Names that can't be written as part of a path are left
+// out, they can still be reached through the collections
+//
+// Arguments:
+//
+//	container	- Container to start from
+//	path		- Path of the container
+//	chain		- GUID chain of the container
+//	entries		- Collected KEY->GUID chain entries
+
+void StorageSealedIndex::Collect(StorageContainer^ container, String^ path, List<Guid>^ chain, 
+	Dictionary<String^, array<Guid>^>^ entries)
+{
+	array<wchar_t>^ separators = gcnew array<wchar_t>{ L'/', L'\\' };
+
+	for each(KeyValuePair<String^, Guid> item in container->Objects->ToDictionary()) {
+
+		if((item.Key->Length == 0) || (item.Key->IndexOfAny(separators) >= 0)) continue;
+
+		chain->Add(item.Value);
+		entries[GetKey(true, (path->Length == 0) ? item.Key : String::Concat(path, "/", item.Key))] = chain->ToArray();
+		chain->RemoveAt(chain->Count - 1);
+	}
+
+	for each(KeyValuePair<String^, Guid> item in container->Containers->ToDictionary()) {
+
+		if((item.Key->Length == 0) || (item.Key->IndexOfAny(separators) >= 0)) continue;
+
+		String^ subpath = (path->Length == 0) ? item.Key : String::Concat(path, "/", item.Key);
+
+		chain->Add(item.Value);
+		entries[GetKey(false, subpath)] = chain->ToArray();
+		Collect(container->Containers[item.Value], subpath, chain, entries);
+		chain->RemoveAt(chain->Count - 1);
+	}
+}
+
+//---------------------------------------------------------------------------
+// StorageSealedIndex::Create (static)
+//
+// Builds the index for a container tree and writes it into a new hidden
+// stream in a storage.  The buckets with the most keys are placed first,
+// while there are still plenty of free slots for them to land in
+//
+// Arguments:
+//
+//	root		- Root container of the tree to be indexed
+//	storage		- Storage to write the index stream into
+
+void StorageSealedIndex::Create(StorageContainer^ root, ComStorage^ storage)
+{
+	String^					name = INDEX_STREAM_NAME;	// Stream name
+	PinnedStringPtr			pinName;			// Pinned stream name
+	array<Byte>^			buffer;				// Serialized index
+	PinnedBytePtr			pinBuffer;			// Pinned buffer pointer
+	IStream*				pStream;			// Index stream
+	int						seed;				// Seed for a bucket
+	unsigned int			slot;				// Slot for a key
+	bool					placed;				// Flag if bucket was placed
+	HRESULT					hResult;			// Result from function call
+
+	if(root == nullptr) throw gcnew ArgumentNullException("root");
+	if(storage == nullptr) throw gcnew ArgumentNullException("storage");
+
+	Dictionary<String^, array<Guid>^>^ entries = gcnew Dictionary<String^, array<Guid>^>(StringComparer::Ordinal);
+	Collect(root, String::Empty, gcnew List<Guid>(), entries);
+
+	int count = entries->Count;
+	int buckets = Math::Max(1, (count + BUCKET_SIZE - 1) / BUCKET_SIZE);
+
+	array<int>^ seeds = gcnew array<int>(buckets);
+	array<String^>^ keys = gcnew array<String^>(count);
+	array<array<Guid>^>^ chains = gcnew array<array<Guid>^>(count);
+
+	// Distribute the keys into the buckets with the first hash, and sort the
+	// bucket numbers so that the biggest buckets come first
+
+	array<List<String^>^>^ members = gcnew array<List<String^>^>(buckets);
+	array<int>^ sizes = gcnew array<int>(buckets);
+	array<int>^ order = gcnew array<int>(buckets);
+
+	for(int index = 0; index < buckets; index++) { members[index] = gcnew List<String^>(); order[index] = index; }
+
+	for each(String^ key in entries->Keys) {
+
+		int bucket = static_cast<int>(Hash(key, 0) % static_cast<unsigned int>(buckets));
+		members[bucket]->Add(key);
+		sizes[bucket]--;
+	}
+
+	Array::Sort(sizes, order);
+
+	// Find a seed for each bucket that sends every one of it's keys to a slot
+	// that's still free without any of them colliding with each other
+
+	array<bool>^ taken = gcnew array<bool>(count);
+	List<int>^ slots = gcnew List<int>();
+
+	for each(int bucket in order) {
+
+		if(members[bucket]->Count == 0) break;
+
+		for(seed = 1, placed = false; (!placed) && (seed <= MAX_SEED); seed++) {
+
+			slots->Clear();
+			placed = true;
+
+			for each(String^ key in members[bucket]) {
+
+				slot = Hash(key, static_cast<unsigned int>(seed)) % static_cast<unsigned int>(count);
+				if(taken[slot] || slots->Contains(static_cast<int>(slot))) { placed = false; break; }
+				slots->Add(static_cast<int>(slot));
+			}
+		}
+
+		if(!placed) throw gcnew InvalidOperationException();
+
+		seeds[bucket] = seed - 1;
+		for(int index = 0; index < slots->Count; index++) {
+
+			taken[slots[index]] = true;
+			keys[slots[index]] = members[bucket][index];
+			chains[slots[index]] = entries[members[bucket][index]];
+		}
+	}
+
+	// FORMAT: [INT32 version][INT32 slots][INT32 buckets][INT32 seed x buckets],
+	// then for each slot [STRING key][INT32 chain length][GUID x chain length]
+
+	MemoryStream^ stream = gcnew MemoryStream();
+	BinaryWriter^ writer = gcnew BinaryWriter(stream);
+
+	writer->Write(INDEX_VERSION);
+	writer->Write(count);
+	writer->Write(buckets);
+	for each(int value in seeds) writer->Write(value);
+
+	for(int index = 0; index < count; index++) {
+
+		writer->Write(keys[index]);
+		writer->Write(chains[index]->Length);
+		for each(Guid guid in chains[index]) writer->Write(guid.ToByteArray());
+	}
+
+	writer->Flush();
+	buffer = stream->ToArray();
+
+	pinName = PtrToStringChars(name);
+	hResult = storage->CreateStream(pinName, storage->ChildMode | STGM_CREATE, 0, 0, &pStream);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	try {
+
+		pinBuffer = &buffer[0];
+		hResult = pStream->Write(pinBuffer, static_cast<ULONG>(buffer->Length), NULL);
+		if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	}
+
+	finally { pStream->Release(); }
+}
+
+//---------------------------------------------------------------------------
+// StorageSealedIndex::GetKey (static)
+//
+// Generates the index key for a container or object path.  Names are not
+// case-sensitive, and a container and an object can have the same path
+//
+// Arguments:
+//
+//	object		- Flag if the path is to an object rather than a container
+//	path		- Slash separated path from the root
+
+String^ StorageSealedIndex::GetKey(bool object, String^ path)
+{
+	if(path == nullptr) throw gcnew ArgumentNullException("path");
+	return String::Concat(object ? "O:" : "C:", path->ToUpperInvariant());
+}
+
+//---------------------------------------------------------------------------
+// StorageSealedIndex::Hash (private, static)
+//
+// Hashes an index key with a seed value: FNV-1a over the characters of the
+// key followed by the MurmurHash3 finalizer to spread the seeds out
+//
+// Arguments:
+//
+//	key			- Key to be hashed
+//	seed		- Seed value
+
+unsigned int StorageSealedIndex::Hash(String^ key, unsigned int seed)
+{
+	unsigned int hash = 2166136261U ^ seed;
+
+	for(int index = 0; index < key->Length; index++) hash = (hash ^ key[index]) * 16777619U;
+
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6BU;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE35U;
+	hash ^= hash >> 16;
+
+	return hash;
+}
+
+//---------------------------------------------------------------------------
+// StorageSealedIndex::Load (static)
+//
+// Loads the index from the hidden stream in a storage
+//
+// Arguments:
+//
+//	storage		- Storage to read the index stream from
+
+StorageSealedIndex^ StorageSealedIndex::Load(ComStorage^ storage)
+{
+	String^					name = INDEX_STREAM_NAME;	// Stream name
+	PinnedStringPtr			pinName;			// Pinned stream name
+	IStream*				pStream;			// Index stream
+	STATSTG					statstg;			// Stream statistics
+	array<Byte>^			buffer;				// Contents of the stream
+	PinnedBytePtr			pinBuffer;			// Pinned buffer pointer
+	ULONG					cbRead;				// Number of bytes read
+	int						total = 0;			// Total number of bytes read
+	HRESULT					hResult;			// Result from function call
+
+	if(storage == nullptr) throw gcnew ArgumentNullException("storage");
+
+	// A storage that was never sealed doesn't have the stream at all
+
+	pinName = PtrToStringChars(name);
+	hResult = storage->OpenStream(pinName, NULL, storage->ChildMode, 0, &pStream);
+	if(hResult == STG_E_FILENOTFOUND) return nullptr;
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	try {
+
+		hResult = pStream->Stat(&statstg, STATFLAG_NONAME);
+		if(FAILED(hResult)) throw gcnew StorageException(hResult);
+		if(statstg.cbSize.QuadPart > Int32::MaxValue) throw gcnew ObjectTooLargeException();
+
+		buffer = gcnew array<Byte>(static_cast<int>(statstg.cbSize.QuadPart));
+		if(buffer->Length == 0) return nullptr;
+
+		pinBuffer = &buffer[0];
+
+		while(total < buffer->Length) {
+
+			hResult = pStream->Read(pinBuffer + total, static_cast<ULONG>(buffer->Length - total), &cbRead);
+			if(FAILED(hResult)) throw gcnew StorageException(hResult);
+			if(cbRead == 0) break;
+
+			total += static_cast<int>(cbRead);
+		}
+
+		pinBuffer = nullptr;
+	}
+
+	finally { pStream->Release(); }
+
+	BinaryReader^ reader = gcnew BinaryReader(gcnew MemoryStream(buffer, 0, total, false));
+
+	if((total < 12) || (reader->ReadInt32() != INDEX_VERSION)) return nullptr;
+
+	int count = reader->ReadInt32();
+	int buckets = reader->ReadInt32();
+	if((count < 0) || (buckets < 1)) throw gcnew InvalidDataException();
+
+	array<int>^ seeds = gcnew array<int>(buckets);
+	array<String^>^ keys = gcnew array<String^>(count);
+	array<array<Guid>^>^ chains = gcnew array<array<Guid>^>(count);
+
+	for(int index = 0; index < buckets; index++) seeds[index] = reader->ReadInt32();
+
+	for(int index = 0; index < count; index++) {
+
+		keys[index] = reader->ReadString();
+		chains[index] = gcnew array<Guid>(reader->ReadInt32());
+		for(int link = 0; link < chains[index]->Length; link++) chains[index][link] = Guid(reader->ReadBytes(16));
+	}
+
+	return gcnew StorageSealedIndex(seeds, keys, chains);
+}
+
+//---------------------------------------------------------------------------
+// StorageSealedIndex::TryLookup
+//
+// Looks up the chain of GUIDs that leads from the root to an element.  The
+// perfect hash sends every key in the index to it's own slot, but any other
+// key lands on some slot too, so the stored key still has to be compared
+//
+// Arguments:
+//
+//	key			- Index key generated by GetKey()
+//	chain		- On success, receives the GUID chain for the element
+
+bool StorageSealedIndex::TryLookup(String^ key, array<Guid>^% chain)
+{
+	unsigned int			bucket;				// Bucket for the key
+	unsigned int			slot;				// Slot for the key
+
+	chain = nullptr;
+
+	if(key == nullptr) throw gcnew ArgumentNullException("key");
+	if(m_keys->Length == 0) return false;
+
+	bucket = Hash(key, 0) % static_cast<unsigned int>(m_seeds->Length);
+	slot = Hash(key, static_cast<unsigned int>(m_seeds[bucket])) % static_cast<unsigned int>(m_keys->Length);
+
+	if(!String::Equals(m_keys[slot], key, StringComparison::Ordinal)) return false;
+
+	chain = m_chains[slot];
+	return true;
+}
+
+//---------------------------------------------------------------------------
+
+END_ROOT_NAMESPACE(zuki::storage)
+
+#pragma warning(pop)
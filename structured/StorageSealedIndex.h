@@ -0,0 +1,145 @@
+//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+#ifndef __STORAGESEALEDINDEX_H_
+#define __STORAGESEALEDINDEX_H_
+#pragma once
+
+#include "ComStorage.h"					// Include ComStorage declarations
+#include "StorageException.h"			// Include StorageException decls
+#include "StorageExceptions.h"			// Include StorageExceptions decls
+
+#pragma warning(push, 4)				// Enable maximum compiler warnings
+
+using namespace System;
+using namespace System::Collections::Generic;
+using namespace System::IO;
+
+BEGIN_ROOT_NAMESPACE(zuki::storage)
+
+//---------------------------------------------------------------------------
+// Forward Class Declarations
+//
+// Include the specified header files in the .CPP file for this class
+//---------------------------------------------------------------------------
+
+ref class StorageContainer;					// <-- StorageContainer.h
+
+//---------------------------------------------------------------------------
+// Class StorageSealedIndex (internal)
+//
+// StorageSealedIndex implements the name index embedded in a sealed storage.
+// Every container and object path in the file is a key of a minimal perfect
+// hash (hash and displace): the first hash of a key picks a bucket, and the
+// seed stored for that bucket gives a second hash that lands on the key's own
+// slot with no collisions.  Each slot holds the key and the chain of GUIDs
+// that leads to the element from the root, so a lookup is two hashes and one
+// string compare and never touches a name mapper.
+//
+// The index is only ever written once, when the storage is sealed, so there
+// is no support for changing it afterwards.
+//---------------------------------------------------------------------------
+
+ref class StorageSealedIndex sealed
+{
+public:
+
+	//-----------------------------------------------------------------------
+	// Member Functions
+
+	// Create (static)
+	//
+	// Builds the index for a container tree and writes it into a storage
+	static void Create(StorageContainer^ root, ComStorage^ storage);
+
+	// GetKey (static)
+	//
+	// Generates the index key for a container or object path
+	static String^ GetKey(bool object, String^ path);
+
+	// Load (static)
+	//
+	// Loads the index from a storage, or returns null if there isn't one
+	static StorageSealedIndex^ Load(ComStorage^ storage);
+
+	// TryLookup
+	//
+	// Looks up the chain of GUIDs that leads to an element
+	bool TryLookup(String^ key, array<Guid>^% chain);
+
+private:
+
+	// PRIVATE CONSTRUCTOR
+	StorageSealedIndex(array<int>^ seeds, array<String^>^ keys, array<array<Guid>^>^ chains);
+
+	//-----------------------------------------------------------------------
+	// Private Constants
+
+	// BUCKET_SIZE
+	//
+	// Average number of keys in each bucket of the hash
+	literal int BUCKET_SIZE = 4;
+
+	// INDEX_STREAM_NAME
+	//
+	// Name of the hidden stream that holds the index
+	literal String^ INDEX_STREAM_NAME = "SealedIndex";
+
+	// INDEX_VERSION
+	//
+	// Version of the hidden stream format
+	literal int INDEX_VERSION = 1;
+
+	// MAX_SEED
+	//
+	// Highest seed tried for a bucket before giving up on building the hash
+	literal int MAX_SEED = 0x00FFFFFF;
+
+	//-----------------------------------------------------------------------
+	// Private Member Functions
+
+	// Collect (static)
+	//
+	// Gathers the keys and GUID chains of every element in a container tree
+	static void Collect(StorageContainer^ container, String^ path, List<Guid>^ chain, 
+		Dictionary<String^, array<Guid>^>^ entries);
+
+	// Hash (static)
+	//
+	// Hashes an index key with a seed value
+	static unsigned int Hash(String^ key, unsigned int seed);
+
+	//-----------------------------------------------------------------------
+	// Member Variables
+
+	initonly array<int>^				m_seeds;		// Per-bucket seeds
+	initonly array<String^>^			m_keys;			// Key in each slot
+	initonly array<array<Guid>^>^		m_chains;		// GUID chain in each slot
+};
+
+//---------------------------------------------------------------------------
+
+END_ROOT_NAMESPACE(zuki::storage)
+
+#pragma warning(pop)
+
+#endif	// __STORAGESEALEDINDEX_H_
@@ -0,0 +1,146 @@
+//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+#include "stdafx.h"							// Include project pre-compiled headers
+#include "StorageStatistics.h"				// Include StorageStatistics declarations
+
+#pragma warning(push, 4)					// Enable maximum compiler warnings
+
+BEGIN_ROOT_NAMESPACE(zuki::storage)
+
+//---------------------------------------------------------------------------
+// StorageStatistics Constructor (internal)
+//
+// Arguments:
+//
+//	NONE
+
+StorageStatistics::StorageStatistics()
+{
+	m_counters = gcnew array<__int64>(COUNTER_MAX);
+	m_latency = gcnew array<__int64>(HISTOGRAM_MAX * LatencyBuckets);
+}
+
+//---------------------------------------------------------------------------
+// StorageStatistics Constructor (private)
+//
+// Arguments:
+//
+//	source			- StorageStatistics instance to take a snapshot of
+
+StorageStatistics::StorageStatistics(StorageStatistics^ source)
+{
+	if(source == nullptr) throw gcnew ArgumentNullException();
+
+	m_counters = gcnew array<__int64>(COUNTER_MAX);
+	m_latency = gcnew array<__int64>(HISTOGRAM_MAX * LatencyBuckets);
+
+	// Each value is read atomically, but the set as a whole isn't; calls that
+	// complete while the copy is being made may or may not be reflected in it
+
+	for(int index = 0; index < m_counters->Length; index++) 
+		m_counters[index] = Interlocked::Read(source->m_counters[index]);
+
+	for(int index = 0; index < m_latency->Length; index++)
+		m_latency[index] = Interlocked::Read(source->m_latency[index]);
+}
+
+//---------------------------------------------------------------------------
+// StorageStatistics::GetHistogram (private)
+//
+// Creates a copy of one of the latency histograms
+//
+// Arguments:
+//
+//	histogram		- Index of the histogram to be copied
+
+array<__int64>^ StorageStatistics::GetHistogram(int histogram)
+{
+	array<__int64>^ buckets = gcnew array<__int64>(LatencyBuckets);
+
+	for(int index = 0; index < LatencyBuckets; index++)
+		buckets[index] = Interlocked::Read(m_latency[(histogram * LatencyBuckets) + index]);
+
+	return buckets;
+}
+
+//---------------------------------------------------------------------------
+// StorageStatistics::RecordCall (private)
+//
+// Increments a call counter and the latency histogram bucket for a call
+//
+// Arguments:
+//
+//	counter			- Index of the call counter to be incremented
+//	histogram		- Index of the latency histogram to be updated
+//	start			- Stopwatch timestamp taken before the call was made
+
+void StorageStatistics::RecordCall(int counter, int histogram, __int64 start)
+{
+	__int64				micros;				// Elapsed time in microseconds
+	int					bucket = 0;			// Latency histogram bucket
+
+	micros = ((Stopwatch::GetTimestamp() - start) * 1000000) / Stopwatch::Frequency;
+
+	// The bucket is the number of significant bits in the elapsed microseconds,
+	// anything that doesn't fit into the histogram goes into the last bucket
+
+	while((micros > 0) && (bucket < LatencyBuckets - 1)) { micros >>= 1; bucket++; }
+
+	Interlocked::Increment(m_counters[counter]);
+	Interlocked::Increment(m_latency[(histogram * LatencyBuckets) + bucket]);
+}
+
+//---------------------------------------------------------------------------
+// StorageStatistics::Reset
+//
+// Resets all of the counters and histograms back to zero
+//
+// Arguments:
+//
+//	NONE
+
+void StorageStatistics::Reset(void)
+{
+	for(int index = 0; index < m_counters->Length; index++) Interlocked::Exchange(m_counters[index], 0);
+	for(int index = 0; index < m_latency->Length; index++) Interlocked::Exchange(m_latency[index], 0);
+}
+
+//---------------------------------------------------------------------------
+// StorageStatistics::Snapshot
+//
+// Creates a point-in-time copy of the statistics that no longer changes
+//
+// Arguments:
+//
+//	NONE
+
+StorageStatistics^ StorageStatistics::Snapshot(void)
+{
+	return gcnew StorageStatistics(this);
+}
+
+//---------------------------------------------------------------------------
+
+END_ROOT_NAMESPACE(zuki::storage)
+
+#pragma warning(pop)
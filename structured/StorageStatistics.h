@@ -0,0 +1,328 @@
+//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+#ifndef __STORAGESTATISTICS_H_
+#define __STORAGESTATISTICS_H_
+#pragma once
+
+#pragma warning(push, 4)				// Enable maximum compiler warnings
+
+using namespace System;
+using namespace System::Diagnostics;
+using namespace System::Threading;
+
+BEGIN_ROOT_NAMESPACE(zuki::storage)
+
+//---------------------------------------------------------------------------
+// Class StorageStatistics
+//
+// StorageStatistics collects runtime counters for a single StructuredStorage
+// instance: the number and latency of the calls made through the COM pointer
+// wrappers, the ComCache hit/miss/eviction counts, name mapper activity, the
+// stream page cache hit/miss counts and the number of bytes read from and
+// written to streams.  All counters are updated with Interlocked operations,
+// so collecting them never takes a lock.
+//
+// Latencies are kept as log2 histograms of microseconds; bucket zero counts
+// calls that took less than one microsecond and bucket N counts calls that
+// took at least 2^(N-1) but less than 2^N microseconds.  The last bucket
+// also counts everything that was slower than that
+//---------------------------------------------------------------------------
+
+STRUCTURED_STORAGE_PUBLIC ref class StorageStatistics sealed
+{
+public:
+
+	//-----------------------------------------------------------------------
+	// Fields
+
+	// LatencyBuckets
+	//
+	// Number of buckets in each of the latency histograms
+	literal int LatencyBuckets = 32;
+
+	//-----------------------------------------------------------------------
+	// Member Functions
+
+	// Reset
+	//
+	// Resets all of the counters and histograms back to zero
+	void Reset(void);
+
+	// Snapshot
+	//
+	// Creates a point-in-time copy of the statistics that no longer changes
+	StorageStatistics^ Snapshot(void);
+
+	//-----------------------------------------------------------------------
+	// Properties
+
+	// BytesRead
+	//
+	// Gets the number of bytes that have been read from streams
+	property __int64 BytesRead
+	{
+		__int64 get(void) { return Interlocked::Read(m_counters[COUNTER_BYTESREAD]); }
+	}
+
+	// BytesWritten
+	//
+	// Gets the number of bytes that have been written into streams
+	property __int64 BytesWritten
+	{
+		__int64 get(void) { return Interlocked::Read(m_counters[COUNTER_BYTESWRITTEN]); }
+	}
+
+	// CacheEvictions
+	//
+	// Gets the number of cached pointers that were collected before reuse
+	property __int64 CacheEvictions
+	{
+		__int64 get(void) { return Interlocked::Read(m_counters[COUNTER_CACHEEVICTIONS]); }
+	}
+
+	// CacheHits
+	//
+	// Gets the number of ComCache lookups that found a live pointer
+	property __int64 CacheHits
+	{
+		__int64 get(void) { return Interlocked::Read(m_counters[COUNTER_CACHEHITS]); }
+	}
+
+	// CacheMisses
+	//
+	// Gets the number of ComCache lookups that did not find a live pointer
+	property __int64 CacheMisses
+	{
+		__int64 get(void) { return Interlocked::Read(m_counters[COUNTER_CACHEMISSES]); }
+	}
+
+	// MapperLookups
+	//
+	// Gets the number of NAME->GUID and GUID->NAME lookups performed
+	property __int64 MapperLookups
+	{
+		__int64 get(void) { return Interlocked::Read(m_counters[COUNTER_MAPPERLOOKUPS]); }
+	}
+
+	// MapperScans
+	//
+	// Gets the number of times a name mapper property set was enumerated
+	property __int64 MapperScans
+	{
+		__int64 get(void) { return Interlocked::Read(m_counters[COUNTER_MAPPERSCANS]); }
+	}
+
+	// PageCacheHits
+	//
+	// Gets the number of stream pages that were read from a page cache
+	property __int64 PageCacheHits
+	{
+		__int64 get(void) { return Interlocked::Read(m_counters[COUNTER_PAGECACHEHITS]); }
+	}
+
+	// PageCacheMisses
+	//
+	// Gets the number of stream pages that had to be read into a page cache
+	property __int64 PageCacheMisses
+	{
+		__int64 get(void) { return Interlocked::Read(m_counters[COUNTER_PAGECACHEMISSES]); }
+	}
+
+	// PropertyStorageCalls
+	//
+	// Gets the number of calls made through ComPropertyStorage
+	property __int64 PropertyStorageCalls
+	{
+		__int64 get(void) { return Interlocked::Read(m_counters[COUNTER_PROPSTORAGECALLS]); }
+	}
+
+	// PropertyStorageLatency
+	//
+	// Gets a copy of the ComPropertyStorage call latency histogram
+	property array<__int64>^ PropertyStorageLatency
+	{
+		array<__int64>^ get(void) { return GetHistogram(HISTOGRAM_PROPSTORAGE); }
+	}
+
+	// StorageCalls
+	//
+	// Gets the number of calls made through ComStorage
+	property __int64 StorageCalls
+	{
+		__int64 get(void) { return Interlocked::Read(m_counters[COUNTER_STORAGECALLS]); }
+	}
+
+	// StorageLatency
+	//
+	// Gets a copy of the ComStorage call latency histogram
+	property array<__int64>^ StorageLatency
+	{
+		array<__int64>^ get(void) { return GetHistogram(HISTOGRAM_STORAGE); }
+	}
+
+	// StreamCalls
+	//
+	// Gets the number of calls made through ComStream
+	property __int64 StreamCalls
+	{
+		__int64 get(void) { return Interlocked::Read(m_counters[COUNTER_STREAMCALLS]); }
+	}
+
+	// StreamLatency
+	//
+	// Gets a copy of the ComStream call latency histogram
+	property array<__int64>^ StreamLatency
+	{
+		array<__int64>^ get(void) { return GetHistogram(HISTOGRAM_STREAM); }
+	}
+
+internal:
+
+	//-----------------------------------------------------------------------
+	// Internal Constructor
+
+	StorageStatistics();
+
+	//-----------------------------------------------------------------------
+	// Internal Member Functions
+
+	// AddBytesRead
+	//
+	// Adds to the number of bytes read from streams
+	void AddBytesRead(__int64 bytes) { Interlocked::Add(m_counters[COUNTER_BYTESREAD], bytes); }
+
+	// AddBytesWritten
+	//
+	// Adds to the number of bytes written into streams
+	void AddBytesWritten(__int64 bytes) { Interlocked::Add(m_counters[COUNTER_BYTESWRITTEN], bytes); }
+
+	// CacheEviction
+	//
+	// Counts a cached pointer that was collected before it could be reused
+	void CacheEviction(void) { Interlocked::Increment(m_counters[COUNTER_CACHEEVICTIONS]); }
+
+	// CacheHit
+	//
+	// Counts a ComCache lookup that found a live pointer
+	void CacheHit(void) { Interlocked::Increment(m_counters[COUNTER_CACHEHITS]); }
+
+	// CacheMiss
+	//
+	// Counts a ComCache lookup that did not find a live pointer
+	void CacheMiss(void) { Interlocked::Increment(m_counters[COUNTER_CACHEMISSES]); }
+
+	// MapperLookup
+	//
+	// Counts one or more name mapper lookups
+	void MapperLookup(__int64 count) { Interlocked::Add(m_counters[COUNTER_MAPPERLOOKUPS], count); }
+
+	// MapperScan
+	//
+	// Counts a full enumeration of a name mapper property set
+	void MapperScan(void) { Interlocked::Increment(m_counters[COUNTER_MAPPERSCANS]); }
+
+	// PageCacheHit
+	//
+	// Counts a stream page that was read from a page cache
+	void PageCacheHit(void) { Interlocked::Increment(m_counters[COUNTER_PAGECACHEHITS]); }
+
+	// PageCacheMiss
+	//
+	// Counts a stream page that had to be read into a page cache
+	void PageCacheMiss(void) { Interlocked::Increment(m_counters[COUNTER_PAGECACHEMISSES]); }
+
+	// PropertyStorageCall
+	//
+	// Records a ComPropertyStorage call that started at the specified timestamp
+	void PropertyStorageCall(__int64 start) { RecordCall(COUNTER_PROPSTORAGECALLS, HISTOGRAM_PROPSTORAGE, start); }
+
+	// StorageCall
+	//
+	// Records a ComStorage call that started at the specified timestamp
+	void StorageCall(__int64 start) { RecordCall(COUNTER_STORAGECALLS, HISTOGRAM_STORAGE, start); }
+
+	// StreamCall
+	//
+	// Records a ComStream call that started at the specified timestamp
+	void StreamCall(__int64 start) { RecordCall(COUNTER_STREAMCALLS, HISTOGRAM_STREAM, start); }
+
+private:
+
+	// PRIVATE CONSTRUCTOR
+	StorageStatistics(StorageStatistics^ source);
+
+	//-----------------------------------------------------------------------
+	// Private Constants
+
+	// COUNTER_XXXX
+	//
+	// Indexes into the array of counters
+	literal int COUNTER_BYTESREAD			= 0;
+	literal int COUNTER_BYTESWRITTEN		= 1;
+	literal int COUNTER_CACHEEVICTIONS		= 2;
+	literal int COUNTER_CACHEHITS			= 3;
+	literal int COUNTER_CACHEMISSES			= 4;
+	literal int COUNTER_MAPPERLOOKUPS		= 5;
+	literal int COUNTER_MAPPERSCANS			= 6;
+	literal int COUNTER_PAGECACHEHITS		= 7;
+	literal int COUNTER_PAGECACHEMISSES		= 8;
+	literal int COUNTER_PROPSTORAGECALLS	= 9;
+	literal int COUNTER_STORAGECALLS		= 10;
+	literal int COUNTER_STREAMCALLS			= 11;
+	literal int COUNTER_MAX					= 12;
+
+	// HISTOGRAM_XXXX
+	//
+	// Indexes of the latency histograms in the array of buckets
+	literal int HISTOGRAM_PROPSTORAGE		= 0;
+	literal int HISTOGRAM_STORAGE			= 1;
+	literal int HISTOGRAM_STREAM			= 2;
+	literal int HISTOGRAM_MAX				= 3;
+
+	//-----------------------------------------------------------------------
+	// Private Member Functions
+
+	// GetHistogram
+	//
+	// Creates a copy of one of the latency histograms
+	array<__int64>^ GetHistogram(int histogram);
+
+	// RecordCall
+	//
+	// Increments a call counter and the latency histogram bucket for a call
+	void RecordCall(int counter, int histogram, __int64 start);
+
+	//-----------------------------------------------------------------------
+	// Member Variables
+
+	initonly array<__int64>^	m_counters;			// Counter values
+	initonly array<__int64>^	m_latency;			// Latency histogram buckets
+};
+
+//---------------------------------------------------------------------------
+
+END_ROOT_NAMESPACE(zuki::storage)
+
+#pragma warning(pop)
+
+#endif	// __STORAGESTATISTICS_H_
@@ -0,0 +1,205 @@
+//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+#include "stdafx.h"						// Include project pre-compiled headers
+#include "StorageStreamCache.h"			// Include StorageStreamCache declarations
+
+#pragma warning(push, 4)				// Enable maximum compiler warnings
+
+BEGIN_ROOT_NAMESPACE(zuki::storage)
+
+//---------------------------------------------------------------------------
+// StorageStreamCache Constructor
+//
+// Arguments:
+//
+//	capacity	- Maximum number of pages to keep in the cache
+
+StorageStreamCache::StorageStreamCache(int capacity) : m_capacity(capacity), m_lastPage(-1), m_generation(0)
+{
+	if(capacity < 1) throw gcnew ArgumentOutOfRangeException("capacity");
+
+	m_pages = gcnew Dictionary<__int64, LinkedListNode<Page^>^>(capacity);
+	m_lru = gcnew LinkedList<Page^>();
+	m_lock = gcnew Object();
+}
+
+//---------------------------------------------------------------------------
+// StorageStreamCache::AddPage
+//
+// Adds a page that has been read from the stream into the cache, evicting
+// the least recently used page if the cache is already full.  The cache
+// takes ownership of the data array.  If anything has been invalidated since
+// the page was read, it may be out of date and is silently dropped instead
+//
+// Arguments:
+//
+//	page		- Index of the page within the stream
+//	data		- PAGE_SIZE array containing the page data
+//	length		- Number of valid bytes in the page data
+//	generation	- Value of Generation from before the page was read
+
+void StorageStreamCache::AddPage(__int64 page, array<Byte>^ data, int length, __int64 generation)
+{
+	lock					cs(m_lock);			// Automatic lock
+
+	if(data == nullptr) throw gcnew ArgumentNullException("data");
+	if((length < 0) || (length > data->Length)) throw gcnew ArgumentOutOfRangeException("length");
+
+	if(generation != m_generation) return;		// Page may be stale
+
+	RemovePage(page);							// Replace any existing page
+
+	// There can only ever be one partial page, the one at the end of the
+	// stream, so if a different one is still cached it's out of date
+
+	if((length < PAGE_SIZE) && (m_lastPage >= 0)) RemovePage(m_lastPage);
+
+	while(m_pages->Count >= m_capacity) RemovePage(m_lru->Last->Value->Index);
+
+	m_pages->Add(page, m_lru->AddFirst(gcnew Page(page, data, length)));
+	if(length < PAGE_SIZE) m_lastPage = page;
+}
+
+//---------------------------------------------------------------------------
+// StorageStreamCache::Clear
+//
+// Discards all of the cached pages
+//
+// Arguments:
+//
+//	NONE
+
+void StorageStreamCache::Clear(void)
+{
+	lock					cs(m_lock);			// Automatic lock
+
+	m_pages->Clear();
+	m_lru->Clear();
+	m_lastPage = -1;
+	m_generation++;
+}
+
+//---------------------------------------------------------------------------
+// StorageStreamCache::Generation::get
+//
+// Gets the current generation, which changes every time pages are invalidated
+
+__int64 StorageStreamCache::Generation::get(void)
+{
+	lock					cs(m_lock);			// Automatic lock
+	return m_generation;
+}
+
+//---------------------------------------------------------------------------
+// StorageStreamCache::Invalidate
+//
+// Discards the cached pages that overlap a range of the stream, along with
+// the partial page at the end of the stream
+//
+// Arguments:
+//
+//	offset		- Starting offset of the range
+//	length		- Length of the range
+
+void StorageStreamCache::Invalidate(__int64 offset, __int64 length)
+{
+	lock					cs(m_lock);			// Automatic lock
+
+	m_generation++;
+	if(m_lastPage >= 0) RemovePage(m_lastPage);
+	if(length <= 0) return;
+
+	__int64 first = offset / PAGE_SIZE;
+	__int64 last = (offset + length - 1) / PAGE_SIZE;
+
+	// A large write can cover far more pages than are cached, in which case
+	// it's faster to check every cached page than every page in the range
+
+	if((last - first) >= m_pages->Count) {
+
+		for(LinkedListNode<Page^>^ node = m_lru->First; node != nullptr; ) {
+
+			LinkedListNode<Page^>^ next = node->Next;
+			if((node->Value->Index >= first) && (node->Value->Index <= last)) RemovePage(node->Value->Index);
+			node = next;
+		}
+	}
+
+	else for(__int64 page = first; page <= last; page++) RemovePage(page);
+}
+
+//---------------------------------------------------------------------------
+// StorageStreamCache::RemovePage (private)
+//
+// Removes a single page from the cache.  Must be called with the lock held
+//
+// Arguments:
+//
+//	page		- Index of the page within the stream
+
+void StorageStreamCache::RemovePage(__int64 page)
+{
+	LinkedListNode<Page^>^		node;			// Cached page node
+
+	if(!m_pages->TryGetValue(page, node)) return;
+
+	m_lru->Remove(node);
+	m_pages->Remove(page);
+
+	if(page == m_lastPage) m_lastPage = -1;
+}
+
+//---------------------------------------------------------------------------
+// StorageStreamCache::TryGetPage
+//
+// Retrieves a page from the cache if it's present, and makes it the most
+// recently used page.  The returned data must not be modified
+//
+// Arguments:
+//
+//	page		- Index of the page within the stream
+//	data		- On success, receives the page data
+//	length		- On success, receives the number of valid bytes in the page
+
+bool StorageStreamCache::TryGetPage(__int64 page, array<Byte>^% data, int% length)
+{
+	lock					cs(m_lock);			// Automatic lock
+	LinkedListNode<Page^>^		node;			// Cached page node
+
+	data = nullptr;
+	length = 0;
+
+	if(!m_pages->TryGetValue(page, node)) return false;
+
+	if(node != m_lru->First) { m_lru->Remove(node); m_lru->AddFirst(node); }
+
+	data = node->Value->Data;
+	length = node->Value->Length;
+	return true;
+}
+
+//---------------------------------------------------------------------------
+
+END_ROOT_NAMESPACE(zuki::storage)
+
+#pragma warning(pop)
@@ -0,0 +1,148 @@
+//---------------------------------------------------------------------------
+// Copyright (c) 2016 Michael G. Brehm
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------
+
+#ifndef __STORAGESTREAMCACHE_H_
+#define __STORAGESTREAMCACHE_H_
+#pragma once
+
+#pragma warning(push, 4)				// Enable maximum compiler warnings
+
+using namespace System;
+using namespace System::Collections::Generic;
+using namespace msclr;
+
+BEGIN_ROOT_NAMESPACE(zuki::storage)
+
+//---------------------------------------------------------------------------
+// Class StorageStreamCache (internal)
+//
+// StorageStreamCache holds the most recently used fixed-size pages of a
+// single object stream.  One instance is shared by a ComStream and all of
+// it's clones, so a page read through any reader is available to all of
+// them.  Pages are evicted in least recently used order once the cache is
+// full, and any write through the stream invalidates the pages it touches.
+//
+// A page shorter than PAGE_SIZE is the last page of the stream, and also
+// remembers where the end of the stream was.  Writing anywhere can move the
+// end of the stream, so that page is always invalidated by a write.
+//
+// Pages are read from the stream without the lock held, so a write can land
+// between the read and AddPage().  Every invalidation bumps the generation,
+// and a page read before the current generation is never added.
+//---------------------------------------------------------------------------
+
+ref class StorageStreamCache sealed
+{
+public:
+
+	//-----------------------------------------------------------------------
+	// Constructor
+
+	StorageStreamCache(int capacity);
+
+	//-----------------------------------------------------------------------
+	// Fields
+
+	// PAGE_SIZE
+	//
+	// Size of each cached page, in bytes
+	literal int PAGE_SIZE = 4096;
+
+	//-----------------------------------------------------------------------
+	// Member Functions
+
+	// AddPage
+	//
+	// Adds a page that has been read from the stream into the cache
+	void AddPage(__int64 page, array<Byte>^ data, int length, __int64 generation);
+
+	// Clear
+	//
+	// Discards all of the cached pages
+	void Clear(void);
+
+	// Invalidate
+	//
+	// Discards the cached pages that overlap a range of the stream
+	void Invalidate(__int64 offset, __int64 length);
+
+	// TryGetPage
+	//
+	// Retrieves a page from the cache if it's present
+	bool TryGetPage(__int64 page, array<Byte>^% data, int% length);
+
+	//-----------------------------------------------------------------------
+	// Properties
+
+	// Generation
+	//
+	// Gets the current generation; changes every time pages are invalidated
+	property __int64 Generation
+	{
+		__int64 get(void);
+	}
+
+private:
+
+	//-----------------------------------------------------------------------
+	// Private Data Types
+
+	// Page
+	//
+	// A single cached page of the stream
+	ref class Page
+	{
+	public:
+
+		Page(__int64 index, array<Byte>^ data, int length) : Index(index), Data(data), Length(length) {}
+
+		initonly __int64		Index;
+		initonly array<Byte>^	Data;
+		initonly int			Length;
+	};
+
+	//-----------------------------------------------------------------------
+	// Private Member Functions
+
+	// RemovePage
+	//
+	// Removes a single page from the cache.  Must be called with the lock held
+	void RemovePage(__int64 page);
+
+	//-----------------------------------------------------------------------
+	// Member Variables
+
+	initonly int							m_capacity;		// Maximum number of pages
+	initonly Dictionary<__int64, LinkedListNode<Page^>^>^	m_pages;	// Cached pages
+	initonly LinkedList<Page^>^				m_lru;			// Pages in LRU order
+	__int64									m_lastPage;		// Cached partial page
+	__int64									m_generation;	// Invalidation generation
+	initonly Object^						m_lock;			// Synchronization object
+};
+
+//---------------------------------------------------------------------------
+
+END_ROOT_NAMESPACE(zuki::storage)
+
+#pragma warning(pop)
+
+#endif	// __STORAGESTREAMCACHE_H_
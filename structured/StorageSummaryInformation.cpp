@@ -22,6 +22,7 @@
 
 #include "stdafx.h"						// Include project pre-compiled headers
 #include "StorageSummaryInformation.h"	// Include StorageSummaryInformation decls
+#include "ComStorage.h"					// Include ComStorage declarations
 #include <initguid.h>					// Include DEFINE_GUID support
 
 #pragma warning(push, 4)				// Enable maximum compiler warnings
@@ -54,7 +55,7 @@ StorageSummaryInformation::StorageSummaryInformation(IComPropertySetStorage^ sto
 
 	if(storage == nullptr) throw gcnew ArgumentNullException();
 
-	m_readOnly = StorageUtil::IsStorageReadOnly(safe_cast<IComStorage^>(storage));
+	m_readOnly = safe_cast<ComStorage^>(storage)->ReadOnly;
 
 	// First try to open an existing property set with the FMTID from
 	// the current IStorage object ...
@@ -31,6 +31,34 @@ using namespace System;
 
 BEGIN_ROOT_NAMESPACE(zuki::storage)
 
+//---------------------------------------------------------------------------
+// Global Variables
+//---------------------------------------------------------------------------
+
+// BASE64_ALPHABET
+//
+// Characters used to encode GUID element names.  This is the standard base64
+// alphabet except that slash is replaced with underbar, since a slash isn't
+// allowed in the name of a storage element
+static const wchar_t BASE64_ALPHABET[] = 
+	L"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+_";
+
+// BASE64_VALUES
+//
+// Reverse of BASE64_ALPHABET for the ASCII range; -1 means the character
+// is invalid.  Slash decodes the same as underbar like it always has
+static const signed char BASE64_VALUES[128] = {
+
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+	52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+	-1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+	15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, 63,
+	-1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+	41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1
+};
+
 //---------------------------------------------------------------------------
 // StorageUtil::Base64ToSysGuid
 //
@@ -44,96 +72,89 @@ BEGIN_ROOT_NAMESPACE(zuki::storage)
 
 Guid StorageUtil::Base64ToSysGuid(String^ base64)
 {
-	base64 = base64->Replace('_', '/');		// Underbar back to slash
-
-	// Conversion errors here could be really bad in other places.  Safest
-	// thing to do is catch them and return an empty GUID instead
+	if(base64 == nullptr) return Guid::Empty;
 
-	try { return Guid(Convert::FromBase64String(base64)); }
-	catch(Exception^) { return Guid::Empty; }
+	PinnedStringPtr pinBase64 = PtrToStringChars(base64);
+	return Base64ToSysGuid(pinBase64);
 }
 
 //---------------------------------------------------------------------------
-// StorageUtil::CompareUUIDs
+// StorageUtil::Base64ToSysGuid
 //
-// Compares two GUIDs to determine their equality or inequality
+// Converts a base64 encoded element name back into a System::Guid without
+// allocating anything.  Never throws; anything that isn't exactly a base64
+// encoded GUID (including the name of the root storage) returns Guid::Empty
 //
-// Arguments :
+// Arguments:
 //
-//	lhs			- Left hand side GUID argument
-//	rhs			- Right hand side GUID argument
+//	base64		- The base64 encoded string to be converted
 
-int StorageUtil::CompareUUIDs(const UUID &lhs, const UUID &rhs)
+Guid StorageUtil::Base64ToSysGuid(const wchar_t* base64)
 {
-	// Ths first three parts of the GUIDs can be compared directly
+	UUID					uuid;				// Decoded UUID
+	unsigned __int8*		data;				// Pointer to the UUID bytes
+	int						values[22];			// Decoded 6-bit values
 
-	if(lhs.Data1 != rhs.Data1) return (lhs.Data1 < rhs.Data1) ? -1 : 1;
-	if(lhs.Data2 != rhs.Data2) return (lhs.Data2 < rhs.Data2) ? -1 : 1;
-	if(lhs.Data3 != rhs.Data3) return (lhs.Data3 < rhs.Data3) ? -1 : 1;
+	if(base64 == NULL) return Guid::Empty;
 
-	// The first three parts are equal.  In order to check the final part
-	// of the GUIDs, we need to iterate through all 8 bytes in order
+	// Validate and decode all 22 significant characters before touching the
+	// padding, this also guarantees nothing is read past the terminator
 
-	int i;
-	for(i = 0; (i < 8) && (lhs.Data4[i] == rhs.Data4[i]); i++);
+	for(int index = 0; index < 22; index++) {
 
-	if(i == 8) return 0;
-	else return (lhs.Data4[i] < rhs.Data4[i]) ? -1 : 1;
-}
+		if(base64[index] >= 128) return Guid::Empty;
+		values[index] = BASE64_VALUES[base64[index]];
+		if(values[index] < 0) return Guid::Empty;
+	}
 
-//---------------------------------------------------------------------------
-// StorageUtil::GetContainerID (static)
-//
-// Retrieves the GUID that uniquely defines a specific container.  Every
-// container's name is actually a BASE64 encoded Guid
-//
-// Arguments:
-//
-//	storage		- IComStorage reference to get the GUID for
+	if((base64[22] != L'=') || (base64[23] != L'=') || (base64[24] != L'\0')) return Guid::Empty;
 
-Guid StorageUtil::GetContainerID(IComStorage^ storage)
-{
-	::STATSTG		stats;				// Structure returned from Stat()
-	HRESULT			hResult;			// Result from function call
+	// Every 4 characters make up 3 bytes, which accounts for the first 15 bytes
+	// of the UUID.  The final byte comes from the two characters before the padding
 
-	if(storage == nullptr) throw gcnew ArgumentNullException();
+	data = reinterpret_cast<unsigned __int8*>(&uuid);
 
-	// Retrieve the STASTG information about this IStorage object,
-	// including the name, since that's what we're really after here
+	for(int index = 0, offset = 0; index < 15; index += 3, offset += 4) {
 
-	hResult = storage->Stat(&stats, STATFLAG_DEFAULT);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+		DWORD bits = (values[offset] << 18) | (values[offset + 1] << 12) | 
+			(values[offset + 2] << 6) | values[offset + 3];
+
+		data[index] = static_cast<unsigned __int8>(bits >> 16);
+		data[index + 1] = static_cast<unsigned __int8>(bits >> 8);
+		data[index + 2] = static_cast<unsigned __int8>(bits);
+	}
 
-	// Convert the BASE64 encoded string back into a GUID and return it
+	data[15] = static_cast<unsigned __int8>((values[20] << 2) | (values[21] >> 4));
 
-	try { return Base64ToSysGuid(gcnew String(stats.pwcsName)); }
-	finally { CoTaskMemFree(stats.pwcsName); }
+	return UUIDToSysGuid(uuid);
 }
 
 //---------------------------------------------------------------------------
-// StorageUtil::GetObjectID
+// StorageUtil::CompareUUIDs
 //
-// Retrieves the GUID associated with a stream
+// Compares two GUIDs to determine their equality or inequality
 //
-// Arguments:
+// Arguments :
 //
-//	stream			- IComStream reference to get the GUID from
+//	lhs			- Left hand side GUID argument
+//	rhs			- Right hand side GUID argument
 
-Guid StorageUtil::GetObjectID(IComStream^ stream)
+int StorageUtil::CompareUUIDs(const UUID &lhs, const UUID &rhs)
 {
-	::STATSTG		stats;				// Structure returned from Stat()
-	HRESULT			hResult;			// Result from function call
+	// Ths first three parts of the GUIDs can be compared directly
 
-	// Retrieve the STASTG information about this Stream object,
-	// including the name, since that's what we're really after here
+	if(lhs.Data1 != rhs.Data1) return (lhs.Data1 < rhs.Data1) ? -1 : 1;
+	if(lhs.Data2 != rhs.Data2) return (lhs.Data2 < rhs.Data2) ? -1 : 1;
+	if(lhs.Data3 != rhs.Data3) return (lhs.Data3 < rhs.Data3) ? -1 : 1;
 
-	hResult = stream->Stat(&stats, STATFLAG_DEFAULT);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	// The first three parts are equal.  In order to check the final part
+	// of the GUIDs, we need to iterate through all 8 bytes in order
 
-	// Convert the BASE64 encoded string back into a GUID and return it
+	int i;
+	for(i = 0; (i < 8) && (lhs.Data4[i] == rhs.Data4[i]); i++);
 
-	try { return Base64ToSysGuid(gcnew String(stats.pwcsName)); }
-	finally { CoTaskMemFree(stats.pwcsName); }
+	if(i == 8) return 0;
+	else return (lhs.Data4[i] < rhs.Data4[i]) ? -1 : 1;
 }
 
 //---------------------------------------------------------------------------
@@ -159,119 +180,62 @@ Guid StorageUtil::GetPropertySetID(IComPropertyStorage^ propStorage)
 }
 
 //---------------------------------------------------------------------------
-// StorageUtil::GetStorageChildOpenMode
-//
-// Generates a set of "open mode" flags based on an existing IStorage object.
-// When opening up sub storages or streams, you always have to include the
-// STGM_SHARE_EXCLUSIVE flag for whatever genius reason they came up with
-//
-// Arguments:
-//
-//	storage			- IComStorage instance to be accessed
-
-DWORD StorageUtil::GetStorageChildOpenMode(IComStorage^ storage)
-{
-	::STATSTG		stats;				// Structure returned from Stat()
-	HRESULT			hResult;			// Result from function call
-
-	// Retrieve the STASTG information about this Storage object, omitting
-	// the pcwsName field, so we don't have to bother releasing the memory
-
-	hResult = storage->Stat(&stats, STATFLAG_NONAME);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult);
-
-	return ((stats.grfMode & 0xF) | STGM_SHARE_EXCLUSIVE);
-}
-
-//---------------------------------------------------------------------------
-// StorageUtil::GetStorageMode
+// StorageUtil::SysGuidToBase64
 //
-// Retrieves the mode flags associated with an IStorage interface
+// Converts a System::Guid structure into a base64 encoded string in order
+// to minimize the storage space necessary.  CAUTION: All base64 encoded
+// strings are CASE SENSITIVE, since they use both upper and lower case
 //
 // Arguments:
 //
-//	pStorage		- Pointer to the IStorage interface
+//	guid		- The System::Guid structure to be converted
 
-DWORD StorageUtil::GetStorageMode(IComStorage^ storage)
+String^ StorageUtil::SysGuidToBase64(System::Guid guid)
 {
-	::STATSTG		stats;				// Structure returned from Stat()
-	HRESULT			hResult;			// Result from function call
-
-	// Retrieve the STASTG information about this Storage object, omitting
-	// the pcwsName field, so we don't have to bother releasing the memory
-
-	hResult = storage->Stat(&stats, STATFLAG_NONAME);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	GUIDNAME				base64;				// Encoded GUID
 
-	return stats.grfMode;				// Copy back the mode flags
+	SysGuidToBase64(guid, base64);
+	return gcnew String(base64);
 }
 
 //---------------------------------------------------------------------------
-// StorageUtil::GetStreamMode
+// StorageUtil::SysGuidToBase64
 //
-// Retrieves the mode flags associated with an IStream interface
+// Converts a System::Guid structure into a base64 encoded element name in
+// a caller-supplied buffer, without allocating anything.  The format is the
+// same as Convert::ToBase64String() with slashes replaced by underbars
 //
 // Arguments:
 //
-//	stream			- IComStream reference to get the flag from
+//	guid		- The System::Guid structure to be converted
+//	base64		- Buffer of at least BASE64_GUID_CCH characters (GUIDNAME)
 
-DWORD StorageUtil::GetStreamMode(IComStream^ stream)
+void StorageUtil::SysGuidToBase64(System::Guid guid, wchar_t* base64)
 {
-	::STATSTG		stats;				// Structure returned from Stat()
-	HRESULT			hResult;			// Result from function call
+	UUID					uuid;				// Unmanaged UUID
+	const unsigned __int8*	data;				// Pointer to the UUID bytes
 
-	// Retrieve the STASTG information about this Stream object, omitting
-	// the pcwsName field, so we don't have to bother releasing the memory
+	uuid = SysGuidToUUID(guid);
+	data = reinterpret_cast<const unsigned __int8*>(&uuid);
 
-	hResult = stream->Stat(&stats, STATFLAG_NONAME);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	// The first 15 bytes convert evenly into 20 characters, the last byte is
+	// encoded into two more characters and the usual "==" padding
 
-	return stats.grfMode;				// Copy back the mode flags
-}
+	for(int index = 0; index < 15; index += 3) {
 
-//---------------------------------------------------------------------------
-// StorageUtil::IsStorageReadOnly
-//
-// Determines if an IStorage-based object is set to read only or not
-//
-// Arguments:
-//
-//	storage		- IComStorage reference to get flags from
+		DWORD bits = (data[index] << 16) | (data[index + 1] << 8) | data[index + 2];
 
-bool StorageUtil::IsStorageReadOnly(IComStorage^ storage)
-{
-	return ((GetStorageMode(storage) & 0xF) == STGM_READ);
-}
-
-//---------------------------------------------------------------------------
-// StorageUtil::IsStreamReadOnly
-//
-// Determines if an IStream-based object is set to read only or not
-//
-// Arguments:
-//
-//	stream		- IComStream reference to check status of
+		*base64++ = BASE64_ALPHABET[(bits >> 18) & 0x3F];
+		*base64++ = BASE64_ALPHABET[(bits >> 12) & 0x3F];
+		*base64++ = BASE64_ALPHABET[(bits >> 6) & 0x3F];
+		*base64++ = BASE64_ALPHABET[bits & 0x3F];
+	}
 
-bool StorageUtil::IsStreamReadOnly(IComStream^ stream)
-{
-	return ((GetStreamMode(stream) & 0xF) == STGM_READ);
-}
-
-//---------------------------------------------------------------------------
-// StorageUtil::SysGuidToBase64
-//
-// Converts a System::Guid structure into a base64 encoded string in order
-// to minimize the storage space necessary.  CAUTION: All base64 encoded
-// strings are CASE SENSITIVE, since they use both upper and lower case
-//
-// Arguments:
-//
-//	guid		- The System::Guid structure to be converted
-
-String^ StorageUtil::SysGuidToBase64(System::Guid guid)
-{
-	String^ base64 = Convert::ToBase64String(guid.ToByteArray());
-	return base64->Replace('/', '_');
+	*base64++ = BASE64_ALPHABET[data[15] >> 2];
+	*base64++ = BASE64_ALPHABET[(data[15] & 0x03) << 4];
+	*base64++ = L'=';
+	*base64++ = L'=';
+	*base64 = L'\0';
 }
 
 //---------------------------------------------------------------------------
@@ -286,9 +250,11 @@ String^ StorageUtil::SysGuidToBase64(System::Guid guid)
 
 UUID StorageUtil::SysGuidToUUID(Guid guid)
 {
-	array<Byte>^ guidData = guid.ToByteArray();
-	PinnedBytePtr data = &(guidData[0]);
-	return *reinterpret_cast<UUID*>(data);
+	// System::Guid has the same layout in memory as an unmanaged UUID, so
+	// there is no need to go through ToByteArray() to convert it
+
+	pin_ptr<Guid> pinGuid = &guid;
+	return *reinterpret_cast<UUID*>(pinGuid);
 }
 
 //---------------------------------------------------------------------------
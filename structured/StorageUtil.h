@@ -42,6 +42,24 @@ BEGIN_ROOT_NAMESPACE(zuki::storage)
 ref class StorageContainer;				// StorageContainer.h
 ref class StorageObject;				// StorageObject.h
 
+//---------------------------------------------------------------------------
+// Constants
+//---------------------------------------------------------------------------
+
+// BASE64_GUID_CCH
+//
+// Length of a base64 encoded GUID element name, including the NUL terminator
+const int BASE64_GUID_CCH = 25;
+
+//---------------------------------------------------------------------------
+// Type Declarations
+//---------------------------------------------------------------------------
+
+// GUIDNAME
+//
+// Buffer that holds a base64 encoded GUID element name
+typedef wchar_t GUIDNAME[BASE64_GUID_CCH];
+
 //---------------------------------------------------------------------------
 // Function Prototypes
 //---------------------------------------------------------------------------
@@ -63,16 +81,11 @@ public:
 	// Member Functions
 
 	static Guid		Base64ToSysGuid(String^ base64);
+	static Guid		Base64ToSysGuid(const wchar_t* base64);
 	static int		CompareUUIDs(const UUID &lhs, const UUID &rhs);
-	static Guid		GetContainerID(IComStorage^ storage);
-	static Guid		GetObjectID(IComStream^ stream);
 	static Guid		GetPropertySetID(IComPropertyStorage^ propStorage);
-	static DWORD	GetStorageChildOpenMode(IComStorage^ storage);
-	static DWORD	GetStorageMode(IComStorage^ storage);
-	static DWORD	GetStreamMode(IComStream^ stream);
-	static bool		IsStorageReadOnly(IComStorage^ storage);
-	static bool		IsStreamReadOnly(IComStream^ stream);
 	static String^	SysGuidToBase64(Guid guid);
+	static void		SysGuidToBase64(Guid guid, wchar_t* base64);
 	static UUID		SysGuidToUUID(Guid guid);
 	static Guid		UUIDToSysGuid(const UUID& guid);
 };
@@ -23,6 +23,7 @@
 
 #include "stdafx.h"						// Include project pre-compiled headers
 #include "StructuredStorage.h"			// Include StructuredStorage declarations
+#include "StorageLockBytes.h"			// Include StorageLockBytes declarations
 
 #pragma warning(push, 4)				// Enable maximum compiler warnings
 
@@ -35,21 +36,32 @@ BEGIN_ROOT_NAMESPACE(zuki::storage)
 //
 //	fileName		- File name for the structured storage file
 //	storage			- Root ComStorage object from Open()
+//	pLockBytes		- In-memory ILockBytes from CreateInMemory(), or NULL
 
-StructuredStorage::StructuredStorage(String^ fileName, ComStorage^ storage) : 
-	StorageContainer(nullptr, nullptr, storage), m_fileName(fileName), m_storage(storage)
+StructuredStorage::StructuredStorage(String^ fileName, ComStorage^ storage, ILockBytes* pLockBytes) : 
+	StorageContainer(nullptr, nullptr, storage), m_fileName(fileName), m_storage(storage), 
+	m_pLockBytes(pLockBytes)
 {
 	// NOTE: If anything goes wrong in this constructor, Open() will automatically
 	// dispose of the COM pointer, so there is no need to self-dispose on error
 
-	if(m_fileName == nullptr) throw gcnew ArgumentNullException();
+	// NOTE: fileName is only NULL for in-memory storage created with
+	// CreateInMemory(), which is the only kind that has an ILockBytes
+
+	if((m_fileName == nullptr) && (m_pLockBytes == NULL)) throw gcnew ArgumentNullException();
 	if(m_storage == nullptr) throw gcnew ArgumentNullException();
 
-	m_pstgCache = gcnew ComCache<ComPropertyStorage^>();	// Create the cache
-	m_stgCache = gcnew ComCache<ComStorage^>();				// Create the cache
-	m_stmCache = gcnew ComCache<ComStream^>();				// Create the cache
+	m_pstgCache = gcnew ComCache<ComPropertyStorage^>(m_storage->Statistics);
+	m_stgCache = gcnew ComCache<ComStorage^>(m_storage->Statistics);
+	m_stmCache = gcnew ComCache<ComStream^>(m_storage->Statistics);
 
 	m_summaryInfo = gcnew StorageSummaryInformation(m_storage);
+	m_index = gcnew StoragePropertyIndex(this, m_storage);
+	m_paths = gcnew Dictionary<String^, LinkedListNode<PathEntry>^>(StringComparer::OrdinalIgnoreCase);
+	m_pathsLru = gcnew LinkedList<PathEntry>();
+	m_groupLock = gcnew Object();
+
+	if(m_pLockBytes) m_pLockBytes->AddRef();		// Hold the backing store
 }
 
 //---------------------------------------------------------------------------
@@ -61,6 +73,40 @@ StructuredStorage::StructuredStorage(String^ fileName, ComStorage^ storage) :
 
 StructuredStorage::~StructuredStorage()
 {
+	HRESULT					hResult;		// Result from function call
+
+	if(m_disposed) return;						// Already disposed of
+
+	// Stopping group commit commits anything that's still waiting on it
+
+	{
+		lock cs(m_groupLock);
+
+		if(m_groupCommit != nullptr) delete m_groupCommit;
+		m_groupCommit = nullptr;
+	}
+
+	// Changes made to a TRANSACTED root storage are discarded on release, so
+	// a clean close has to checkpoint them first, with the same flags as
+	// Commit() so a shared writer can't overwrite someone else's commit.  A
+	// destructor can't throw, so a failure here is only traced and the file
+	// stays as of the last successful Flush(); callers that need to know the
+	// changes made it must Flush() before closing.  The property value indexes
+	// go first so they get included in that final commit
+
+	if(m_index != nullptr) {
+
+		try { m_index->Save(); } catch(Exception^) { /* DO NOTHING */ }
+		delete m_index;
+	}
+
+	if((m_storage->Mode & STGM_TRANSACTED) && ((m_storage->Mode & 0xF) != STGM_READ)) {
+
+		hResult = m_storage->Commit((m_storage->Mode & STGM_NOSNAPSHOT) ? STGC_ONLYIFCURRENT : STGC_DEFAULT);
+		if(FAILED(hResult)) Trace::TraceError("StructuredStorage: changes discarded on close; commit failed with HRESULT 0x{0:X8}", 
+			static_cast<int>(hResult));
+	}
+
 	if(m_pstgCache != nullptr) delete m_pstgCache;	// Dispose of ComCache
 	if(m_stgCache != nullptr) delete m_stgCache;	// Dispose of ComCache
 	if(m_stmCache != nullptr) delete m_stmCache;	// Dispose of ComCache
@@ -69,9 +115,41 @@ StructuredStorage::~StructuredStorage()
 	m_summaryInfo = nullptr;
 
 	delete m_storage;							// Dispose of pointer
+
+	// The in-memory backing store has to outlive the root storage, since the
+	// storage may still write to it while it's being released
+
+	if(m_pLockBytes) m_pLockBytes->Release();
+	m_pLockBytes = NULL;
+
 	m_disposed = true;							// Object is now disposed
 }
 
+//---------------------------------------------------------------------------
+// StructuredStorage::Commit (private)
+//
+// Writes out any property value index changes and commits the root storage.
+// Shared writers commit with STGC_ONLYIFCURRENT, so if something else has
+// managed to commit to the file since it was opened this fails with
+// STG_E_NOTCURRENT rather than silently discarding the other changes
+//
+// Arguments:
+//
+//	NONE
+
+void StructuredStorage::Commit(void)
+{
+	DWORD					flags;			// Commit flags
+	HRESULT					hResult;		// Result from function call
+
+	m_index->Save();						// Write out index changes
+
+	flags = (m_storage->Mode & STGM_NOSNAPSHOT) ? STGC_ONLYIFCURRENT : STGC_DEFAULT;
+
+	hResult = m_storage->Commit(flags);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+}
+
 //---------------------------------------------------------------------------
 // StructuredStorage::ComPropStorageCache::get (internal)
 //
@@ -105,6 +183,119 @@ ComCache<ComStream^>^ StructuredStorage::ComStreamCache::get(void)
 	return m_stmCache;
 }
 
+//---------------------------------------------------------------------------
+// StructuredStorage::CreateInMemory (static)
+//
+// Creates a new structured storage that is held entirely in memory.  This is
+// much cheaper than CreateTemp() for small, short-lived storages since there
+// is no file to create and delete; use Save() to keep a copy of the contents
+//
+// Arguments:
+//
+//	NONE
+
+StructuredStorage^ StructuredStorage::CreateInMemory(void)
+{
+	ILockBytes*			pLockBytes = NULL;			// In-memory backing store
+	IStorage*			pRootStorage = NULL;		// Pointer to root IStorage
+	ComStorage^			rootStorage;				// Wrapped root storage
+	DWORD				flags;						// Structured Storage flags
+	HRESULT				hResult;					// Result from function call
+
+	flags = static_cast<DWORD>(StorageAccessMode::Exclusive) | STGM_CREATE;
+
+	// The HGLOBAL-based ILockBytes grows its buffer as the storage needs it,
+	// and frees it when the last reference to it has been released
+
+	hResult = CreateILockBytesOnHGlobal(NULL, TRUE, &pLockBytes);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	try {
+
+		hResult = StgCreateDocfileOnILockBytes(pLockBytes, flags, 0, &pRootStorage);
+		if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+		rootStorage = gcnew ComStorage(pRootStorage, nullptr, gcnew StorageStatistics());
+		try { return gcnew StructuredStorage(nullptr, rootStorage, pLockBytes); }
+		catch(Exception^) { delete rootStorage; throw; }
+	}
+
+	finally { 
+		
+		if(pRootStorage) pRootStorage->Release();
+		pLockBytes->Release();
+	}
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::CreateIndex
+//
+// Creates a secondary index over the values of a property, which is then
+// maintained as that property is changed in any container.  The index is
+// kept inside the compound file and is used by Query()
+//
+// Arguments:
+//
+//	propertySet		- Name of the property set that contains the property
+//	property		- Name of the property to be indexed
+
+void StructuredStorage::CreateIndex(String^ propertySet, String^ property)
+{
+	CHECK_DISPOSED(m_disposed);
+	if(propertySet == nullptr) throw gcnew ArgumentNullException();
+	if(property == nullptr) throw gcnew ArgumentNullException();
+
+	m_index->Add(propertySet, property);
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::DropIndex
+//
+// Removes a secondary index created with CreateIndex()
+//
+// Arguments:
+//
+//	propertySet		- Name of the property set that contains the property
+//	property		- Name of the indexed property
+
+bool StructuredStorage::DropIndex(String^ propertySet, String^ property)
+{
+	CHECK_DISPOSED(m_disposed);
+	if(propertySet == nullptr) throw gcnew ArgumentNullException();
+	if(property == nullptr) throw gcnew ArgumentNullException();
+
+	return m_index->Remove(propertySet, property);
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::ExportChanges
+//
+// Exports everything that has changed since the specified time into a new
+// structured storage file, which can be applied to a copy of this file as
+// it was at that time with ImportChanges().  To chain exports together, pass
+// the time that the previous export was started as the next 'since' value.
+// The comparison is done in UTC; a 'since' value with an Unspecified kind is
+// taken to be local time, the same way DateTime::ToUniversalTime() treats it,
+// so use DateTime::SpecifyKind() on a value that has lost it's UTC kind
+//
+// Arguments:
+//
+//	path		- Path to the structured storage file to be created
+//	since		- Point in time to export the changes after
+
+void StructuredStorage::ExportChanges(String^ path, DateTime since)
+{
+	StructuredStorage^			delta;			// Exported changes
+
+	CHECK_DISPOSED(m_disposed);
+	if(path == nullptr) throw gcnew ArgumentNullException();
+
+	delta = StructuredStorage::Create(path);
+
+	try { StorageContainer::ExportChanges(delta, since.ToUniversalTime(), false); }
+	finally { delete delta; }
+}
+
 //---------------------------------------------------------------------------
 // StructuredStorage::FileName::get
 //
@@ -116,11 +307,43 @@ String^ StructuredStorage::FileName::get(void)
 	return m_fileName;
 }
 
+//---------------------------------------------------------------------------
+// StructuredStorage::FindPath (private)
+//
+// Looks up a resolved container path and makes it the most recently used
+// one.  Must be called with the path cache locked
+//
+// Arguments:
+//
+//	prefix		- Path prefix built from the split names
+//	container	- On success, receives the resolved container
+
+bool StructuredStorage::FindPath(String^ prefix, StorageContainer^% container)
+{
+	LinkedListNode<PathEntry>^		node;		// Cached path node
+
+	container = nullptr;
+
+	if(!m_paths->TryGetValue(prefix, node)) return false;
+
+	if(node != m_pathsLru->First) { m_pathsLru->Remove(node); m_pathsLru->AddFirst(node); }
+
+	container = node->Value.Value;
+	return true;
+}
+
 //---------------------------------------------------------------------------
 // StructuredStorage::Flush
 //
 // Ensures that all data has been flushed to disk to prevent corruption
-// and other such bad things
+// and other such bad things.  For TRANSACTED storage this is the checkpoint
+// that merges all pending changes into the compound file.  Closing the storage
+// also commits, but can't report a failure, so Flush() before Close() when
+// it matters whether the last changes were kept
+//
+// With group commit enabled this joins the next batch and blocks until it
+// has been committed, so it's just as durable but many concurrent callers
+// share a single commit
 //
 // Arguments:
 //
@@ -128,12 +351,265 @@ String^ StructuredStorage::FileName::get(void)
 
 void StructuredStorage::Flush(void)
 {
-	HRESULT					hResult;		// Result from function call
+	Task^					request;		// Group commit request
 
 	CHECK_DISPOSED(m_disposed);
 
-	hResult = m_storage->Commit(STGC_DEFAULT);
-	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+	// The batch has to be joined under the lock so GroupCommitInterval can't
+	// dispose of the group commit in between, but it's waited on outside it
+
+	{
+		lock cs(m_groupLock);
+		if(m_groupCommit != nullptr) request = m_groupCommit->Request();
+	}
+
+	if(request == nullptr) { Commit(); return; }
+
+	// Unwrap the AggregateException so callers see the same exceptions
+	// either way, with their original stack traces intact
+
+	try { request->Wait(); }
+	catch(AggregateException^ ex) { ExceptionDispatchInfo::Capture(ex->InnerException)->Throw(); }
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::FlushAsync
+//
+// Requests a flush and returns a Task that completes once it's durable.
+// Without group commit enabled, the flush happens before this returns
+//
+// Arguments:
+//
+//	NONE
+
+Task^ StructuredStorage::FlushAsync(void)
+{
+	CHECK_DISPOSED(m_disposed);
+
+	{
+		lock cs(m_groupLock);
+		if(m_groupCommit != nullptr) return m_groupCommit->Request();
+	}
+
+	TaskCompletionSource<bool>^ completion = gcnew TaskCompletionSource<bool>();
+
+	try { Commit(); completion->SetResult(true); }
+	catch(Exception^ ex) { completion->SetException(ex); }
+
+	return completion->Task;
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::GetContainer
+//
+// Accesses a nested container by it's path relative to the root, for example
+// "a/b/c".  The most recently resolved path prefixes are remembered along
+// with their open containers, so the next lookup only has to walk the part of
+// the path that hasn't been seen before.  Unlike the collection indexers,
+// this will never create a container that doesn't already exist
+//
+// Arguments:
+//
+//	path		- Path to the container, separated with either slash
+
+StorageContainer^ StructuredStorage::GetContainer(String^ path)
+{
+	StorageContainer^			container;		// Resolved container
+	String^						prefix;			// Resolved path prefix
+	array<Guid>^				chain;			// Sealed GUID chain
+	int							resolved;		// Number of names resolved
+	__int64						generation;		// Path cache generation
+
+	CHECK_DISPOSED(m_disposed);
+	if(path == nullptr) throw gcnew ArgumentNullException();
+
+	array<String^>^ names = SplitPath(path);
+	if(names->Length == 0) return this;
+
+	// A sealed storage has every path in it's name index already, so there's
+	// no need to walk anything or remember what was found
+
+	if(m_sealed != nullptr) {
+
+		if(!m_sealed->TryLookup(StorageSealedIndex::GetKey(false, String::Join("/", names)), chain)) 
+			throw gcnew ContainerNotFoundException(path);
+
+		return OpenChain(chain, chain->Length);
+	}
+
+	// Find the longest prefix of the path that has already been resolved; 
+	// the cache keys are always built from the split names so that different
+	// spellings of the same path all end up hitting the same entries
+
+	{
+		lock cs(m_paths);
+
+		generation = m_pathsGeneration;
+		for(resolved = names->Length; resolved > 0; resolved--)
+			if(FindPath(String::Join("/", names, 0, resolved), container)) break;
+	}
+
+	if(resolved == 0) container = this;
+
+	// Walk the rest of the path one container at a time without holding the
+	// lock, remembering each of the newly resolved prefixes on the way down
+
+	for(int index = resolved; index < names->Length; index++) {
+
+		if(!container->Containers->Contains(names[index])) throw gcnew ContainerNotFoundException(path);
+
+		container = container->Containers[names[index]];
+		prefix = String::Join("/", names, 0, index + 1);
+		RememberPath(prefix, container, generation);
+	}
+
+	return container;
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::GetObject
+//
+// Accesses an object by it's path relative to the root, for example "a/b/c".
+// The final name in the path is the object; everything before that is the
+// path to the container it lives in.  Like GetContainer(), this will never
+// create an object that doesn't already exist
+//
+// Arguments:
+//
+//	path		- Path to the object, separated with either slash
+
+StorageObject^ StructuredStorage::GetObject(String^ path)
+{
+	StorageContainer^			container;		// Parent container
+	array<Guid>^				chain;			// Sealed GUID chain
+
+	CHECK_DISPOSED(m_disposed);
+	if(path == nullptr) throw gcnew ArgumentNullException();
+
+	array<String^>^ names = SplitPath(path);
+	if(names->Length == 0) throw gcnew ArgumentException();
+
+	if(m_sealed != nullptr) {
+
+		if(!m_sealed->TryLookup(StorageSealedIndex::GetKey(true, String::Join("/", names)), chain))
+			throw gcnew ObjectNotFoundException(path);
+
+		return OpenChain(chain, chain->Length - 1)->Objects[chain[chain->Length - 1]];
+	}
+
+	container = (names->Length == 1) ? this : GetContainer(String::Join("/", names, 0, names->Length - 1));
+
+	String^ name = names[names->Length - 1];
+	if(!container->Objects->Contains(name)) throw gcnew ObjectNotFoundException(path);
+
+	return container->Objects[name];
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::GroupCommitInterval::get
+//
+// Gets the interval that flushes are batched over, or TimeSpan::Zero if each
+// flush commits the storage by itself
+
+TimeSpan StructuredStorage::GroupCommitInterval::get(void)
+{
+	CHECK_DISPOSED(m_disposed);
+
+	lock cs(m_groupLock);
+	return (m_groupCommit != nullptr) ? m_groupCommit->Interval : TimeSpan::Zero;
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::GroupCommitInterval::set
+//
+// Enables group commit with the specified interval, or disables it if the
+// interval is TimeSpan::Zero.  Flushes already waiting on the old interval
+// are committed before this returns
+
+void StructuredStorage::GroupCommitInterval::set(TimeSpan value)
+{
+	CHECK_DISPOSED(m_disposed);
+
+	if(value < TimeSpan::Zero) throw gcnew ArgumentOutOfRangeException("value");
+
+	// Flush() and FlushAsync() join batches under the same lock, so nobody
+	// can get a request into the group commit while it's being replaced
+
+	lock cs(m_groupLock);
+
+	if(m_groupCommit != nullptr) delete m_groupCommit;
+	m_groupCommit = nullptr;
+
+	if(value > TimeSpan::Zero) 
+		m_groupCommit = gcnew StorageGroupCommit(gcnew Action(this, &StructuredStorage::Commit), value);
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::ImportChanges
+//
+// Applies a set of changes that were exported with ExportChanges().  If the
+// import fails part of the way through this file will be left partially
+// updated, so consider opening it with StorageAccessMode::Transacted and only
+// calling Flush() once the import has succeeded
+//
+// Arguments:
+//
+//	path		- Path to the structured storage file with the changes
+
+void StructuredStorage::ImportChanges(String^ path)
+{
+	StructuredStorage^			delta;			// Exported changes
+
+	CHECK_DISPOSED(m_disposed);
+	if(path == nullptr) throw gcnew ArgumentNullException();
+	if(ReadOnly) throw gcnew ContainerReadOnlyException();
+
+	delta = StructuredStorage::Open(path, StorageOpenMode::Open, StorageAccessMode::ReadOnlyExclusive);
+
+	try { StorageContainer::ImportChanges(delta); }
+	finally { delete delta; }
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::InvalidatePaths (internal)
+//
+// Discards the resolved container paths cached by GetContainer().  This is
+// called whenever a container anywhere in the file is renamed or removed; 
+// those are rare enough that throwing out everything is the simplest way to
+// make sure a stale path can never resolve to the wrong container
+//
+// Arguments:
+//
+//	NONE
+
+void StructuredStorage::InvalidatePaths(void)
+{
+	if(m_disposed) return;
+
+	lock cs(m_paths);
+
+	m_paths->Clear();
+	m_pathsLru->Clear();
+	m_pathsGeneration++;			// Drop paths being resolved right now
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::OpenChain (private)
+//
+// Opens the container at the end of a chain of container GUIDs leading down
+// from the root, without going through any of the name mappers
+//
+// Arguments:
+//
+//	chain		- Chain of GUIDs from a sealed name index
+//	links		- Number of container GUIDs in the chain to follow
+
+StorageContainer^ StructuredStorage::OpenChain(array<Guid>^ chain, int links)
+{
+	StorageContainer^			container = this;		// Current container
+
+	for(int index = 0; index < links; index++) container = container->Containers[chain[index]];
+	return container;
 }
 
 //---------------------------------------------------------------------------
@@ -142,22 +618,37 @@ void StructuredStorage::Flush(void)
 // Attempts to open/create a structured storage compound file and wrap a new
 // StructuredStorage instance around it for the caller
 //
+// If a cache size is specified, the file is accessed with unbuffered, sector
+// aligned I/O through a private page cache of that size (StorageLockBytes)
+// rather than through the system file cache.  Cache misses read up to the
+// read-ahead number of uncached pages at once, and dirty pages are written
+// back in runs of up to that many pages.  Files created that way use the
+// default 512 byte sectors, and can't be opened with a sharing mode that
+// lets anything else write to them
+//
 // Arguments:
 //
 //	path		- Path to the structured storage file, or NULL for temp
 //	mode		- Storage creation mode
 //	access		- Storage access mode
+//	cacheSize	- Size of the page cache in bytes, or zero to use the system cache
+//	readAhead	- Maximum number of cache pages to read or write at once
 
 StructuredStorage^ StructuredStorage::Open(String^ path, StorageOpenMode mode, 
-	StorageAccessMode access)
+	StorageAccessMode access, int cacheSize, int readAhead)
 {
 	PinnedStringPtr		pinPath;					// Pinned path string
 	DWORD				flags;						// Structured Storage flags
 	STGOPTIONS			stgOptions;					// Storage options
+	ILockBytes*			pLockBytes = NULL;			// Cached ILockBytes
 	IStorage*			pRootStorage = NULL;		// Pointer to root IStorage
 	ComStorage^			rootStorage;				// Wrapped root storage
+	::STATSTG			statstg;					// Root storage statistics
 	HRESULT				hResult = E_UNEXPECTED;		// Result from function call
 
+	if(cacheSize < 0) throw gcnew ArgumentOutOfRangeException("cacheSize");
+	if(readAhead < 1) throw gcnew ArgumentOutOfRangeException("readAhead");
+
 	flags = static_cast<DWORD>(access);				// Cast out the flags
 
 	memset(&stgOptions, 0, sizeof(STGOPTIONS));		// Initialize to all NULLs
@@ -180,10 +671,11 @@ StructuredStorage^ StructuredStorage::Open(String^ path, StorageOpenMode mode,
 	}
 
 	// If the determined file mode is CREATE or CREATENEW, the only allowed
-	// access flag is ReadWriteExclusive
+	// access flags are the writable ones: Exclusive, Transacted or TransactedShared
 
 	if((mode == StorageOpenMode::Create) || (mode == StorageOpenMode::CreateNew))
-		if(access != StorageAccessMode::Exclusive) throw gcnew InvalidOperationException();
+		if((access != StorageAccessMode::Exclusive) && (access != StorageAccessMode::Transacted) &&
+			(access != StorageAccessMode::TransactedShared)) throw gcnew InvalidOperationException();
 
 	try {
 
@@ -199,7 +691,16 @@ StructuredStorage^ StructuredStorage::Open(String^ path, StorageOpenMode mode,
 			case StorageOpenMode::Open:
 
 				if(path == nullptr) throw gcnew ArgumentNullException();
-				hResult = StgOpenStorageEx(pinPath, flags, STGFMT_DOCFILE, 0, &stgOptions, 
+
+				if(cacheSize > 0) {
+
+					hResult = StorageLockBytes::Create(pinPath, flags, OPEN_EXISTING, 
+						static_cast<size_t>(cacheSize), static_cast<ULONG>(readAhead), &pLockBytes);
+					if(SUCCEEDED(hResult)) hResult = StgOpenStorageOnILockBytes(pLockBytes, NULL, flags, 
+						NULL, 0, &pRootStorage);
+				}
+
+				else hResult = StgOpenStorageEx(pinPath, flags, STGFMT_DOCFILE, 0, &stgOptions, 
 					0, __uuidof(IStorage), reinterpret_cast<void**>(&pRootStorage));
 				break;
 
@@ -211,10 +712,23 @@ StructuredStorage^ StructuredStorage::Open(String^ path, StorageOpenMode mode,
 
 			// FileMode::CreateNew
 			// - Temporary files will be auto-deleted on release
+			// - Temporary files never use the page cache
 			// - Uses StgCreateDocfile to construct the new compound file
 
 			case StorageOpenMode::CreateNew:
 				
+				if((cacheSize > 0) && (path != nullptr)) {
+
+					// The file itself is created (or truncated) by StorageLockBytes, so
+					// the docfile is always created with STGM_CREATE over it
+
+					hResult = StorageLockBytes::Create(pinPath, flags, (flags & STGM_CREATE) ? CREATE_ALWAYS : CREATE_NEW,
+						static_cast<size_t>(cacheSize), static_cast<ULONG>(readAhead), &pLockBytes);
+					if(SUCCEEDED(hResult)) hResult = StgCreateDocfileOnILockBytes(pLockBytes, flags | STGM_CREATE, 
+						0, &pRootStorage);
+					break;
+				}
+
 				if(path == nullptr) flags |= STGM_DELETEONRELEASE;
 				hResult = StgCreateStorageEx(pinPath, flags, STGFMT_DOCFILE, 0, &stgOptions, 
 					NULL, __uuidof(IStorage), reinterpret_cast<void**>(&pRootStorage));
@@ -233,12 +747,296 @@ StructuredStorage^ StructuredStorage::Open(String^ path, StorageOpenMode mode,
 		// pointer, and if we cannot construct the instance, dispose of it manually to
 		// ensure that the underlying storage file doesn't hang open on the application
 
-		rootStorage = gcnew ComStorage(pRootStorage);
-		try { return gcnew StructuredStorage(path, rootStorage); }
+		rootStorage = gcnew ComStorage(pRootStorage, nullptr, gcnew StorageStatistics());
+
+		try {
+
+			// A temporary file still has a name, it's just generated by the system;
+			// ask the root storage for it so FileName reports where the file is
+
+			if(path == nullptr) {
+
+				hResult = rootStorage->Stat(&statstg, STATFLAG_DEFAULT);
+				if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+				try { path = gcnew String(statstg.pwcsName); }
+				finally { CoTaskMemFree(statstg.pwcsName); }
+			}
+
+			return gcnew StructuredStorage(path, rootStorage, NULL);
+		}
+
 		catch(Exception^) { delete rootStorage; throw; }
 	}
 
-	finally { if(pRootStorage) pRootStorage->Release(); }
+	finally { 
+		
+		if(pRootStorage) pRootStorage->Release(); 
+		if(pLockBytes) pLockBytes->Release();
+	}
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::OpenSealed (static)
+//
+// Opens a storage that was created with Seal().  The file is opened read-only
+// with other readers allowed, and GetContainer() and GetObject() resolve the
+// paths with a single probe of the sealed name index
+//
+// Arguments:
+//
+//	path		- Path to the sealed structured storage file
+
+StructuredStorage^ StructuredStorage::OpenSealed(String^ path)
+{
+	StructuredStorage^			storage;		// Opened storage
+
+	if(path == nullptr) throw gcnew ArgumentNullException();
+
+	storage = Open(path, StorageOpenMode::Open, StorageAccessMode::ReadOnlyShared);
+
+	try {
+
+		storage->m_sealed = StorageSealedIndex::Load(storage->m_storage);
+		if(storage->m_sealed == nullptr) throw gcnew InvalidDataException();
+	}
+
+	catch(Exception^) { delete storage; throw; }
+
+	return storage;
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::PropertyIndex::get (internal)
+//
+// Exposes the property value indexes for this instance
+
+StoragePropertyIndex^ StructuredStorage::PropertyIndex::get(void)
+{
+	CHECK_DISPOSED(m_disposed);
+	return m_index;
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::Query
+//
+// Finds every container, including the root, that has a property with the
+// specified value.  Indexed properties are answered from the index; any
+// other property requires a scan of every container in the file
+//
+// Arguments:
+//
+//	propertySet		- Name of the property set that contains the property
+//	property		- Name of the property
+//	value			- Value to look for, compared with Object::Equals()
+
+List<StorageContainer^>^ StructuredStorage::Query(String^ propertySet, String^ property, Object^ value)
+{
+	List<StorageContainer^>^	results;		// Matching containers
+	StorageContainer^			container;		// Located container
+
+	CHECK_DISPOSED(m_disposed);
+	if(propertySet == nullptr) throw gcnew ArgumentNullException();
+	if(property == nullptr) throw gcnew ArgumentNullException();
+	if(value == nullptr) throw gcnew ArgumentNullException();
+
+	results = gcnew List<StorageContainer^>();
+
+	for each(String^ path in m_index->Lookup(propertySet, property, value)) {
+
+		// Removing a container doesn't touch the indexes, so any paths that
+		// no longer lead anywhere are purged from the index as they're found
+
+		container = FindContainer(path);
+		if((container == nullptr) || (!container->PropertySets->Contains(propertySet))) 
+			m_index->Update(propertySet, property, path, nullptr);
+		else results->Add(container);
+	}
+
+	return results;
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::RememberPath (private)
+//
+// Adds a resolved container path to the cache, discarding the least recently
+// used one when it's full.  The path isn't remembered if the cache has been
+// invalidated since the lookup that resolved it started, since it may have
+// been resolved through a container that was renamed or removed
+//
+// Arguments:
+//
+//	prefix		- Path prefix built from the split names
+//	container	- Resolved container
+//	generation	- Path cache generation when the lookup started
+
+void StructuredStorage::RememberPath(String^ prefix, StorageContainer^ container, __int64 generation)
+{
+	LinkedListNode<PathEntry>^		node;		// Cached path node
+
+	lock cs(m_paths);
+
+	if(generation != m_pathsGeneration) return;
+
+	if(m_paths->TryGetValue(prefix, node)) {
+
+		m_pathsLru->Remove(node);
+		m_paths->Remove(prefix);
+	}
+
+	while(m_paths->Count >= PATH_CACHE_CAPACITY) {
+
+		m_paths->Remove(m_pathsLru->Last->Value.Key);
+		m_pathsLru->RemoveLast();
+	}
+
+	m_paths->Add(prefix, m_pathsLru->AddFirst(PathEntry(prefix, container)));
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::Save
+//
+// Writes the image of an in-memory storage created with CreateInMemory() into
+// a stream.  The image is a normal compound file that can be opened later
+//
+// Arguments:
+//
+//	stream			- Stream to write the compound file image into
+
+void StructuredStorage::Save(Stream^ stream)
+{
+	::STATSTG				statstg;			// Backing store information
+	ULARGE_INTEGER			uliOffset;			// Offset into the backing store
+	array<Byte>^			buffer;				// Transfer buffer
+	PinnedBytePtr			pinBuffer;			// Pinned transfer buffer
+	ULONG					cbRead;				// Number of bytes read
+	HRESULT					hResult;			// Result from function call
+
+	CHECK_DISPOSED(m_disposed);
+	if(stream == nullptr) throw gcnew ArgumentNullException();
+	if(m_pLockBytes == NULL) throw gcnew InvalidOperationException();
+
+	Flush();									// Commit everything first
+
+	hResult = m_pLockBytes->Stat(&statstg, STATFLAG_NONAME);
+	if(FAILED(hResult)) throw gcnew StorageException(hResult);
+
+	buffer = gcnew array<Byte>(SAVE_BUFFER_SIZE);
+	pinBuffer = &buffer[0];
+
+	for(uliOffset.QuadPart = 0; uliOffset.QuadPart < statstg.cbSize.QuadPart; uliOffset.QuadPart += cbRead) {
+
+		hResult = m_pLockBytes->ReadAt(uliOffset, pinBuffer, SAVE_BUFFER_SIZE, &cbRead);
+		if(FAILED(hResult)) throw gcnew StorageException(hResult);
+		if(cbRead == 0) break;
+
+		stream->Write(buffer, 0, static_cast<int>(cbRead));
+	}
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::Save
+//
+// Writes the image of an in-memory storage created with CreateInMemory() into
+// a compound file, replacing the file if it already exists
+//
+// Arguments:
+//
+//	path			- Path to the structured storage file to be written
+
+void StructuredStorage::Save(String^ path)
+{
+	CHECK_DISPOSED(m_disposed);
+	if(path == nullptr) throw gcnew ArgumentNullException();
+
+	FileStream^ stream = gcnew FileStream(path, FileMode::Create, FileAccess::Write);
+	try { Save(stream); }
+	finally { delete stream; }
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::Seal
+//
+// Writes a copy of this storage into a new file that is meant to be read but
+// never changed again, and embeds a perfect hash index of every container and
+// object path into it.  Where the data ends up in the new file is left up to
+// the storage engine; nothing here makes it contiguous.  Open the new file
+// with OpenSealed() to use the index
+//
+// Arguments:
+//
+//	path		- Path to the sealed file to be created
+
+void StructuredStorage::Seal(String^ path)
+{
+	StructuredStorage^			target;			// Sealed storage
+
+	CHECK_DISPOSED(m_disposed);
+	if(path == nullptr) throw gcnew ArgumentNullException();
+
+	target = Open(path, StorageOpenMode::Create, StorageAccessMode::Exclusive);
+
+	try {
+
+		CopyTo(target);
+		StorageSealedIndex::Create(target, target->m_storage);
+	}
+
+	finally { delete target; }
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::SplitPath (private, static)
+//
+// Breaks a container/object path into it's individual names.  Either slash
+// can be used as the separator, and empty names are ignored so that leading,
+// trailing and doubled separators don't matter
+//
+// Arguments:
+//
+//	path		- Path to be split
+
+array<String^>^ StructuredStorage::SplitPath(String^ path)
+{
+	return path->Split(gcnew array<wchar_t>{ L'/', L'\\' }, StringSplitOptions::RemoveEmptyEntries);
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::Statistics::get
+//
+// Retrieves the runtime statistics collected for this storage
+
+StorageStatistics^ StructuredStorage::Statistics::get(void)
+{
+	CHECK_DISPOSED(m_disposed);
+	return m_storage->Statistics;
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::StreamCacheSize::get
+//
+// Gets the size of the page cache given to each object stream, in bytes
+
+int StructuredStorage::StreamCacheSize::get(void)
+{
+	CHECK_DISPOSED(m_disposed);
+	return m_streamCacheSize;
+}
+
+//---------------------------------------------------------------------------
+// StructuredStorage::StreamCacheSize::set
+//
+// Sets the size of the page cache given to each object stream, in bytes.  A
+// size of zero (the default) disables the page caches.  Only object streams
+// opened after this is set are affected; a stream that is already open, or
+// still held by the stream cache, keeps the cache it was opened with
+
+void StructuredStorage::StreamCacheSize::set(int value)
+{
+	CHECK_DISPOSED(m_disposed);
+
+	if(value < 0) throw gcnew ArgumentOutOfRangeException("value");
+	m_streamCacheSize = value;
 }
 
 //---------------------------------------------------------------------------
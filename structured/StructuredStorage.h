@@ -31,15 +31,23 @@
 #include "StorageAccessMode.h"			// Include StorageAccessMode declarations
 #include "StorageContainer.h"			// Include StorageContainer declarations
 #include "StorageException.h"			// Include StorageException declarations
+#include "StorageGroupCommit.h"			// Include StorageGroupCommit decls
 #include "StorageObject.h"				// Include StorageObject declarations
 #include "StorageOpenMode.h"			// Include StorageOpenMode declarations
+#include "StoragePropertyIndex.h"		// Include StoragePropertyIndex decls
 #include "StoragePropertySet.h"			// Include StoragePropertySet decls
+#include "StorageSealedIndex.h"			// Include StorageSealedIndex decls
+#include "StorageStatistics.h"			// Include StorageStatistics decls
 #include "StorageSummaryInformation.h"	// Include StorageSummaryInfo decls
 
 #pragma warning(push, 4)				// Enable maximum compiler warnings
 
 using namespace System;
+using namespace System::Collections::Generic;
+using namespace System::Diagnostics;
 using namespace System::IO;
+using namespace System::Runtime::ExceptionServices;
+using namespace System::Threading::Tasks;
 
 BEGIN_ROOT_NAMESPACE(zuki::storage)
 
@@ -58,11 +66,25 @@ public:
 	// Member Functions
 
 	void Close(void) { delete this; }
+	void CreateIndex(String^ propertySet, String^ property);
+	bool DropIndex(String^ propertySet, String^ property);
+	void ExportChanges(String^ path, DateTime since);
 	void Flush(void);
+	Task^ FlushAsync(void);
+	StorageContainer^ GetContainer(String^ path);
+	StorageObject^ GetObject(String^ path);
+	void ImportChanges(String^ path);
+	List<StorageContainer^>^ Query(String^ propertySet, String^ property, Object^ value);
+	void Save(Stream^ stream);
+	void Save(String^ path);
+	void Seal(String^ path);
 
 	//-----------------------------------------------------------------------
 	// Properties
 
+	property TimeSpan GroupCommitInterval { TimeSpan get(void); void set(TimeSpan value); }
+	property StorageStatistics^ Statistics { StorageStatistics^ get(void); }
+	property int StreamCacheSize { int get(void); void set(int value); }
 	property StorageSummaryInformation^ SummaryInformation { StorageSummaryInformation^ get(void); }
 
 	//-----------------------------------------------------------------------
@@ -71,6 +93,8 @@ public:
 	static StructuredStorage^ Create(String^ path)
 		{ return Open(path, StorageOpenMode::Create, StorageAccessMode::Exclusive); }
 
+	static StructuredStorage^ CreateInMemory(void);
+
 	static StructuredStorage^ CreateTemp(void)
 		{ return Open(nullptr, StorageOpenMode::Create, StorageAccessMode::Exclusive); }
 
@@ -80,7 +104,16 @@ public:
 	static StructuredStorage^ Open(String^ path, StorageOpenMode mode)
 		{ return Open(path, mode, StorageAccessMode::Exclusive); }
 
-	static StructuredStorage^ Open(String^ path, StorageOpenMode mode, StorageAccessMode access);
+	static StructuredStorage^ Open(String^ path, StorageOpenMode mode, StorageAccessMode access)
+		{ return Open(path, mode, access, 0); }
+
+	static StructuredStorage^ Open(String^ path, StorageOpenMode mode, StorageAccessMode access, int cacheSize)
+		{ return Open(path, mode, access, cacheSize, DEFAULT_READAHEAD); }
+
+	static StructuredStorage^ Open(String^ path, StorageOpenMode mode, StorageAccessMode access, int cacheSize, 
+		int readAhead);
+
+	static StructuredStorage^ OpenSealed(String^ path);
 
 internal:
 
@@ -113,24 +146,103 @@ internal:
 
 	property String^ FileName { String^ get(void); }
 
+	//-----------------------------------------------------------------------
+	// Internal Member Functions
+
+	// InvalidatePaths
+	//
+	// Discards the resolved container paths cached by GetContainer()
+	void InvalidatePaths(void);
+
+	// PropertyIndex
+	//
+	// Exposes the property value indexes for this instance
+	property StoragePropertyIndex^ PropertyIndex
+	{
+		StoragePropertyIndex^ get(void);
+	}
+
 private:
 
 	// PRIVATE CONSTRUCTOR
-	StructuredStorage(String^ fileName, ComStorage^ storage);
+	StructuredStorage(String^ fileName, ComStorage^ storage, ILockBytes* pLockBytes);
 
 	// DESTRUCTOR / FINALIZER
 	~StructuredStorage();
 
+	//-----------------------------------------------------------------------
+	// Private Data Types
+
+	// PathEntry
+	//
+	// Resolved container path and it's container, kept in LRU order
+	typedef KeyValuePair<String^, StorageContainer^> PathEntry;
+
+	//-----------------------------------------------------------------------
+	// Private Member Functions
+
+	// Commit
+	//
+	// Writes out the property indexes and commits the root storage
+	void Commit(void);
+
+	// FindPath
+	//
+	// Looks up a resolved container path.  Must be called with the lock held
+	bool FindPath(String^ prefix, StorageContainer^% container);
+
+	// OpenChain
+	//
+	// Opens a container by following a chain of container GUIDs
+	StorageContainer^ OpenChain(array<Guid>^ chain, int links);
+
+	// RememberPath
+	//
+	// Adds a resolved container path to the cache
+	void RememberPath(String^ prefix, StorageContainer^ container, __int64 generation);
+
+	// SplitPath (static)
+	//
+	// Breaks a container/object path into it's individual names
+	static array<String^>^ SplitPath(String^ path);
+
+	//-----------------------------------------------------------------------
+	// Private Constants
+
+	// DEFAULT_READAHEAD
+	//
+	// Default number of cache pages transferred at once by the page cache
+	literal int DEFAULT_READAHEAD = 8;
+
+	// PATH_CACHE_CAPACITY
+	//
+	// Maximum number of resolved container paths remembered by GetContainer()
+	literal int PATH_CACHE_CAPACITY = 256;
+
+	// SAVE_BUFFER_SIZE
+	//
+	// Size of the buffer used to copy an in-memory image by Save()
+	literal int SAVE_BUFFER_SIZE = 65536;
+
 	//-----------------------------------------------------------------------
 	// Member Variables
 
 	bool								m_disposed;			// Object disposal flag
+	ILockBytes*							m_pLockBytes;		// In-memory backing store
 	ComStorage^							m_storage;			// Root storage pointer
 	String^								m_fileName;			// Open file name
 	ComCache<ComPropertyStorage^>^		m_pstgCache;		// PropertyStorage cache
 	ComCache<ComStorage^>^				m_stgCache;			// Storage cache
 	ComCache<ComStream^>^				m_stmCache;			// Stream cache
 	StorageSummaryInformation^			m_summaryInfo;		// SummaryInfo pointer
+	StoragePropertyIndex^				m_index;			// Property value indexes
+	StorageGroupCommit^					m_groupCommit;		// Group commit, if enabled
+	Object^								m_groupLock;		// Group commit synchronization
+	Dictionary<String^, LinkedListNode<PathEntry>^>^	m_paths;	// Resolved container paths
+	LinkedList<PathEntry>^				m_pathsLru;			// m_paths in LRU order
+	__int64								m_pathsGeneration;	// Path cache generation
+	int									m_streamCacheSize;	// Object page cache size
+	StorageSealedIndex^					m_sealed;			// Sealed name index
 };
 
 //---------------------------------------------------------------------------